@@ -3,17 +3,36 @@
 #define MAX 1e6
 #define rad 1.0
 
+// lut presets of AtmosphereLutQuality, compileshaders.py builds every shader including this once per preset.
+// LUT_FORMAT is the format of the irradiance and scattering luts, the transmittance lut is always rgba32f
+#if defined(LUT_QUALITY_LOW)
+#define TRANSMITTANCE_TEXTURE_WIDTH  128
+#define TRANSMITTANCE_TEXTURE_HEIGHT  32
+#define SCATTERING_TEXTURE_R_SIZE  16
+#define SCATTERING_TEXTURE_MU_SIZE  64
+#define SCATTERING_TEXTURE_MU_S_SIZE  16
+#define SCATTERING_TEXTURE_NU_SIZE  8
+#define IRRADIANCE_TEXTURE_WIDTH  32
+#define IRRADIANCE_TEXTURE_HEIGHT  8
+#define LUT_FORMAT  rgba16f
+#else
 #define TRANSMITTANCE_TEXTURE_WIDTH  256
 #define TRANSMITTANCE_TEXTURE_HEIGHT  64
 #define SCATTERING_TEXTURE_R_SIZE  32
 #define SCATTERING_TEXTURE_MU_SIZE  128
 #define SCATTERING_TEXTURE_MU_S_SIZE  32
 #define SCATTERING_TEXTURE_NU_SIZE  8
+#define IRRADIANCE_TEXTURE_WIDTH  64
+#define IRRADIANCE_TEXTURE_HEIGHT  16
+#if defined(LUT_QUALITY_MEDIUM)
+#define LUT_FORMAT  rgba16f
+#else
+#define LUT_FORMAT  rgba32f
+#endif
+#endif
 #define SCATTERING_TEXTURE_WIDTH  SCATTERING_TEXTURE_NU_SIZE * SCATTERING_TEXTURE_MU_S_SIZE
 #define SCATTERING_TEXTURE_HEIGHT  SCATTERING_TEXTURE_MU_SIZE
 #define SCATTERING_TEXTURE_DEPTH  SCATTERING_TEXTURE_R_SIZE
-#define IRRADIANCE_TEXTURE_WIDTH  64
-#define IRRADIANCE_TEXTURE_HEIGHT  16
 
 struct DensityProfileLayer {
     float width;
@@ -1,6 +1,7 @@
 #include "definations.glsl"
 
-AtmosphereParameters GetAtmosphereParameters()
+// haze scales the mie scattering, the sky only reads the mie to rayleigh ratio of the scattering lut and works without it
+AtmosphereParameters GetAtmosphereParameters(float haze)
 {
     AtmosphereParameters atmosphere;
     atmosphere.bottom_radius = 6360.0f;
@@ -20,8 +21,8 @@ AtmosphereParameters GetAtmosphereParameters()
     // Mie scattering
     atmosphere.mie_density.layers[0] = DensityProfileLayer(0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
     atmosphere.mie_density.layers[1] = DensityProfileLayer(0.0f, 1.0f, -1.0f / mie_scale_height, 0.0f, 0.0f);
-    atmosphere.mie_scattering = vec3(0.003996f, 0.003996f, 0.003996f); // 1/km
-    atmosphere.mie_extinction = vec3(0.004440f, 0.004440f, 0.004440f); // 1/km
+    atmosphere.mie_scattering = vec3(0.003996f, 0.003996f, 0.003996f) * haze; // 1/km
+    atmosphere.mie_extinction = vec3(0.004440f, 0.004440f, 0.004440f) * haze; // 1/km
     atmosphere.mie_g = 0.8;
 
     // Ozone absorption
@@ -35,6 +36,11 @@ AtmosphereParameters GetAtmosphereParameters()
     return atmosphere;
 }
 
+AtmosphereParameters GetAtmosphereParameters()
+{
+    return GetAtmosphereParameters(1.0);
+}
+
 Number ClampCosine(Number mu)
 {
     return clamp(mu, Number(-1.0), Number(1.0));
@@ -0,0 +1,7 @@
+// per dispatch parameters of the lut precompute, matches Atmosphere::LutPushConstants
+layout(push_constant) uniform PerDispatch {
+    int scattering_order;
+    // first layer of the dispatch, the 3d luts are computed a slice of layers at a time
+    int layer_offset;
+    float haze;
+};
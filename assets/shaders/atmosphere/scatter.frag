@@ -7,26 +7,93 @@ layout(location = 0) out vec4 out_color;
 layout(set = 0, binding = 0) uniform ScatteringUb {
     mat4 inv_view_projection_matrix;
     vec2 resolution;
-    vec2 pad0;
+    vec2 uv_scale;
     vec3 camera_position;
-    float pad1;
+    float downsample;
+    mat4 prev_view_projection_matrix;
+    vec2 jitter;
+    float history_valid;
+    float pad0;
 } scattering_ub;
 
 layout(set = 0, binding = 1) uniform sampler2D transmittance_lut;
 layout(set = 0, binding = 2) uniform sampler3D scattering_lut;
 layout(set = 0, binding = 3) uniform sampler2D geometry_color;
 layout(set = 0, binding = 4) uniform sampler2D scene_depth;
+layout(set = 0, binding = 7) uniform sampler2D sky_view_lut;
+layout(set = 0, binding = 8) uniform sampler3D camera_volume;
+
+#ifdef TEMPORAL
+layout(set = 0, binding = 6) uniform sampler2D sky_history;
+
+// relative depth difference and pixel motion beyond which the history is stale
+const float k_depth_tolerance = 0.05;
+const float k_max_motion = 8.0;
+
+// last frame's scattering at the same world position or, for the sky, the same direction
+bool Reproject(vec2 frag_coord, vec3 x_clip, vec3 view_dir, out vec4 history) {
+    vec4 prev_clip;
+    if (x_clip.z > 0.0) {
+        vec4 world_pos = scattering_ub.inv_view_projection_matrix * vec4(x_clip, 1.0);
+        prev_clip = scattering_ub.prev_view_projection_matrix * vec4(world_pos.xyz / world_pos.w, 1.0);
+    }
+    else {
+        prev_clip = scattering_ub.prev_view_projection_matrix * vec4(view_dir, 0.0);
+    }
+    if (prev_clip.w <= 0.0) {
+        return false;
+    }
+    vec2 prev_ndc = prev_clip.xy / prev_clip.w;
+    vec2 prev_frag_coord = vec2(prev_ndc.x * 0.5 + 0.5, 0.5 - prev_ndc.y * 0.5);
+    if (any(lessThan(prev_frag_coord, vec2(0.0))) || any(greaterThan(prev_frag_coord, vec2(1.0)))) {
+        return false;
+    }
+    if (length((prev_frag_coord - frag_coord) * scattering_ub.resolution) > k_max_motion) {
+        return false;
+    }
+    // the history keeps the depth it was evaluated at in alpha
+    history = texture(sky_history, prev_frag_coord * scattering_ub.resolution / vec2(textureSize(sky_history, 0)));
+    float expected_depth = x_clip.z > 0.0 ? prev_clip.z / prev_clip.w : 0.0;
+    return abs(history.a - expected_depth) <= k_depth_tolerance * expected_depth;
+}
+#endif
 
 #include "functions.glsl"
+#include "sky_view.glsl"
+
+vec3 GetSkyViewLuminance(AtmosphereParameters atmosphere, vec3 camera, vec3 view_dir) {
+    vec3 up, sun_horizontal;
+    SkyViewFrame(camera, up, sun_horizontal);
+    float view_height = SkyViewHeight(atmosphere, camera);
+    float cos_view_zenith = dot(view_dir, up);
+    vec3 view_horizontal = view_dir - cos_view_zenith * up;
+    float cos_light_view = dot(view_horizontal, view_horizontal) > 1e-8 ? dot(normalize(view_horizontal), sun_horizontal) : 1.0;
+    vec2 uv = ViewParamsToSkyViewLutUv(atmosphere, RayIntersectsGround(atmosphere, view_height, cos_view_zenith), view_height, cos_view_zenith, cos_light_view);
+    // the lut covers the parameter range from the first to the last texel center
+    vec2 size = vec2(textureSize(sky_view_lut, 0));
+    return texture(sky_view_lut, (uv * (size - 1.0) + 0.5) / size).rgb;
+}
+
+// in-scattering up to a scene point t away, faded in over the first slice of the camera volume
+vec3 GetCameraVolumeLuminance(vec2 frag_coord, float t) {
+    float slices = float(textureSize(camera_volume, 0).z);
+    float slice = t / k_camera_volume_distance * slices;
+    // slice z holds the scattering up to its far end
+    return texture(camera_volume, vec3(frag_coord, (slice - 0.5) / slices)).rgb * clamp(slice, 0.0, 1.0);
+}
 
 void main() {
     AtmosphereParameters atmosphere = GetAtmosphereParameters();
 	vec2 frag_coord = gl_FragCoord.xy / vec2(scattering_ub.resolution);
+	// the inputs are full size textures rendered in their top left corner
+	vec2 input_uv = frag_coord * scattering_ub.uv_scale;
+	// reduced resolution pixels take the depth of one full resolution pixel they cover, the upsample compares against it
+	ivec2 depth_texel = min(ivec2(gl_FragCoord.xy * scattering_ub.downsample), textureSize(scene_depth, 0) - 1);
     vec3 x_clip = vec3(frag_coord * vec2(2.0, -2.0) - vec2(1.0, -1.0), 0.5); 
     vec4 _x_world = scattering_ub.inv_view_projection_matrix * vec4(x_clip, 1.0); 
 	vec3 x_world = _x_world.xyz / _x_world.w;
     vec3 view_dir = normalize(x_world - scattering_ub.camera_position);
-    vec3 sun_dir = - normalize(vec3(0.0, -1.0, -1.0));
+    vec3 sun_dir = k_sun_direction;
 
 	vec3 SunLuminance = vec3(0.0); 
 	// render light source
@@ -45,7 +112,16 @@ void main() {
 	float t = raySphereIntersect(scattering_ub.camera_position, view_dir, earth_pos, earth_radius);
 	
 	// don't calculate atmosphere before scene depth;
-	x_clip.z = texture(scene_depth, frag_coord).r;
+	x_clip.z = texelFetch(scene_depth, depth_texel, 0).r;
+#ifdef TEMPORAL
+	// a quarter of the pixels is evaluated each frame, the others reproject the last result
+	vec4 history;
+	bool evaluate = scattering_ub.history_valid == 0.0 || ivec2(gl_FragCoord.xy) % 2 == ivec2(scattering_ub.jitter);
+	if (!evaluate && Reproject(frag_coord, x_clip, view_dir, history)) {
+		out_color = history;
+		return;
+	}
+#endif
 	if (x_clip.z > 0.0f)
 	{
 		vec4 DepthBufferWorldPos = scattering_ub.inv_view_projection_matrix * vec4(x_clip,1.0);
@@ -57,24 +133,35 @@ void main() {
 		}
 	}
 
-	float shadow_length = 0.0f; 
-	vec3 SunIlluminanceToGroundLuminanceTransfer = vec3(0.0);
-	vec3 SunIlluminanceToSkyLuminanceTransfer = vec3(0.0);
-	vec3 SunTransmittance = vec3(0.0);
-	// intersect with ground
-	if (t > 0.0)
+	// the sky and the ground of the planet come from the sky view lut, the scene from the camera volume within its range
+	vec3 luminance;
+	if (x_clip.z > 0.0f && t < k_camera_volume_distance)
+	{
+		luminance = GetCameraVolumeLuminance(frag_coord, t);
+	}
+	else if (x_clip.z > 0.0f)
 	{
+		float shadow_length = 0.0f; 
 		vec3 world_pos = cam_pos + t * view_dir; // intersection point 
-		SunIlluminanceToGroundLuminanceTransfer = GetSkyRadianceToPoint(atmosphere, transmittance_lut, scattering_lut, scattering_lut, cam_pos, world_pos, shadow_length, sun_dir, transmittance);
+		luminance = GetSkyRadianceToPoint(atmosphere, transmittance_lut, scattering_lut, scattering_lut, cam_pos, world_pos, shadow_length, sun_dir, transmittance);
 	}
 	else
 	{
-		//intersect with atmosphere
-		SunIlluminanceToSkyLuminanceTransfer = GetSkyRadiance(atmosphere, transmittance_lut, scattering_lut, scattering_lut, cam_pos, view_dir, shadow_length, sun_dir, transmittance);
-		SunTransmittance = transmittance;
+		luminance = GetSkyViewLuminance(atmosphere, cam_pos, view_dir);
+		// the sun disc is attenuated by the atmosphere up to space, and hidden by the ground
+		if (t < 0.0f && SunLuminance != vec3(0.0))
+		{
+			float r = length(cam_pos);
+			float mu = dot(cam_pos, view_dir) / r;
+			luminance += SunLuminance * GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_lut, min(r, atmosphere.top_radius), mu);
+		}
 	}
 	transmittance = vec3(0.0);
-	// Compute in scattering and apply transmittance on background
-	vec3 luminance = (SunIlluminanceToSkyLuminanceTransfer + SunIlluminanceToGroundLuminanceTransfer) + SunLuminance * SunTransmittance;
-	out_color = texture(geometry_color, frag_coord) + vec4(luminance, 1.0 - dot(transmittance, vec3(0.33, 0.33, 0.34)));
+#if defined(TEMPORAL)
+	out_color = vec4(luminance, x_clip.z);
+#elif defined(LOW_RESOLUTION)
+	out_color = vec4(luminance, 1.0);
+#else
+	out_color = texture(geometry_color, input_uv) + vec4(luminance, 1.0 - dot(transmittance, vec3(0.33, 0.33, 0.34)));
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#version 450
+
+layout(location = 0) out vec4 out_color;
+
+layout(set = 0, binding = 0) uniform ScatteringUb {
+    mat4 inv_view_projection_matrix;
+    vec2 resolution;
+    vec2 uv_scale;
+    vec3 camera_position;
+    float downsample;
+    mat4 prev_view_projection_matrix;
+    vec2 jitter;
+    float history_valid;
+    float pad0;
+} scattering_ub;
+
+layout(set = 0, binding = 3) uniform sampler2D geometry_color;
+layout(set = 0, binding = 4) uniform sampler2D scene_depth;
+layout(set = 0, binding = 5) uniform sampler2D low_resolution_sky;
+
+// relative view distance difference at which a tap stops counting
+const float k_depth_tolerance = 0.05;
+const float k_sky_distance = 1e30;
+
+float ViewDistance(ivec2 texel) {
+    float depth = texelFetch(scene_depth, texel, 0).r;
+    // reverse z, nothing drawn
+    if (depth == 0.0) {
+        return k_sky_distance;
+    }
+    vec2 render_size = vec2(textureSize(scene_depth, 0)) * scattering_ub.uv_scale;
+    vec2 frag_coord = (vec2(texel) + 0.5) / render_size;
+    vec4 world_pos = scattering_ub.inv_view_projection_matrix * vec4(frag_coord * vec2(2.0, -2.0) - vec2(1.0, -1.0), depth, 1.0);
+    return length(world_pos.xyz / world_pos.w - scattering_ub.camera_position);
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float distance = ViewDistance(pixel);
+
+    // the four reduced resolution pixels around this one, each evaluated at the depth of the full resolution pixel the scattering pass fetched
+    vec2 low_coord = gl_FragCoord.xy / scattering_ub.downsample - 0.5;
+    ivec2 base = ivec2(floor(low_coord));
+    vec2 f = low_coord - vec2(base);
+    ivec2 max_texel = ivec2(scattering_ub.resolution) - 1;
+    ivec2 max_depth_texel = textureSize(scene_depth, 0) - 1;
+
+    vec3 sky = vec3(0.0);
+    float weight_sum = 0.0;
+    vec3 closest_sky = vec3(0.0);
+    float closest_difference = k_sky_distance;
+    for (int i = 0; i < 4; i++) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), max_texel);
+        vec3 tap = texelFetch(low_resolution_sky, texel, 0).rgb;
+        float tap_distance = ViewDistance(min(ivec2(vec2(texel) * scattering_ub.downsample + 0.5 * scattering_ub.downsample), max_depth_texel));
+        float difference = abs(tap_distance - distance) / min(tap_distance, distance);
+
+        float bilinear = (offset.x == 1 ? f.x : 1.0 - f.x) * (offset.y == 1 ? f.y : 1.0 - f.y);
+        float weight = bilinear * max(1.0 - difference / k_depth_tolerance, 0.0);
+        sky += tap * weight;
+        weight_sum += weight;
+        if (difference < closest_difference) {
+            closest_difference = difference;
+            closest_sky = tap;
+        }
+    }
+    // no tap on the same surface, take the closest one in depth instead of bleeding across the edge
+    sky = weight_sum > 1e-4 ? sky / weight_sum : closest_sky;
+
+    out_color = texelFetch(geometry_color, pixel, 0) + vec4(sky, 1.0);
+}
@@ -0,0 +1,54 @@
+// per frame luts around the camera from Hillaire, A Scalable and Production Ready Sky and Atmosphere Rendering
+// Technique (2020), filled from the precomputed luts. include after functions.glsl
+
+const vec3 k_sun_direction = vec3(0.0, 0.70710678, 0.70710678);
+
+// range of the camera volume, scene points farther away evaluate the scattering per pixel
+const float k_camera_volume_distance = 32.0; // km
+
+// the view height is clamped above the ground, the horizon angle is undefined below it
+float SkyViewHeight(AtmosphereParameters atmosphere, vec3 camera) {
+    return max(length(camera), atmosphere.bottom_radius + 0.001);
+}
+
+// latitude rows are packed towards the horizon, the ground below it fills the lower half.
+// the azimuth is measured from the sun, the sky is symmetric around it, and columns are packed towards the sun
+void SkyViewLutUvToViewParams(AtmosphereParameters atmosphere, float view_height, vec2 uv, out float cos_view_zenith, out float cos_light_view) {
+    float horizon_distance = sqrt(view_height * view_height - atmosphere.bottom_radius * atmosphere.bottom_radius);
+    float beta = acos(horizon_distance / view_height);
+    float zenith_horizon_angle = PI - beta;
+    if (uv.y < 0.5) {
+        float coord = 1.0 - 2.0 * uv.y;
+        cos_view_zenith = cos(zenith_horizon_angle * (1.0 - coord * coord));
+    }
+    else {
+        float coord = 2.0 * uv.y - 1.0;
+        cos_view_zenith = cos(zenith_horizon_angle + beta * coord * coord);
+    }
+    cos_light_view = 1.0 - 2.0 * uv.x * uv.x;
+}
+
+vec2 ViewParamsToSkyViewLutUv(AtmosphereParameters atmosphere, bool intersects_ground, float view_height, float cos_view_zenith, float cos_light_view) {
+    float horizon_distance = sqrt(view_height * view_height - atmosphere.bottom_radius * atmosphere.bottom_radius);
+    float beta = acos(horizon_distance / view_height);
+    float zenith_horizon_angle = PI - beta;
+    vec2 uv;
+    if (!intersects_ground) {
+        float coord = clamp(acos(cos_view_zenith) / zenith_horizon_angle, 0.0, 1.0);
+        uv.y = 0.5 * (1.0 - sqrt(1.0 - coord));
+    }
+    else {
+        float coord = clamp((acos(cos_view_zenith) - zenith_horizon_angle) / beta, 0.0, 1.0);
+        uv.y = 0.5 + 0.5 * sqrt(coord);
+    }
+    uv.x = sqrt(0.5 - 0.5 * cos_light_view);
+    return uv;
+}
+
+// up and the sun projected onto the horizon, the frame of the sky view lut
+void SkyViewFrame(vec3 camera, out vec3 up, out vec3 sun_horizontal) {
+    up = normalize(camera);
+    sun_horizontal = k_sun_direction - dot(k_sun_direction, up) * up;
+    // the sun at the zenith, every azimuth is the same
+    sun_horizontal = dot(sun_horizontal, sun_horizontal) > 1e-8 ? normalize(sun_horizontal) : normalize(cross(up, abs(up.x) < 0.9 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 0.0, 1.0)));
+}
@@ -3,31 +3,49 @@ import os
 
 
 path, _ = os.path.split(os.path.abspath(sys.argv[0]))
+# the build passes the glslc it found, otherwise the one on the path
+compiler = sys.argv[1] if len(sys.argv) > 1 else "glslc"
+failed = []
 
-def glslc(shaderPath):
+# variants of a shader are compiled under another output name with extra defines
+def glslc(shaderPath, outputPath=None, defines=[]):
     input = os.path.join(path, shaderPath)
-    output = os.path.join(os.path.join(path, "spirv"), shaderPath) + ".spv"
-    cmd="glslc"+ " " + input + " -o " + output
-    os.system(cmd)
+    output = os.path.join(os.path.join(path, "spirv"), outputPath if outputPath else shaderPath) + ".spv"
+    cmd="\"" + compiler + "\" " + input + "".join(" -D" + define for define in defines) + " -o " + output
+    if os.system(cmd) != 0:
+        failed.append(output)
 
 def main():
 
     glslc("postprocess.frag")
     glslc("geometry.vert")
     glslc("geometry.frag")
+    glslc("geometry_indirect.vert")
+    glslc("depth_prepass.vert")
+    glslc("cull_instances.comp")
+    glslc("depth_pyramid.comp")
     glslc("present.frag")
     glslc("simplevs.vert")
     glslc("shading.frag")
-
-    # atmosphere
-    glslc("atmosphere/transmittance_lut.comp")
-    glslc("atmosphere/direct_irradiance_lut.comp")
-    glslc("atmosphere/single_scattering_lut.comp")
-    glslc("atmosphere/scattering_density.comp")
-    glslc("atmosphere/indirect_irradiance_lut.comp")
-    glslc("atmosphere/multi_scattering_lut.comp")
+    glslc("shading.frag", "shading_subpass.frag", ["SUBPASS_INPUT"])
+    glslc("light_clustering.comp")
+    glslc("tiled_shading.comp")
+
+    # atmosphere, the shaders sampling the luts once per lut preset of AtmosphereLutQuality
+    for suffix, defines in [("", []), ("_medium", ["LUT_QUALITY_MEDIUM"]), ("_low", ["LUT_QUALITY_LOW"])]:
+        for shader in ["transmittance_lut", "direct_irradiance_lut", "single_scattering_lut", "scattering_density",
+                       "indirect_irradiance_lut", "multi_scattering_lut", "sky_view_lut", "camera_volume"]:
+            glslc("atmosphere/" + shader + ".comp", "atmosphere/" + shader + suffix + ".comp", defines)
+        glslc("atmosphere/scatter.frag", "atmosphere/scatter" + suffix + ".frag", defines)
+        glslc("atmosphere/scatter.frag", "atmosphere/scatter_low" + suffix + ".frag", ["LOW_RESOLUTION"] + defines)
+        glslc("atmosphere/scatter.frag", "atmosphere/scatter_temporal" + suffix + ".frag", ["TEMPORAL"] + defines)
     glslc("atmosphere/scatter.vert")
-    glslc("atmosphere/scatter.frag")
+    glslc("atmosphere/sky_upsample.frag")
+
+    # a stale binary would otherwise be loaded without notice
+    if failed:
+        print("failed to compile " + ", ".join(failed))
+        sys.exit(1)
 
 
 if __name__ == '__main__':
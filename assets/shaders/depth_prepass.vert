@@ -0,0 +1,25 @@
+#version 450
+
+// position stream only, must transform exactly like geometry.vert so the geometry pass passes the equal depth test
+
+layout(location = 0) in vec3 in_position;
+
+invariant gl_Position;
+
+// set 0: scene
+
+layout(set = 0, binding = 0) uniform SceneUb {
+    mat4 view, proj;
+    vec2 near_far;
+} scene_ub;
+
+// set 2: instance transforms, one per instance of an instanced draw in sorted draw order
+
+layout(std430, set = 2, binding = 0) readonly buffer InstanceTransforms {
+    mat4 transforms[];
+};
+
+void main() {
+    mat4 model = transforms[gl_InstanceIndex];
+    gl_Position = scene_ub.proj * scene_ub.view * model * vec4(in_position, 1.0);
+}
@@ -0,0 +1,29 @@
+// packed g buffer layout, must match Geometry.cpp
+// 0: octahedral normal, rg16 snorm
+// 1: albedo, rgba8 srgb
+// 2: roughness, metallic, rg8 unorm
+// 3: depth, d32, world position is reconstructed from it
+
+vec2 OctWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// unit vector to the [-1, 1] square of an octahedron unfolded onto the xy plane
+vec2 EncodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : OctWrap(n.xy);
+    return n.xy;
+}
+
+vec3 DecodeNormal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// uv of the pixel center and its device depth, the viewport is flipped so ndc y points up
+vec3 ReconstructWorldPosition(vec2 uv, float depth, mat4 inv_view_projection) {
+    vec4 p = inv_view_projection * vec4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, depth, 1.0);
+    return p.xyz / p.w;
+}
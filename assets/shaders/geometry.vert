@@ -6,6 +6,9 @@ layout(location = 2) in vec2 in_tex_coord;
 // layout(location = 3) in vec3 inTangent;
 // layout(location = 4) in vec3 inBiTangent;
 
+// identical to the depth pre-pass, the geometry pass tests its depth for equality
+invariant gl_Position;
+
 layout(location = 0) out vec3 world_pos;
 layout(location = 1) out vec3 world_normal;
 layout(location = 2) out vec2 frag_tex_coord;
@@ -19,15 +22,14 @@ layout(set = 0, binding = 0) uniform SceneUb {
 
 // set 1: material
 
-// push constant
-
-layout(push_constant) uniform MeshUb {
-    mat4 model;
-} mesh_ub;
+// set 2: instance transforms, one per instance of an instanced draw in sorted draw order
 
+layout(std430, set = 2, binding = 0) readonly buffer InstanceTransforms {
+    mat4 transforms[];
+};
 
 void main() {
-    mat4 model = mesh_ub.model;
+    mat4 model = transforms[gl_InstanceIndex];
     world_pos = (model * vec4(in_position, 1.0)).xyz;
     world_normal = (model * vec4(in_normal, 0.0)).xyz;
     frag_tex_coord = in_tex_coord;
@@ -0,0 +1,49 @@
+#version 450
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_normal;
+layout(location = 2) in vec2 in_tex_coord;
+
+layout(location = 0) out vec3 world_pos;
+layout(location = 1) out vec3 world_normal;
+layout(location = 2) out vec2 frag_tex_coord;
+
+// set 0: scene
+
+layout(set = 0, binding = 0) uniform SceneUb {
+    mat4 view, proj;
+    vec2 near_far;
+} scene_ub;
+
+// set 1: material
+
+// set 2: instances, written by the cpu and culled by cull_instances.comp
+
+struct Instance {
+    vec4 bounds_center;
+    vec4 bounds_extent;
+    uint transform_index;
+    uint material_index;
+    uint batch_index;
+    uint command_base;
+    uint command_slot;
+    uint first_index;
+    uint index_count;
+    uint pad;
+};
+
+layout(std430, set = 2, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(std430, set = 2, binding = 1) readonly buffer Transforms {
+    mat4 transforms[];
+};
+
+void main() {
+    mat4 model = transforms[instances[gl_InstanceIndex].transform_index];
+    world_pos = (model * vec4(in_position, 1.0)).xyz;
+    world_normal = (model * vec4(in_normal, 0.0)).xyz;
+    frag_tex_coord = in_tex_coord;
+    gl_Position = scene_ub.proj * scene_ub.view * model * vec4(in_position, 1.0);
+}
@@ -4,6 +4,11 @@ layout(location = 0) out vec4 out_color;
 
 layout(set = 0, binding = 0) uniform sampler2D color_texture;
 
+// the scene is rendered into the top left uv_scale part of color_texture
+layout(push_constant) uniform UpscaleParams {
+	vec2 uv_scale;
+} upscale;
+
 float sRGB(float x)
 {
 	if (x <= 0.00031308)
@@ -33,7 +38,9 @@ vec3 GammaCorrection(vec3 x){
 }
 
 void main() {
-	vec2 frag_coord = gl_FragCoord.xy / vec2(1920.0,1080.0);
+	// bilinear upscale, clamped half a texel inside the render area so nothing outside it is filtered in
+	vec2 size = vec2(textureSize(color_texture, 0));
+	vec2 frag_coord = min(gl_FragCoord.xy / size * upscale.uv_scale, upscale.uv_scale - 0.5 / size);
 	vec4 rgbA = texture(color_texture, frag_coord);
 	rgbA /= rgbA.aaaa;	// Normalise according to sample count when path tracing
 	vec3 white_point = vec3(1.08241, 0.96756, 0.95003);
@@ -1,9 +1,12 @@
 #include "App.h"
+#include <cstring>
 #include <memory>
 
+#include <runtime/scene/render/Atmosphere.h>
+
 using namespace Horizon;
 
-App::App(u32 _width, u32 _height) noexcept :m_width(_width), mHeight(_height)
+App::App(u32 _width, u32 _height, AtmosphereLutQuality _atmosphere_lut_quality, bool _merged_deferred_pass) noexcept :m_width(_width), mHeight(_height), m_atmosphere_lut_quality(_atmosphere_lut_quality), m_merged_deferred_pass(_merged_deferred_pass)
 {
 
 }
@@ -15,7 +18,7 @@ App::~App() noexcept {
 void App::Run() noexcept {
 
 	m_window = std::make_shared<Window>("horizon", m_width, mHeight);
-	m_renderer = std::make_unique<Renderer>(m_window->getWidth(), m_window->getHeight(), m_window);
+	m_renderer = std::make_unique<Renderer>(m_window->getWidth(), m_window->getHeight(), m_window, m_atmosphere_lut_quality, m_merged_deferred_pass);
 	m_input_manager = std::make_unique<InputManager>(m_window, m_renderer->GetMainCamera());
 
 	while (!m_window->ShouldClose())
@@ -29,7 +32,44 @@ void App::Run() noexcept {
 
 int main(int argc, char* argv[]) {
 
-	std::unique_ptr<App> app = std::make_unique<App>(1920, 1080);
+	// --atmosphere-lut-quality high|medium|low, for the renderer and the bake
+	AtmosphereLutQuality atmosphere_lut_quality = AtmosphereLutQuality::HIGH;
+	// --bake-atmosphere-luts bakes the atmosphere lut cache on the cpu, for machines without a gpu
+	bool bake_atmosphere_luts = false;
+	// --measure-atmosphere-luts logs the memory of every lut preset and its error against the high one
+	bool measure_atmosphere_luts = false;
+	// --merged-deferred-pass starts with geometry and lighting in one render pass
+	bool merged_deferred_pass = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--atmosphere-lut-quality") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "medium") == 0) {
+				atmosphere_lut_quality = AtmosphereLutQuality::MEDIUM;
+			}
+			else if (strcmp(argv[i], "low") == 0) {
+				atmosphere_lut_quality = AtmosphereLutQuality::LOW;
+			}
+		}
+		else if (strcmp(argv[i], "--bake-atmosphere-luts") == 0) {
+			bake_atmosphere_luts = true;
+		}
+		else if (strcmp(argv[i], "--measure-atmosphere-luts") == 0) {
+			measure_atmosphere_luts = true;
+		}
+		else if (strcmp(argv[i], "--merged-deferred-pass") == 0) {
+			merged_deferred_pass = true;
+		}
+	}
+
+	if (bake_atmosphere_luts) {
+		return Atmosphere::BakeLutCache(Atmosphere::k_multi_scattering_order, 0, atmosphere_lut_quality) ? 0 : 1;
+	}
+	if (measure_atmosphere_luts) {
+		Atmosphere::MeasureLutQualities(Atmosphere::k_multi_scattering_order);
+		return 0;
+	}
+
+	std::unique_ptr<App> app = std::make_unique<App>(1920, 1080, atmosphere_lut_quality, merged_deferred_pass);
 	app->Run();
 	
 	return 0;
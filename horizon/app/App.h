@@ -9,12 +9,14 @@
 class App
 {
 public:
-	App(Horizon::u32 _width, Horizon::u32 _height) noexcept;
+	App(Horizon::u32 _width, Horizon::u32 _height, Horizon::AtmosphereLutQuality _atmosphere_lut_quality = Horizon::AtmosphereLutQuality::HIGH, bool _merged_deferred_pass = false) noexcept;
 	~App() noexcept;
 	void Run() noexcept;
 private:
 	Horizon::u32 m_width;
 	Horizon::u32 mHeight;
+	Horizon::AtmosphereLutQuality m_atmosphere_lut_quality;
+	bool m_merged_deferred_pass;
 	std::shared_ptr<Horizon::Window> m_window = nullptr;
 	std::unique_ptr<Horizon::Renderer> m_renderer = nullptr;
 	std::unique_ptr<Horizon::InputManager> m_input_manager;
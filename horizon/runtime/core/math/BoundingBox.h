@@ -0,0 +1,48 @@
+#pragma once
+
+#include <limits>
+
+#include <runtime/core/math/Math.h>
+
+namespace Horizon {
+
+	// axis aligned bounding box, an empty box has min > max
+	struct BoundingBox {
+		BoundingBox() noexcept = default;
+		BoundingBox(const Math::vec3& _min, const Math::vec3& _max) noexcept :min(_min), max(_max) {}
+
+		bool Valid() const noexcept {
+			return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+		}
+
+		Math::vec3 Center() const noexcept {
+			return (min + max) * 0.5f;
+		}
+
+		Math::vec3 Extent() const noexcept {
+			return (max - min) * 0.5f;
+		}
+
+		void Merge(const Math::vec3& point) noexcept {
+			min = Math::min(min, point);
+			max = Math::max(max, point);
+		}
+
+		void Merge(const BoundingBox& box) noexcept {
+			min = Math::min(min, box.min);
+			max = Math::max(max, box.max);
+		}
+
+		// transform by an affine matrix, the result encloses the transformed box
+		BoundingBox Transform(const Math::mat4& m) const noexcept {
+			Math::vec3 center = Math::vec3(m * Math::vec4(Center(), 1.0f));
+			Math::vec3 extent = Extent();
+			Math::vec3 new_extent = Math::abs(Math::vec3(m[0])) * extent.x + Math::abs(Math::vec3(m[1])) * extent.y + Math::abs(Math::vec3(m[2])) * extent.z;
+			return BoundingBox(center - new_extent, center + new_extent);
+		}
+
+		Math::vec3 min = Math::vec3((std::numeric_limits<f32>::max)());
+		Math::vec3 max = Math::vec3(std::numeric_limits<f32>::lowest());
+	};
+
+}
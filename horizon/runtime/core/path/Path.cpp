@@ -20,4 +20,12 @@ namespace Horizon {
 		return GetAssetsPath().append("/shaders/spirv/").append(_path);
 	}
 
+	std::string Path::GetCachePath(std::string _path) const noexcept
+	{
+		std::string cache_path = GetAssetsPath().append("/cache");
+		std::error_code error;
+		std::filesystem::create_directories(cache_path, error);
+		return cache_path.append("/").append(_path);
+	}
+
 }
\ No newline at end of file
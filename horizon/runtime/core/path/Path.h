@@ -12,6 +12,8 @@ namespace Horizon {
 	public:
 		std::string GetModelPath(std::string _path) const noexcept;
 		std::string GetShaderPath(std::string _path) const noexcept;
+		// data derived at runtime and kept between launches, the directory is created on demand
+		std::string GetCachePath(std::string _path) const noexcept;
 	};
 }
 
@@ -1,16 +1,33 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
+
 #include <runtime/core/math/Math.h>
 #include <runtime/core/log/Log.h>
 
 namespace Horizon
 {
 
+	class TransientAttachmentPool;
+
 	struct RenderContext
 	{
 		u32 width;
 		u32 height;
 		u32 swap_chain_image_count = 3;
+		// places ALIASED_ATTACHMENT attachments, framebuffers without a pool allocate them like any other attachment
+		std::shared_ptr<TransientAttachmentPool> transient_attachment_pool = nullptr;
+		// fraction of width and height the scene passes render at, they draw into the top left corner of
+		// full size attachments and the post process pass upscales to the full size
+		f32 render_scale = 1.0f;
+
+		// render area of an attachment extent, also for attachments smaller than the full size
+		u32 GetRenderExtent(u32 extent) const noexcept { return (std::max)(static_cast<u32>(extent * render_scale + 0.5f), 1u); }
+		u32 GetRenderWidth() const noexcept { return GetRenderExtent(width); }
+		u32 GetRenderHeight() const noexcept { return GetRenderExtent(height); }
+		// render size over full size, maps a [0, 1] uv of the render area into the attachments
+		Math::vec2 GetRenderUvScale() const noexcept { return Math::vec2(static_cast<f32>(GetRenderWidth()) / width, static_cast<f32>(GetRenderHeight()) / height); }
 	};
 
 	enum class DescriptorType
@@ -20,7 +37,9 @@ namespace Horizon
 		DESCRIPTOR_TYPE_RW_BUFFER = 2,
 		//DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER = 4,
 		DESCRIPTOR_TYPE_TEXTURE,
-		DESCRIPTOR_TYPE_RW_TEXTURE
+		DESCRIPTOR_TYPE_RW_TEXTURE,
+		// attachment of an earlier subpass, read with subpassLoad
+		DESCRIPTOR_TYPE_INPUT_ATTACHMENT
 	};
 
 	//using DescriptorType = u32;
@@ -30,7 +49,7 @@ namespace Horizon
 		SHADER_STAGE_INVALID = 0,
 		SHADER_STAGE_VERTEX_SHADER = 1,
 		SHADER_STAGE_PIXEL_SHADER = 2,
-		SHADER_STAGE_COMPUTE_SHADER = 2,
+		SHADER_STAGE_COMPUTE_SHADER = 4,
 	};
 
 	enum PipelineStageFlags {
@@ -143,6 +162,8 @@ namespace Horizon
 		TEXTURE_FORMAT_RGB16_UNORM,
 		TEXTURE_FORMAT_RGBA16_UNORM,
 
+		// srgb encoded, linear when sampled
+		TEXTURE_FORMAT_RGBA8_SRGB,
 
 		// signed int
 		TEXTURE_FORMAT_R8_SINT,
@@ -212,6 +233,8 @@ namespace Horizon
 			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		case DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE:
 			return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		case DescriptorType::DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
 		default:
 			LOG_ERROR("invalid descriptor type");
 			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
@@ -311,6 +334,8 @@ namespace Horizon
 			return VK_FORMAT_R16G16B16_UNORM;
 		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM:
 			return VK_FORMAT_R16G16B16A16_UNORM;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB:
+			return VK_FORMAT_R8G8B8A8_SRGB;
 		case Horizon::TextureFormat::TEXTURE_FORMAT_R8_SINT:
 			return VK_FORMAT_R8_SINT;
 		case Horizon::TextureFormat::TEXTURE_FORMAT_RG8_SINT:
@@ -335,6 +360,18 @@ namespace Horizon
 			return VK_FORMAT_R32G32B32_SINT;
 		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA32_SINT:
 			return VK_FORMAT_R32G32B32A32_SINT;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R8_SNORM:
+			return VK_FORMAT_R8_SNORM;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG8_SNORM:
+			return VK_FORMAT_R8G8_SNORM;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_SNORM:
+			return VK_FORMAT_R8G8B8A8_SNORM;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_SNORM:
+			return VK_FORMAT_R16_SNORM;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_SNORM:
+			return VK_FORMAT_R16G16_SNORM;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_SNORM:
+			return VK_FORMAT_R16G16B16A16_SNORM;
 		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_SFLOAT:
 			return VK_FORMAT_R16_SFLOAT;
 		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_SFLOAT:
@@ -359,6 +396,79 @@ namespace Horizon
 		}
 	}
 
+	// bytes per texel, tightly packed as in a buffer to image copy
+	inline u32 GetTextureFormatSize(TextureFormat format)
+	{
+		switch (format)
+		{
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R8_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R8_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R8_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R8_SNORM:
+			return 1;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG8_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG8_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG8_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG8_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R16_SFLOAT:
+			return 2;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB8_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB8_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB8_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB8_SNORM:
+			return 3;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA8_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG16_SFLOAT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R32_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R32_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R32_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_R32_SFLOAT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_D32_SFLOAT:
+			return 4;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB16_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB16_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB16_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB16_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB16_SFLOAT:
+			return 6;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG32_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG32_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG32_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RG32_SFLOAT:
+			return 8;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB32_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB32_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB32_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGB32_SFLOAT:
+			return 12;
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA32_UINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA32_SINT:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA32_SNORM:
+		case Horizon::TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT:
+			return 16;
+		default:
+			LOG_ERROR("invalid format");
+			return 0;
+		}
+	}
+
 	inline VkImageUsageFlags ToVkImageUsage(u32 usage)
 	{
 		VkImageUsageFlags flags = 0;
@@ -368,6 +478,8 @@ namespace Horizon
 		if (usage & TextureUsage::TEXTURE_USAGE_RW) {
 			flags |= VK_IMAGE_USAGE_STORAGE_BIT;
 			flags |= VK_IMAGE_USAGE_SAMPLED_BIT;
+			// compute results can be read back and restored
+			flags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 		}
 		if (flags == 0)
 		{
@@ -28,6 +28,18 @@ namespace Horizon {
 
 		assert(aspectMask > 0);
 
+		if (create_info.usage & AttachmentUsageFlags::INPUT_ATTACHMENT) {
+			usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+		}
+		// transient images may only be used as attachments
+		bool transient = create_info.usage & AttachmentUsageFlags::TRANSIENT_ATTACHMENT;
+		if (transient) {
+			usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		}
+		else {
+			usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+		}
+
 		VkImageCreateInfo image_create_info{};
 		image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		image_create_info.imageType = ToVkImageType(create_info.texture_type);
@@ -39,39 +51,72 @@ namespace Horizon {
 		image_create_info.arrayLayers = 1;
 		image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
 		image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-		image_create_info.usage = usage | VK_IMAGE_USAGE_SAMPLED_BIT;
-
-		VkMemoryAllocateInfo memAlloc{};
-		VkMemoryRequirements memReqs{};
+		image_create_info.usage = usage;
 
 		CHECK_VK_RESULT(vkCreateImage(device->Get(), &image_create_info, nullptr, &m_image));
-		vkGetImageMemoryRequirements(device->Get(), m_image, &memReqs);
-		memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memAlloc.allocationSize = memReqs.size;
-		memAlloc.memoryTypeIndex = FindMemoryType(device->getPhysicalDevice(), memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		CHECK_VK_RESULT(vkAllocateMemory(device->Get(), &memAlloc, nullptr, &m_image_memory));
-		CHECK_VK_RESULT(vkBindImageMemory(device->Get(), m_image, m_image_memory, 0));
 
-		VkImageViewCreateInfo imageView{};
-		imageView.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		m_aspect_mask = aspectMask;
 		switch (image_create_info.imageType)
 		{
 		case VK_IMAGE_TYPE_1D:
-			imageView.viewType = VK_IMAGE_VIEW_TYPE_1D;
+			m_view_type = VK_IMAGE_VIEW_TYPE_1D;
 			break;
 		case VK_IMAGE_TYPE_2D:
-			imageView.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			m_view_type = VK_IMAGE_VIEW_TYPE_2D;
 			break;
 		case VK_IMAGE_TYPE_3D:
-			imageView.viewType = VK_IMAGE_VIEW_TYPE_3D;
+			m_view_type = VK_IMAGE_VIEW_TYPE_3D;
 			break;
 		default:
-			imageView.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			m_view_type = VK_IMAGE_VIEW_TYPE_2D;
 			break;
 		}
+
+		m_aliased = create_info.usage & AttachmentUsageFlags::ALIASED_ATTACHMENT;
+		if (m_aliased) {
+			return;
+		}
+
+		VkMemoryAllocateInfo memAlloc{};
+		VkMemoryRequirements memReqs{};
+
+		vkGetImageMemoryRequirements(device->Get(), m_image, &memReqs);
+		memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memAlloc.allocationSize = memReqs.size;
+		memAlloc.memoryTypeIndex = FindMemoryType(device->getPhysicalDevice(), memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (transient) {
+			// tile based gpus back lazily allocated memory only when the attachment has to leave tile memory,
+			// desktop gpus have no such memory type and keep the device local allocation
+			VkPhysicalDeviceMemoryProperties memory_properties;
+			vkGetPhysicalDeviceMemoryProperties(device->getPhysicalDevice(), &memory_properties);
+			for (u32 i = 0; i < memory_properties.memoryTypeCount; i++) {
+				if ((memReqs.memoryTypeBits & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)) {
+					memAlloc.memoryTypeIndex = i;
+					break;
+				}
+			}
+		}
+		CHECK_VK_RESULT(vkAllocateMemory(device->Get(), &memAlloc, nullptr, &m_image_memory));
+		CHECK_VK_RESULT(vkBindImageMemory(device->Get(), m_image, m_image_memory, 0));
+
+		CreateView(device);
+	}
+
+	void Attachment::BindMemory(std::shared_ptr<Device> device, VkDeviceMemory memory, VkDeviceSize offset)
+	{
+		// the memory belongs to the pool, m_image_memory stays null so the framebuffer does not free it
+		CHECK_VK_RESULT(vkBindImageMemory(device->Get(), m_image, memory, offset));
+		CreateView(device);
+	}
+
+	void Attachment::CreateView(std::shared_ptr<Device> device)
+	{
+		VkImageViewCreateInfo imageView{};
+		imageView.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		imageView.viewType = m_view_type;
 		imageView.format = m_format;
 		imageView.subresourceRange = {};
-		imageView.subresourceRange.aspectMask = aspectMask;
+		imageView.subresourceRange.aspectMask = m_aspect_mask;
 		imageView.subresourceRange.baseMipLevel = 0;
 		imageView.subresourceRange.levelCount = 1;
 		imageView.subresourceRange.baseArrayLayer = 0;
@@ -14,7 +14,14 @@ namespace Horizon {
 		NONE = 0,
 		COLOR_ATTACHMENT = 1,
 		DEPTH_STENCIL_ATTACHMENT = 2,
-		PRESENT_SRC = 4
+		PRESENT_SRC = 4,
+		// read with subpassLoad by a later subpass of the same render pass
+		INPUT_ATTACHMENT = 8,
+		// contents do not outlive the render pass: not stored, not sampled, lazily allocated where supported.
+		// set by the subpass framebuffer for attachments no later pass reads
+		TRANSIENT_ATTACHMENT = 16,
+		// memory is bound by the TransientAttachmentPool, shared with attachments whose lifetimes do not overlap
+		ALIASED_ATTACHMENT = 32
 	};
 	using AttachmentUsage = u32;
 
@@ -30,10 +37,19 @@ namespace Horizon {
 	public:
 		Attachment(std::shared_ptr<Device> device, const AttachmentCreateInfo create_info);
 
+		// aliased attachments have no memory and no view until the pool binds them
+		void BindMemory(std::shared_ptr<Device> device, VkDeviceMemory memory, VkDeviceSize offset);
+
 		VkImage m_image;
-		VkDeviceMemory m_image_memory;
-		VkImageView m_image_view;
+		VkDeviceMemory m_image_memory = VK_NULL_HANDLE;
+		VkImageView m_image_view = VK_NULL_HANDLE;
 		VkFormat m_format;
+		bool m_aliased = false;
+	private:
+		void CreateView(std::shared_ptr<Device> device);
+
+		VkImageAspectFlags m_aspect_mask = 0;
+		VkImageViewType m_view_type = VK_IMAGE_VIEW_TYPE_2D;
 	};
 
 	class AttachmentDescriptor :public DescriptorBase {
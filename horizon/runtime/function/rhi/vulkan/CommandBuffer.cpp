@@ -6,7 +6,7 @@
 
 namespace Horizon {
 
-	CommandBuffer::CommandBuffer(RenderContext& render_context, std::shared_ptr<Device> device) :m_render_context(render_context), m_device(device)
+	CommandBuffer::CommandBuffer(RenderContext& render_context, std::shared_ptr<Device> device, CommandQueue queue) :m_render_context(render_context), m_device(device), m_queue(queue)
 	{
 		createCommandPool();
 		allocateCommandBuffers();
@@ -18,6 +18,7 @@ namespace Horizon {
 		for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 			vkDestroySemaphore(m_device->Get(), m_render_finished_semaphores[i], nullptr);
 			vkDestroySemaphore(m_device->Get(), m_image_available_semaphores[i], nullptr);
+			vkDestroySemaphore(m_device->Get(), m_compute_finished_semaphores[i], nullptr);
 			vkDestroyFence(m_device->Get(), m_in_flight_fences[i], nullptr);
 		}
 		vkDestroyCommandPool(m_device->Get(), m_command_pool, nullptr);
@@ -29,7 +30,12 @@ namespace Horizon {
 		return m_command_buffers[i];
 	}
 
-	void CommandBuffer::submit(std::shared_ptr<SwapChain> swap_chain)
+	CommandQueue CommandBuffer::GetQueue() const noexcept
+	{
+		return m_queue;
+	}
+
+	void CommandBuffer::submit(std::shared_ptr<SwapChain> swap_chain, const AsyncComputeSubmit& async_compute)
 	{
 		vkWaitForFences(m_device->Get(), 1, &m_in_flight_fences[m_current_frame], VK_TRUE, UINT64_MAX);
 
@@ -40,13 +46,40 @@ namespace Horizon {
 			vkWaitForFences(m_device->Get(), 1, &m_images_in_flight[imageIndex], VK_TRUE, UINT64_MAX);
 		}
 		m_images_in_flight[imageIndex] = m_in_flight_fences[m_current_frame];
+		m_last_submitted_image = imageIndex;
+
+		bool async = async_compute.compute != nullptr;
+		if (async) {
+			VkCommandBuffer compute_command_buffer = async_compute.compute->Get(imageIndex);
+			VkSubmitInfo compute_submit_info{};
+			compute_submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			compute_submit_info.commandBufferCount = 1;
+			compute_submit_info.pCommandBuffers = &compute_command_buffer;
+			compute_submit_info.signalSemaphoreCount = 1;
+			compute_submit_info.pSignalSemaphores = &m_compute_finished_semaphores[m_current_frame];
+			CHECK_VK_RESULT(vkQueueSubmit(m_device->getComputeQueue(), 1, &compute_submit_info, VK_NULL_HANDLE));
+		}
+
+		// the overlapping part waits for nothing, it does not touch the swap chain image or the compute results
+		std::vector<VkSubmitInfo> submitInfos;
+		VkCommandBuffer overlap_command_buffer = VK_NULL_HANDLE;
+		if (async && async_compute.overlap) {
+			overlap_command_buffer = async_compute.overlap->Get(imageIndex);
+			VkSubmitInfo overlapSubmitInfo{};
+			overlapSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			overlapSubmitInfo.commandBufferCount = 1;
+			overlapSubmitInfo.pCommandBuffers = &overlap_command_buffer;
+			submitInfos.push_back(overlapSubmitInfo);
+		}
 
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-		VkSemaphore waitSemaphores[] = { m_image_available_semaphores[m_current_frame] };
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submitInfo.waitSemaphoreCount = 1;
+		VkSemaphore waitSemaphores[] = { m_image_available_semaphores[m_current_frame], m_compute_finished_semaphores[m_current_frame] };
+		// a frame that reads none of the compute results still ends after them
+		VkPipelineStageFlags computeWaitStages = async_compute.wait_stages ? ToVkPipelineStage(async_compute.wait_stages) : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, computeWaitStages };
+		submitInfo.waitSemaphoreCount = async ? 2 : 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 
@@ -56,10 +89,11 @@ namespace Horizon {
 		VkSemaphore signalSemaphores[] = { m_render_finished_semaphores[m_current_frame] };
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
+		submitInfos.push_back(submitInfo);
 
 		vkResetFences(m_device->Get(), 1, &m_in_flight_fences[m_current_frame]);
 
-		CHECK_VK_RESULT(vkQueueSubmit(m_device->getGraphicQueue(), 1, &submitInfo, m_in_flight_fences[m_current_frame]));
+		CHECK_VK_RESULT(vkQueueSubmit(m_device->getGraphicQueue(), static_cast<u32>(submitInfos.size()), submitInfos.data(), m_in_flight_fences[m_current_frame]));
 
 		VkPresentInfoKHR presentInfo{};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -76,9 +110,15 @@ namespace Horizon {
 		vkQueuePresentKHR(m_device->getPresnetQueue(), &presentInfo);
 
 		m_current_frame = (m_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+		// the graphics queue waited for the compute work, so it is idle too
 		vkQueueWaitIdle(m_device->getGraphicQueue());
 	}
 
+	u32 CommandBuffer::lastSubmittedImage() const noexcept
+	{
+		return m_last_submitted_image;
+	}
+
 	VkCommandPool CommandBuffer::getCommandpool() const noexcept 
 	{
 		return m_command_pool;
@@ -90,10 +130,10 @@ namespace Horizon {
 		// like the graphicsand presentation queues we retrieved.Each command pool can
 		// only allocate command buffers that are submitted on a single type of queue
 		// We're going to record commands for drawing, which is why we've chosen the
-		// graphics queue family.
+		// graphics queue family. async compute work goes to the compute family.
 		VkCommandPoolCreateInfo command_pool_create_info{};
 		command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		command_pool_create_info.queueFamilyIndex = m_device->getQueueFamilyIndices().getGraphics();
+		command_pool_create_info.queueFamilyIndex = m_queue == CommandQueue::COMPUTE ? m_device->getQueueFamilyIndices().getCompute() : m_device->getQueueFamilyIndices().getGraphics();
 		command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
 		CHECK_VK_RESULT(vkCreateCommandPool(m_device->Get(), &command_pool_create_info, nullptr, &m_command_pool));
@@ -119,20 +159,29 @@ namespace Horizon {
 		CHECK_VK_RESULT(vkAllocateCommandBuffers(m_device->Get(), &commandBufferAllocateInfo, m_command_buffers.data()));
 	}
 
-	void CommandBuffer::beginRenderPass(u32 index, std::shared_ptr<Pipeline> pipeline, bool is_present) const noexcept 
+	void CommandBuffer::beginRenderPass(u32 index, std::shared_ptr<Pipeline> pipeline, bool is_present, bool load_attachments) const noexcept 
 	{
 		std::shared_ptr<GraphicsPipeline> _pipeline = std::static_pointer_cast<GraphicsPipeline>(pipeline);
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = _pipeline->getRenderPass();
+		renderPassInfo.renderPass = load_attachments ? _pipeline->getLoadRenderPass() : _pipeline->getRenderPass();
 		if (is_present) {
 			renderPassInfo.framebuffer = _pipeline->getFrameBuffer(index);
 		}
 		else {
 			renderPassInfo.framebuffer = _pipeline->getFrameBuffer();
 		}
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = VkExtent2D{ static_cast<u32>(_pipeline->getViewport().width), static_cast<u32>(-_pipeline->getViewport().height)};
+		// viewport is flipped, y is the bottom edge and the height negative
+		VkViewport viewport = _pipeline->getViewport();
+		if (_pipeline->hasDynamicResolution()) {
+			viewport.width = static_cast<f32>(m_render_context.GetRenderExtent(static_cast<u32>(viewport.width)));
+			viewport.height = -static_cast<f32>(m_render_context.GetRenderExtent(static_cast<u32>(-viewport.height)));
+			viewport.y = -viewport.height;
+		}
+		VkRect2D render_area{};
+		render_area.offset = { 0, 0 };
+		render_area.extent = VkExtent2D{ static_cast<u32>(viewport.width), static_cast<u32>(-viewport.height) };
+		renderPassInfo.renderArea = render_area;
 
 
 		auto& clearValues = _pipeline->getClearValues();
@@ -140,7 +189,8 @@ namespace Horizon {
 		renderPassInfo.pClearValues = clearValues.data();
 
 		vkCmdBeginRenderPass(m_command_buffers[index], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdSetViewport(m_command_buffers[index], 0, 1, &_pipeline->getViewport());
+		vkCmdSetViewport(m_command_buffers[index], 0, 1, &viewport);
+		vkCmdSetScissor(m_command_buffers[index], 0, 1, &render_area);
 	}
 
 	void CommandBuffer::endRenderPass(u32 index) const noexcept 
@@ -148,6 +198,11 @@ namespace Horizon {
 		vkCmdEndRenderPass(m_command_buffers[index]);
 	}
 
+	void CommandBuffer::nextSubpass(u32 index) const noexcept
+	{
+		vkCmdNextSubpass(m_command_buffers[index], VK_SUBPASS_CONTENTS_INLINE);
+	}
+
 
 	void CommandBuffer::createSyncObjects()
 	{
@@ -159,12 +214,14 @@ namespace Horizon {
 	{
 		m_image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
 		m_render_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
+		m_compute_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
 		VkSemaphoreCreateInfo semaphoreCreateInfo{};
 		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
 		for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 			CHECK_VK_RESULT(vkCreateSemaphore(m_device->Get(), &semaphoreCreateInfo, nullptr, &m_image_available_semaphores[i]));
 			CHECK_VK_RESULT(vkCreateSemaphore(m_device->Get(), &semaphoreCreateInfo, nullptr, &m_render_finished_semaphores[i]));
+			CHECK_VK_RESULT(vkCreateSemaphore(m_device->Get(), &semaphoreCreateInfo, nullptr, &m_compute_finished_semaphores[i]));
 		}
 	}
 
@@ -210,8 +267,9 @@ namespace Horizon {
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &command_buffer;
 
-		vkQueueSubmit(m_device->getGraphicQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(m_device->getGraphicQueue());
+		VkQueue queue = m_queue == CommandQueue::COMPUTE ? m_device->getComputeQueue() : m_device->getGraphicQueue();
+		vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(queue);
 
 		vkFreeCommandBuffers(m_device->Get(), m_command_pool, 1, &command_buffer);
 	}
@@ -235,6 +293,12 @@ namespace Horizon {
 	}
 
 	void CommandBuffer::Dispatch(u32 i, std::shared_ptr<Pipeline> pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets) noexcept
+	{
+		std::shared_ptr<ComputePipeline> _pipeline = std::static_pointer_cast<ComputePipeline>(pipeline);
+		Dispatch(i, pipeline, _descriptor_sets, _pipeline->GroupCountX(), _pipeline->GroupCountY(), _pipeline->GroupCountZ());
+	}
+
+	void CommandBuffer::Dispatch(u32 i, std::shared_ptr<Pipeline> pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets, u32 group_count_x, u32 group_count_y, u32 group_count_z) noexcept
 	{
 		if (pipeline->GetType() != PipelineType::COMPUTE) {
 			LOG_ERROR("incorrect pipeline type");
@@ -257,6 +321,6 @@ namespace Horizon {
 			vkCmdBindDescriptorSets(m_command_buffers[i], VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline->GetLayout(), 0, descriptor_sets.size(), descriptor_sets.data(), 0, 0);
 		}
 		vkCmdBindPipeline(m_command_buffers[i], VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline->Get());
-		vkCmdDispatch(m_command_buffers[i], _pipeline->GroupCountX(), _pipeline->GroupCountY(), _pipeline->GroupCountZ());
+		vkCmdDispatch(m_command_buffers[i], group_count_x, group_count_y, group_count_z);
 	}
 }
\ No newline at end of file
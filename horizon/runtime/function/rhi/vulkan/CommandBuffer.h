@@ -11,16 +11,37 @@
 
 namespace Horizon {
 
+	// queue family the command buffers are allocated for
+	enum class CommandQueue {
+		GRAPHICS,
+		COMPUTE
+	};
+
+	class CommandBuffer;
+
+	// work of a frame on the compute queue. it is submitted first and runs next to the graphics work recorded in overlap,
+	// the graphics work recorded after waits for it at wait_stages
+	struct AsyncComputeSubmit {
+		std::shared_ptr<CommandBuffer> compute;
+		std::shared_ptr<CommandBuffer> overlap;
+		u32 wait_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+	};
+
 	class CommandBuffer
 	{
 	public:
-		CommandBuffer(RenderContext& render_context, std::shared_ptr<Device> device);
+		CommandBuffer(RenderContext& render_context, std::shared_ptr<Device> device, CommandQueue queue = CommandQueue::GRAPHICS);
 		~CommandBuffer();
 		VkCommandBuffer Get(u32 i) const noexcept;
-		void submit(std::shared_ptr<SwapChain> swap_chain);
+		CommandQueue GetQueue() const noexcept;
+		// the swap chain image picks the command buffer of every command buffer object in the submit
+		void submit(std::shared_ptr<SwapChain> swap_chain, const AsyncComputeSubmit& async_compute = {});
+		// swap chain image, and so command buffer, of the last submit
+		u32 lastSubmittedImage() const noexcept;
 		VkCommandPool getCommandpool() const noexcept;
-		void beginRenderPass(u32 index, std::shared_ptr<Pipeline> pipeline, bool is_present = false) const noexcept;
+		void beginRenderPass(u32 index, std::shared_ptr<Pipeline> pipeline, bool is_present = false, bool load_attachments = false) const noexcept;
 		void endRenderPass(u32 index) const noexcept;
+		void nextSubpass(u32 index) const noexcept;
 		VkCommandBuffer beginSingleTimeCommands();
 		void endSingleTimeCommands(VkCommandBuffer command_buffer);
 		u32 commandBufferCount() const noexcept { return m_command_buffers.size(); }
@@ -28,6 +49,8 @@ namespace Horizon {
 		void beginCommandRecording(u32 index);
 		void endCommandRecording(u32 index);
 		void Dispatch(u32 i, std::shared_ptr<Pipeline> pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets) noexcept;
+		// group counts decided at record time, e.g. from the number of instances
+		void Dispatch(u32 i, std::shared_ptr<Pipeline> pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets, u32 group_count_x, u32 group_count_y, u32 group_count_z) noexcept;
 	private:
 		void createCommandPool();
 		void allocateCommandBuffers();
@@ -37,6 +60,7 @@ namespace Horizon {
 	private:
 		RenderContext& m_render_context;
 		std::shared_ptr<Device> m_device = nullptr;
+		CommandQueue m_queue;
 
 		VkCommandPool m_command_pool = nullptr;
 		std::vector<VkCommandBuffer> m_command_buffers;
@@ -46,10 +70,13 @@ namespace Horizon {
 		// class members to store these semaphore objects:
 		std::vector<VkSemaphore> m_image_available_semaphores;
 		std::vector<VkSemaphore> m_render_finished_semaphores;
+		// signaled by the async compute work of the frame
+		std::vector<VkSemaphore> m_compute_finished_semaphores;
 		std::vector<VkFence> m_in_flight_fences;
 		std::vector<VkFence> m_images_in_flight;
 		const int MAX_FRAMES_IN_FLIGHT = 2;
 		u32 m_current_frame = 0;
+		u32 m_last_submitted_image = 0;
 	};
 
 }
\ No newline at end of file
@@ -58,6 +58,7 @@ namespace Horizon {
 			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
 			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
 			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
 				descriptorWrites[binding].pImageInfo = &desc.descriptorMap.at(binding).get()->imageDescriptorInfo;
 				break;
 			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
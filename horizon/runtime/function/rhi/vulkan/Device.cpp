@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <set>
+#include <cstring>
 
 #include <runtime/core/log/Log.h>
 
@@ -44,6 +45,11 @@ namespace Horizon {
 		return m_present_queue;
 	}
 
+	VkQueue Device::getComputeQueue() const noexcept
+	{
+		return m_compute_queue;
+	}
+
 	bool Device::isDeviceSuitable(VkPhysicalDevice device)
 	{
 		QueueFamilyIndices indices(device, m_surface->Get());
@@ -95,27 +101,45 @@ namespace Horizon {
 
 		// The queueFamilyIndex member of each element of pQueueCreateInfos must be unique within pQueueCreateInfos
 		// except that two members can share the same queueFamilyIndex if one is a protected-capable queue and one is not a protected-capable queue
-		std::set<u32> unique_queue_families{ m_queue_family_indices.getGraphics(), m_queue_family_indices.getPresent() };
+		std::set<u32> unique_queue_families{ m_queue_family_indices.getGraphics(), m_queue_family_indices.getPresent(), m_queue_family_indices.getCompute() };
 
 		f32 queue_priority = 1.0f;
 		for (u32 queue_family : unique_queue_families) {
 			device_queue_create_info.emplace_back(VkDeviceQueueCreateInfo{ VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO ,nullptr,0,queue_family,1,&queue_priority });
 		}
 
-		VkPhysicalDeviceFeatures deviceFeatures{};
+		// features used by gpu driven rendering, enabled only when supported
+		VkPhysicalDeviceFeatures supported_features{};
+		vkGetPhysicalDeviceFeatures(m_physical_devices[m_physical_device_index], &supported_features);
+		m_enabled_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+		m_enabled_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+		// fragment invocation counts of the geometry pass
+		m_enabled_features.pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery;
+
+		std::vector<const char*> enabled_extensions = m_device_extensions;
+		for (auto extension : m_optional_device_extensions) {
+			if (isExtensionAvailable(m_physical_devices[m_physical_device_index], extension)) {
+				enabled_extensions.push_back(extension);
+			}
+		}
 
 		VkDeviceCreateInfo device_create_info{};
 		device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 		device_create_info.pQueueCreateInfos = device_queue_create_info.data();
 		device_create_info.queueCreateInfoCount = static_cast<u32>(device_queue_create_info.size());
-		device_create_info.pEnabledFeatures = &deviceFeatures;
-		device_create_info.enabledExtensionCount = static_cast<u32>(m_device_extensions.size());
-		device_create_info.ppEnabledExtensionNames = m_device_extensions.data();
+		device_create_info.pEnabledFeatures = &m_enabled_features;
+		device_create_info.enabledExtensionCount = static_cast<u32>(enabled_extensions.size());
+		device_create_info.ppEnabledExtensionNames = enabled_extensions.data();
 
 		CHECK_VK_RESULT(vkCreateDevice(m_physical_devices[m_physical_device_index], &device_create_info, nullptr, &m_device));
 
+		if (isExtensionAvailable(m_physical_devices[m_physical_device_index], VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+			m_draw_indexed_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(m_device, "vkCmdDrawIndexedIndirectCountKHR"));
+		}
+
 		vkGetDeviceQueue(m_device, m_queue_family_indices.getGraphics(), 0, &m_graphics_queue);
 		vkGetDeviceQueue(m_device, m_queue_family_indices.getPresent(), 0, &m_present_queue);
+		vkGetDeviceQueue(m_device, m_queue_family_indices.getCompute(), 0, &m_compute_queue);
 
 	}
 
@@ -135,9 +159,35 @@ namespace Horizon {
 		return required_extensions.empty();
 	}
 
+	bool Device::isExtensionAvailable(VkPhysicalDevice device, const char* extension_name)
+	{
+		u32 extension_count;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
+
+		std::vector<VkExtensionProperties> available_extensions(extension_count);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
+
+		for (const auto& extension : available_extensions) {
+			if (strcmp(extension.extensionName, extension_name) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	QueueFamilyIndices Device::getQueueFamilyIndices() const noexcept 
 	{
 		return m_queue_family_indices;
 	}
 
+	const VkPhysicalDeviceFeatures& Device::GetEnabledFeatures() const noexcept
+	{
+		return m_enabled_features;
+	}
+
+	PFN_vkCmdDrawIndexedIndirectCountKHR Device::GetDrawIndexedIndirectCountFunction() const noexcept
+	{
+		return m_draw_indexed_indirect_count;
+	}
+
 }
\ No newline at end of file
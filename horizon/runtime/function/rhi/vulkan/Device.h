@@ -19,7 +19,12 @@ namespace Horizon {
 		VkDevice Get()const noexcept;
 		VkQueue getGraphicQueue() const noexcept;
 		VkQueue getPresnetQueue() const noexcept;
+		// the graphics queue when there is no separate compute family
+		VkQueue getComputeQueue() const noexcept;
 		QueueFamilyIndices getQueueFamilyIndices() const noexcept;
+		const VkPhysicalDeviceFeatures& GetEnabledFeatures() const noexcept;
+		// VK_KHR_draw_indirect_count, nullptr if the extension is not available
+		PFN_vkCmdDrawIndexedIndirectCountKHR GetDrawIndexedIndirectCountFunction() const noexcept;
 	private:
 		bool isDeviceSuitable(VkPhysicalDevice device);
 		// pick the best gpu
@@ -30,6 +35,7 @@ namespace Horizon {
 		void createDevice(const ValidationLayer& validation_layers);
 
 		bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+		bool isExtensionAvailable(VkPhysicalDevice device, const char* extension_name);
 
 
 	private:
@@ -37,11 +43,15 @@ namespace Horizon {
 		i32 m_physical_device_index = -1;
 		std::vector<VkPhysicalDevice> m_physical_devices;
 		VkDevice m_device{};
-		VkQueue m_graphics_queue, m_present_queue;
+		VkQueue m_graphics_queue, m_present_queue, m_compute_queue;
 		QueueFamilyIndices m_queue_family_indices;
 		std::shared_ptr<Instance> m_instance = nullptr;
 		std::shared_ptr<Surface> m_surface = nullptr;
 		const std::vector<const char*> m_device_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_MAINTENANCE1_EXTENSION_NAME };
+		// enabled when available
+		const std::vector<const char*> m_optional_device_extensions = { VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME };
+		VkPhysicalDeviceFeatures m_enabled_features{};
+		PFN_vkCmdDrawIndexedIndirectCountKHR m_draw_indexed_indirect_count = nullptr;
 	};
 
 }
\ No newline at end of file
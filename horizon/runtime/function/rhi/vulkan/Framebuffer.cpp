@@ -1,6 +1,9 @@
 #include "Framebuffer.h"
 
+#include <algorithm>
+
 #include <runtime/core/log/Log.h>
+#include "TransientAttachmentPool.h"
 
 namespace Horizon {
 
@@ -12,12 +15,29 @@ namespace Horizon {
 			createFrameBuffer(m_render_context.width, m_render_context.height, m_render_context.swap_chain_image_count, swap_chain);
 		}
 		else {
-			createFrameBuffer(m_render_context.width, m_render_context.height, 1);
+			m_load_render_pass = std::make_shared<RenderPass>(m_device, attachment_create_info, true);
+			createFrameBufferOrRegister();
+		}
+	}
+
+	Framebuffer::Framebuffer(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, const std::vector<SubpassCreateInfo>& subpass_create_info, const std::vector<u32>& read_after, RenderContext& render_context) :m_render_context(render_context), m_device(device)
+	{
+		std::vector<AttachmentCreateInfo> create_info = attachment_create_info;
+		for (u32 i = 0; i < create_info.size(); i++) {
+			if (std::find(read_after.begin(), read_after.end(), i) == read_after.end()) {
+				create_info[i].usage |= AttachmentUsageFlags::TRANSIENT_ATTACHMENT;
+			}
 		}
+		createAttachmentsResources(create_info);
+		m_render_pass = std::make_shared<RenderPass>(m_device, create_info, subpass_create_info, read_after);
+		createFrameBufferOrRegister();
 	}
 
 	Framebuffer::~Framebuffer()
 	{
+		if (m_transient_attachment_pool) {
+			m_transient_attachment_pool->Unregister(this);
+		}
 		vkDestroySampler(m_device->Get(), m_sampler, nullptr);
 		for (auto& attachment : m_frame_buffer_attachments) {
 			vkDestroyImage(m_device->Get(), attachment.m_image, nullptr);
@@ -44,10 +64,21 @@ namespace Horizon {
 		return m_render_pass->Get();
 	}
 
+	VkRenderPass Framebuffer::getLoadRenderPass() const noexcept
+	{
+		if (!m_load_render_pass) {
+			LOG_ERROR("swap chain framebuffers have no load render pass");
+			return VK_NULL_HANDLE;
+		}
+		return m_load_render_pass->Get();
+	}
+
 	std::shared_ptr<AttachmentDescriptor> Framebuffer::getDescriptorImageInfo(u32 attachment_index)
 	{
 		std::shared_ptr<AttachmentDescriptor> attachmentDescriptor = std::make_shared<AttachmentDescriptor>();
-		attachmentDescriptor->imageDescriptorInfo = { m_sampler, m_frame_buffer_attachments[attachment_index].m_image_view ,VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		// depth attachments are left in depth read only layout by the render pass
+		VkImageLayout layout = m_frame_buffer_attachments[attachment_index].m_format == VK_FORMAT_D32_SFLOAT ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		attachmentDescriptor->imageDescriptorInfo = { m_sampler, m_frame_buffer_attachments[attachment_index].m_image_view, layout };
 		return attachmentDescriptor;
 	}
 
@@ -69,6 +100,11 @@ namespace Horizon {
 		return m_render_pass->colorAttachmentCount;
 	}
 
+	u32 Framebuffer::getColorAttachmentCount(u32 subpass)
+	{
+		return m_render_pass->GetColorAttachmentCount(subpass);
+	}
+
 	std::vector<VkClearValue> Framebuffer::getClearValues()
 	{
 		std::vector<VkClearValue> clearValues;
@@ -113,9 +149,27 @@ namespace Horizon {
 		}
 	}
 
+	void Framebuffer::createFrameBufferOrRegister()
+	{
+		for (auto& attachment : m_frame_buffer_attachments) {
+			if (attachment.m_aliased) {
+				// views and framebuffers can only be created once the pool has bound the memory
+				m_transient_attachment_pool = m_render_context.transient_attachment_pool;
+				m_transient_attachment_pool->Register(this);
+				return;
+			}
+		}
+		createFrameBuffer(m_render_context.width, m_render_context.height, 1);
+	}
+
 	void Framebuffer::createAttachmentsResources(const std::vector<AttachmentCreateInfo>& attachment_create_info)
 	{
-		for (auto& create_info : attachment_create_info) {
+		// framebuffers created after the pool has placed its attachments keep dedicated memory
+		bool can_alias = m_render_context.transient_attachment_pool && !m_render_context.transient_attachment_pool->IsAllocated();
+		for (auto create_info : attachment_create_info) {
+			if (!can_alias) {
+				create_info.usage &= ~AttachmentUsageFlags::ALIASED_ATTACHMENT;
+			}
 			m_frame_buffer_attachments.emplace_back(m_device, create_info);
 		}
 
@@ -9,30 +9,46 @@
 #include "RenderPass.h"
 
 namespace Horizon {
+
+	class TransientAttachmentPool;
+
 	class Framebuffer
 	{
+		// binds the memory of aliased attachments and finishes the framebuffer
+		friend class TransientAttachmentPool;
 	public:
 		Framebuffer(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, RenderContext& render_context, std::shared_ptr<SwapChain> swap_chain = nullptr);
+		// one render pass with several subpasses over the attachments, there is no load render pass.
+		// attachments outside read_after are not read after the render pass and are created transient
+		Framebuffer(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, const std::vector<SubpassCreateInfo>& subpass_create_info, const std::vector<u32>& read_after, RenderContext& render_context);
 		~Framebuffer();
 		VkFramebuffer Get() const noexcept;
 		VkFramebuffer Get(u32 index) const noexcept;
 		VkRenderPass getRenderPass() const noexcept;
+		// compatible with getRenderPass(), but loads the attachments instead of clearing them
+		VkRenderPass getLoadRenderPass() const noexcept;
 		std::shared_ptr<AttachmentDescriptor> getDescriptorImageInfo(u32 attachment_index);
 		std::vector<VkImage> getPresentImages();
 		u32 getColorAttachmentCount();
+		u32 getColorAttachmentCount(u32 subpass);
 		std::vector<VkClearValue> getClearValues();
 	private:
 		void createFrameBuffer(u32 width, u32 height, u32 imag_count, std::shared_ptr<SwapChain> swap_chain = nullptr);
+		// defers the framebuffer to the transient attachment pool if an attachment is aliased
+		void createFrameBufferOrRegister();
 		void createAttachmentsResources(const std::vector<AttachmentCreateInfo>& attachment_create_info);
 	private:
 		RenderContext& m_render_context;
 		bool m_has_depth_attachment = false;
 		std::shared_ptr<Device> m_device = nullptr;
 		std::shared_ptr<RenderPass> m_render_pass;
+		std::shared_ptr<RenderPass> m_load_render_pass;
 		std::vector<VkFramebuffer> m_framebuffer;
 		// Shared sampler used for all color attachments
 		VkSampler m_sampler;
 		std::vector<Attachment> m_frame_buffer_attachments;
+		// set while the pool owns memory of this framebuffer's attachments
+		std::shared_ptr<TransientAttachmentPool> m_transient_attachment_pool = nullptr;
 
 	};
 }
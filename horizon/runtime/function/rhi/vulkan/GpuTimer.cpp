@@ -0,0 +1,111 @@
+#include "GpuTimer.h"
+
+#include <algorithm>
+#include <array>
+
+#include <runtime/core/log/Log.h>
+
+namespace Horizon {
+
+	GpuTimer::GpuTimer(std::shared_ptr<Device> device, u32 command_buffer_count, u32 scope_count) noexcept : m_device(device), m_scope_count(scope_count)
+	{
+		m_reset.resize(command_buffer_count, false);
+		m_resolved.resize(scope_count, false);
+		m_times.resize(scope_count, 0.0f);
+
+		u32 queue_family_count = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_device->getPhysicalDevice(), &queue_family_count, nullptr);
+		std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_device->getPhysicalDevice(), &queue_family_count, queue_families.data());
+		// scopes on either queue share the mask
+		QueueFamilyIndices queue_family_indices = m_device->getQueueFamilyIndices();
+		u32 valid_bits = std::min(queue_families[queue_family_indices.getGraphics()].timestampValidBits, queue_families[queue_family_indices.getCompute()].timestampValidBits);
+
+		if (valid_bits == 0) {
+			LOG_WARN("the graphics or the compute queue does not support timestamps, gpu timers read zero");
+			return;
+		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(m_device->getPhysicalDevice(), &properties);
+		m_timestamp_period = properties.limits.timestampPeriod;
+		m_timestamp_mask = valid_bits == 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+		VkQueryPoolCreateInfo query_pool_create_info{};
+		query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		query_pool_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		query_pool_create_info.queryCount = 2 * scope_count * command_buffer_count;
+		CHECK_VK_RESULT(vkCreateQueryPool(m_device->Get(), &query_pool_create_info, nullptr, &m_query_pool));
+	}
+
+	GpuTimer::~GpuTimer() noexcept
+	{
+		if (m_query_pool) {
+			vkDestroyQueryPool(m_device->Get(), m_query_pool, nullptr);
+		}
+	}
+
+	bool GpuTimer::IsSupported() const noexcept
+	{
+		return m_query_pool != VK_NULL_HANDLE;
+	}
+
+	void GpuTimer::Reset(u32 _i, std::shared_ptr<CommandBuffer> command_buffer) noexcept
+	{
+		Reset(_i, command_buffer, 0, m_scope_count);
+	}
+
+	void GpuTimer::Reset(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 first_scope, u32 scope_count) noexcept
+	{
+		if (!IsSupported()) {
+			return;
+		}
+		vkCmdResetQueryPool(command_buffer->Get(_i), m_query_pool, 2 * (m_scope_count * _i + first_scope), 2 * scope_count);
+		m_reset[_i] = true;
+	}
+
+	// both timestamps wait for all earlier work, so a scope measures the work recorded inside it
+	void GpuTimer::Begin(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept
+	{
+		if (!IsSupported()) {
+			return;
+		}
+		vkCmdWriteTimestamp(command_buffer->Get(_i), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, 2 * (m_scope_count * _i + scope));
+	}
+
+	void GpuTimer::End(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept
+	{
+		if (!IsSupported()) {
+			return;
+		}
+		vkCmdWriteTimestamp(command_buffer->Get(_i), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, 2 * (m_scope_count * _i + scope) + 1);
+	}
+
+	void GpuTimer::Resolve(u32 _i) noexcept
+	{
+		if (!IsSupported() || !m_reset[_i]) {
+			return;
+		}
+		for (u32 scope = 0; scope < m_scope_count; scope++) {
+			// value and availability of both timestamps
+			std::array<u64, 4> results{};
+			VkResult result = vkGetQueryPoolResults(m_device->Get(), m_query_pool, 2 * (m_scope_count * _i + scope), 2, sizeof(results), results.data(), 2 * sizeof(u64), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+			m_resolved[scope] = result == VK_SUCCESS && results[1] != 0 && results[3] != 0;
+			if (m_resolved[scope]) {
+				u64 ticks = (results[2] - results[0]) & m_timestamp_mask;
+				m_times[scope] = static_cast<f32>(static_cast<f64>(ticks) * m_timestamp_period * 1e-6);
+			}
+		}
+	}
+
+	bool GpuTimer::IsResolved(u32 scope) const noexcept
+	{
+		return m_resolved[scope];
+	}
+
+	f32 GpuTimer::GetTime(u32 scope) const noexcept
+	{
+		return m_times[scope];
+	}
+
+}
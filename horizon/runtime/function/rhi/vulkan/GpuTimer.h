@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <runtime/function/rhi/RenderContext.h>
+#include "CommandBuffer.h"
+#include "Device.h"
+
+namespace Horizon {
+
+	// timestamp pairs around scopes of each command buffer. scopes are indices chosen by the caller,
+	// Resolve reads back the ones a finished command buffer wrote and keeps the last value of the others
+	class GpuTimer
+	{
+	public:
+		GpuTimer(std::shared_ptr<Device> device, u32 command_buffer_count, u32 scope_count) noexcept;
+		~GpuTimer() noexcept;
+
+		// false when the graphics or the compute queue cannot write timestamps, scopes then read zero
+		bool IsSupported() const noexcept;
+
+		// resets the queries of the command buffer, record before any scope and outside of render passes
+		void Reset(u32 _i, std::shared_ptr<CommandBuffer> command_buffer) noexcept;
+		// only the given scopes, each queue resets the scopes it writes when a frame spans the graphics and the compute queue
+		void Reset(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 first_scope, u32 scope_count) noexcept;
+		void Begin(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept;
+		void End(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept;
+
+		// read the scopes of a command buffer whose submission has finished
+		void Resolve(u32 _i) noexcept;
+		// milliseconds, false if the scope was not recorded in the last resolved command buffer
+		bool IsResolved(u32 scope) const noexcept;
+		f32 GetTime(u32 scope) const noexcept;
+	private:
+		std::shared_ptr<Device> m_device;
+		VkQueryPool m_query_pool = VK_NULL_HANDLE;
+		u32 m_scope_count;
+		// nanoseconds per tick
+		f32 m_timestamp_period = 1.0f;
+		u64 m_timestamp_mask = ~0ull;
+		std::vector<bool> m_reset;
+		std::vector<bool> m_resolved;
+		std::vector<f32> m_times;
+	};
+
+}
@@ -51,8 +51,13 @@ namespace Horizon
 		std::shared_ptr<SwapChain> swap_chain) noexcept : Pipeline(device), m_render_context(render_context)
 	{
 		m_type = PipelineType::GRAPHICS;
+		m_dynamic_resolution = create_info.dynamic_resolution;
 		
-		if (swap_chain)
+		if (create_info.framebuffer)
+		{
+			m_framebuffer = create_info.framebuffer;
+		}
+		else if (swap_chain)
 		{
 			m_framebuffer = std::make_shared<Framebuffer>(m_device, attachment_create_info, m_render_context, swap_chain);
 		}
@@ -75,11 +80,21 @@ namespace Horizon
 		return m_viewport;
 	}
 
+	bool GraphicsPipeline::hasDynamicResolution() const noexcept
+	{
+		return m_dynamic_resolution;
+	}
+
 	VkRenderPass GraphicsPipeline::getRenderPass() const noexcept
 	{
 		return m_framebuffer->getRenderPass();
 	}
 
+	VkRenderPass GraphicsPipeline::getLoadRenderPass() const noexcept
+	{
+		return m_framebuffer->getLoadRenderPass();
+	}
+
 	VkFramebuffer GraphicsPipeline::getFrameBuffer() const noexcept
 	{
 		return m_framebuffer->Get();
@@ -105,6 +120,11 @@ namespace Horizon
 		return m_clear_values;
 	}
 
+	std::shared_ptr<Framebuffer> GraphicsPipeline::GetFramebuffer() const noexcept
+	{
+		return m_framebuffer;
+	}
+
 	void GraphicsPipeline::CreatePipelineLayout(const GraphicsPipelineCreateInfo& create_info)
 	{
 		//auto &layouts = create_info.descriptor_layouts;
@@ -147,6 +167,7 @@ namespace Horizon
 	{
 
 		std::array<VkPipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfos{};
+		u32 stage_count = create_info.ps ? 2 : 1;
 
 		// vertex shader
 		pipelineShaderStageCreateInfos[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -155,13 +176,15 @@ namespace Horizon
 		pipelineShaderStageCreateInfos[0].pName = "main";
 
 		// pixel shader
-		pipelineShaderStageCreateInfos[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		pipelineShaderStageCreateInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		pipelineShaderStageCreateInfos[1].module = create_info.ps->Get();
-		pipelineShaderStageCreateInfos[1].pName = "main";
+		if (create_info.ps) {
+			pipelineShaderStageCreateInfos[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineShaderStageCreateInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			pipelineShaderStageCreateInfos[1].module = create_info.ps->Get();
+			pipelineShaderStageCreateInfos[1].pName = "main";
+		}
 
-		auto& bindingDescription = Vertex::getBindingDescription();
-		auto& attributeDescriptions = Vertex::getAttributeDescriptions();
+		auto bindingDescription = create_info.position_only ? Vertex::getPositionBindingDescription() : Vertex::getBindingDescription();
+		auto attributeDescriptions = create_info.position_only ? Vertex::getPositionAttributeDescriptions() : Vertex::getAttributeDescriptions();
 
 		VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
 		vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -230,15 +253,15 @@ namespace Horizon
 		VkPipelineDepthStencilStateCreateInfo depthStencilCreateInfo{};
 		depthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 		depthStencilCreateInfo.depthTestEnable = VK_TRUE;
-		depthStencilCreateInfo.depthWriteEnable = VK_TRUE;
-		depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_GREATER;
+		depthStencilCreateInfo.depthWriteEnable = create_info.depth_equal ? VK_FALSE : VK_TRUE;
+		depthStencilCreateInfo.depthCompareOp = create_info.depth_equal ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_GREATER;
 		depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
 		depthStencilCreateInfo.stencilTestEnable = VK_FALSE;
 
-		std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachmentStates(m_framebuffer->getColorAttachmentCount());
+		std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachmentStates(m_framebuffer->getColorAttachmentCount(create_info.subpass));
 		for (auto& state : colorBlendAttachmentStates)
 		{
-			state.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+			state.colorWriteMask = create_info.ps ? VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT : 0;
 			state.blendEnable = VK_FALSE;
 		}
 		// colorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
@@ -259,8 +282,10 @@ namespace Horizon
 		colorBlendingStateCreateInfo.blendConstants[2] = 0.0f;
 		colorBlendingStateCreateInfo.blendConstants[3] = 0.0f;
 
-		std::array<VkDynamicState, 2> dynamicStates = {
+		// viewport and scissor are set at the start of the render pass, they shrink with the render scale
+		std::array<VkDynamicState, 3> dynamicStates = {
 			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR,
 			VK_DYNAMIC_STATE_LINE_WIDTH };
 
 		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
@@ -271,7 +296,7 @@ namespace Horizon
 		// create vk graphics pipeline
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
+		pipelineInfo.stageCount = stage_count;
 		pipelineInfo.pStages = pipelineShaderStageCreateInfos.data();
 		pipelineInfo.pVertexInputState = &vertexInputStateCreateInfo;
 		pipelineInfo.pInputAssemblyState = &inputAssemblyStateCreateInfo;
@@ -283,7 +308,7 @@ namespace Horizon
 		pipelineInfo.layout = m_pipeline_layout;
 		pipelineInfo.renderPass = getRenderPass();
 		pipelineInfo.pDynamicState = &dynamicStateCreateInfo;
-		pipelineInfo.subpass = 0;
+		pipelineInfo.subpass = create_info.subpass;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
 		CHECK_VK_RESULT(vkCreateGraphicsPipelines(m_device->Get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline));
@@ -330,7 +355,7 @@ namespace Horizon
 		RenderContext& _render_context,
 		std::shared_ptr<SwapChain> swap_chain)
 	{
-		std::string hashKey = "present";
+		std::string hashKey = GetPipelineKey(create_info);
 		// pipeline key exist
 		if (!m_pipeline_map[hashKey].pipeline)
 		{
@@ -20,9 +20,20 @@ namespace Horizon
 	struct GraphicsPipelineCreateInfo
 	{
 		std::string name;
+		// without a pixel shader the pipeline only writes depth, color writes are masked
 		std::shared_ptr<Shader> vs, ps;
 		std::shared_ptr<DescriptorSetLayouts> descriptor_layouts;
 		std::shared_ptr<PushConstants> push_constants;
+		// render into the framebuffer of another pipeline instead of creating new attachments
+		std::shared_ptr<Framebuffer> framebuffer = nullptr;
+		// subpass of the framebuffer's render pass the pipeline is used in
+		u32 subpass = 0;
+		// render area follows RenderContext::render_scale, for passes before the upscale
+		bool dynamic_resolution = false;
+		// vertex input is the position stream alone, for depth only passes
+		bool position_only = false;
+		// depth was laid down by a pre-pass, only fragments on the visible surface pass and depth is not written
+		bool depth_equal = false;
 		// VkPipelineVertexInputStateCreateInfo;
 		// descriptorsetlayout
 	};
@@ -63,12 +74,15 @@ namespace Horizon
 		~GraphicsPipeline() noexcept;
 
 		VkViewport getViewport() const noexcept;
+		bool hasDynamicResolution() const noexcept;
 		VkRenderPass getRenderPass() const noexcept;
+		VkRenderPass getLoadRenderPass() const noexcept;
 		VkFramebuffer getFrameBuffer() const noexcept;
 		VkFramebuffer getFrameBuffer(u32 index) const noexcept;
 		std::shared_ptr<AttachmentDescriptor> GetFrameBufferAttachment(u32 attahmentIndex) const noexcept;
 		std::vector<VkImage> getPresentImages() const noexcept;
 		std::vector<VkClearValue> getClearValues() const noexcept;
+		std::shared_ptr<Framebuffer> GetFramebuffer() const noexcept;
 
 	private:
 		void CreatePipelineLayout(const GraphicsPipelineCreateInfo& create_info);
@@ -78,6 +92,7 @@ namespace Horizon
 		std::shared_ptr<Framebuffer> m_framebuffer = nullptr;
 		std::vector<VkClearValue> m_clear_values;
 		VkViewport m_viewport;
+		bool m_dynamic_resolution = false;
 	};
 
 	class ComputePipeline : public Pipeline {
@@ -0,0 +1,91 @@
+#include "PipelineStatistics.h"
+
+#include <array>
+
+#include <runtime/core/log/Log.h>
+
+namespace Horizon {
+
+	PipelineStatistics::PipelineStatistics(std::shared_ptr<Device> device, u32 command_buffer_count, u32 scope_count) noexcept : m_device(device), m_scope_count(scope_count)
+	{
+		m_reset.resize(command_buffer_count, false);
+		m_resolved.resize(scope_count, false);
+		m_fragment_invocations.resize(scope_count, 0);
+
+		if (!m_device->GetEnabledFeatures().pipelineStatisticsQuery) {
+			LOG_WARN("pipeline statistics queries are not supported, fragment invocations read zero");
+			return;
+		}
+
+		VkQueryPoolCreateInfo query_pool_create_info{};
+		query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		query_pool_create_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		query_pool_create_info.queryCount = scope_count * command_buffer_count;
+		query_pool_create_info.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+		CHECK_VK_RESULT(vkCreateQueryPool(m_device->Get(), &query_pool_create_info, nullptr, &m_query_pool));
+	}
+
+	PipelineStatistics::~PipelineStatistics() noexcept
+	{
+		if (m_query_pool) {
+			vkDestroyQueryPool(m_device->Get(), m_query_pool, nullptr);
+		}
+	}
+
+	bool PipelineStatistics::IsSupported() const noexcept
+	{
+		return m_query_pool != VK_NULL_HANDLE;
+	}
+
+	void PipelineStatistics::Reset(u32 _i, std::shared_ptr<CommandBuffer> command_buffer) noexcept
+	{
+		if (!IsSupported()) {
+			return;
+		}
+		vkCmdResetQueryPool(command_buffer->Get(_i), m_query_pool, m_scope_count * _i, m_scope_count);
+		m_reset[_i] = true;
+	}
+
+	void PipelineStatistics::Begin(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept
+	{
+		if (!IsSupported()) {
+			return;
+		}
+		vkCmdBeginQuery(command_buffer->Get(_i), m_query_pool, m_scope_count * _i + scope, 0);
+	}
+
+	void PipelineStatistics::End(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept
+	{
+		if (!IsSupported()) {
+			return;
+		}
+		vkCmdEndQuery(command_buffer->Get(_i), m_query_pool, m_scope_count * _i + scope);
+	}
+
+	void PipelineStatistics::Resolve(u32 _i) noexcept
+	{
+		if (!IsSupported() || !m_reset[_i]) {
+			return;
+		}
+		for (u32 scope = 0; scope < m_scope_count; scope++) {
+			// value and availability
+			std::array<u64, 2> results{};
+			VkResult result = vkGetQueryPoolResults(m_device->Get(), m_query_pool, m_scope_count * _i + scope, 1, sizeof(results), results.data(), sizeof(results), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+			m_resolved[scope] = result == VK_SUCCESS && results[1] != 0;
+			if (m_resolved[scope]) {
+				m_fragment_invocations[scope] = results[0];
+			}
+		}
+	}
+
+	bool PipelineStatistics::IsResolved(u32 scope) const noexcept
+	{
+		return m_resolved[scope];
+	}
+
+	u64 PipelineStatistics::GetFragmentInvocations(u32 scope) const noexcept
+	{
+		return m_fragment_invocations[scope];
+	}
+
+}
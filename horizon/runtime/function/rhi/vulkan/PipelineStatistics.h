@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <runtime/function/rhi/RenderContext.h>
+#include "CommandBuffer.h"
+#include "Device.h"
+
+namespace Horizon {
+
+	// fragment shader invocations counted over scopes of each command buffer, laid out like GpuTimer.
+	// only one scope can be active at a time, begin and end it outside of render passes to span several
+	class PipelineStatistics
+	{
+	public:
+		PipelineStatistics(std::shared_ptr<Device> device, u32 command_buffer_count, u32 scope_count) noexcept;
+		~PipelineStatistics() noexcept;
+
+		// false without the pipelineStatisticsQuery feature, scopes then read zero
+		bool IsSupported() const noexcept;
+
+		// resets the queries of the command buffer, record before any scope and outside of render passes
+		void Reset(u32 _i, std::shared_ptr<CommandBuffer> command_buffer) noexcept;
+		void Begin(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept;
+		void End(u32 _i, std::shared_ptr<CommandBuffer> command_buffer, u32 scope) noexcept;
+
+		// read the scopes of a command buffer whose submission has finished
+		void Resolve(u32 _i) noexcept;
+		// false if the scope was not recorded in the last resolved command buffer
+		bool IsResolved(u32 scope) const noexcept;
+		u64 GetFragmentInvocations(u32 scope) const noexcept;
+	private:
+		std::shared_ptr<Device> m_device;
+		VkQueryPool m_query_pool = VK_NULL_HANDLE;
+		u32 m_scope_count;
+		std::vector<bool> m_reset;
+		std::vector<bool> m_resolved;
+		std::vector<u64> m_fragment_invocations;
+	};
+
+}
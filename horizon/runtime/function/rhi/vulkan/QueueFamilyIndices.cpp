@@ -59,6 +59,21 @@ namespace Horizon {
 				break;
 			}
 		}
+
+		// dedicated compute families are usually backed by separate hardware queues, so their work overlaps the graphics queue
+		for (u32 i = 0; i < queueFamilyCount; i++)
+		{
+			if (queueFamilies[i].queueCount > 0 && (queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				compute = i;
+				break;
+			}
+		}
+		// graphics families always support compute
+		if (!compute.has_value() && graphics.has_value())
+		{
+			compute = graphics;
+		}
 	}
 
 	bool QueueFamilyIndices::completed() const noexcept 
@@ -75,4 +90,14 @@ namespace Horizon {
 	{
 		return present.value();
 	}
+
+	u32 QueueFamilyIndices::getCompute() const noexcept
+	{
+		return compute.value();
+	}
+
+	bool QueueFamilyIndices::hasAsyncCompute() const noexcept
+	{
+		return compute.has_value() && graphics.has_value() && compute.value() != graphics.value();
+	}
 }
\ No newline at end of file
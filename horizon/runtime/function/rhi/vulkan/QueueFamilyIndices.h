@@ -25,9 +25,16 @@ namespace Horizon {
 
 		u32 getPresent()const noexcept;
 
+		// a family without graphics support when there is one, otherwise the graphics family
+		u32 getCompute()const noexcept;
+
+		// compute work can run on its own queue, next to the graphics queue
+		bool hasAsyncCompute()const noexcept;
+
 	private:
 		std::optional<u32> graphics;
 		std::optional<u32> present;
+		std::optional<u32> compute;
 	};
 
 }
\ No newline at end of file
@@ -1,14 +1,21 @@
 #include "RenderPass.h"
 
+#include <algorithm>
+
 #include <runtime/core/log/Log.h>
 
 namespace Horizon {
 
-	RenderPass::RenderPass(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info) :m_device(device)
+	RenderPass::RenderPass(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, bool load_attachments) :m_device(device)
+	{
+		CreateRenderPass(attachment_create_info, load_attachments);
+	}
+
+	RenderPass::RenderPass(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, const std::vector<SubpassCreateInfo>& subpass_create_info, const std::vector<u32>& read_after) :m_device(device)
 	{
-		CreateRenderPass(attachment_create_info);
+		CreateRenderPass(attachment_create_info, subpass_create_info, read_after);
 	}
-	void RenderPass::CreateRenderPass(const std::vector<AttachmentCreateInfo>& attachment_create_info)
+	void RenderPass::CreateRenderPass(const std::vector<AttachmentCreateInfo>& attachment_create_info, bool load_attachments)
 	{
 		u32 attachmentCount = attachment_create_info.size();
 		colorAttachmentCount = attachmentCount;
@@ -50,6 +57,14 @@ namespace Horizon {
 			attachmentsDesc[attachmentCount - 1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 		}
 
+		// attachments are left in their final layout by the clearing pass
+		if (load_attachments) {
+			for (auto& desc : attachmentsDesc) {
+				desc.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+				desc.initialLayout = desc.finalLayout;
+			}
+		}
+
 		
 		std::vector<VkAttachmentReference> attachmentReferences(attachmentCount);
 		for (u32 i = 0; i < attachmentReferences.size(); i++)
@@ -67,6 +82,7 @@ namespace Horizon {
 		subpass.colorAttachmentCount = m_has_depth_attachment ? attachmentCount - 1 : attachmentCount;
 		subpass.pColorAttachments = attachmentReferences.data();
 		subpass.pDepthStencilAttachment = m_has_depth_attachment ? &attachmentReferences[attachmentCount - 1] : nullptr;
+		m_subpass_color_attachment_counts = { subpass.colorAttachmentCount };
 
 		//
 		std::array<VkSubpassDependency, 2> dependencies;
@@ -98,6 +114,109 @@ namespace Horizon {
 		CHECK_VK_RESULT(vkCreateRenderPass(m_device->Get(), &renderPassInfo, nullptr, &m_render_pass));
 	}
 
+	void RenderPass::CreateRenderPass(const std::vector<AttachmentCreateInfo>& attachment_create_info, const std::vector<SubpassCreateInfo>& subpass_create_info, const std::vector<u32>& read_after)
+	{
+		u32 attachment_count = static_cast<u32>(attachment_create_info.size());
+		m_has_depth_attachment = attachment_create_info[attachment_count - 1].usage & AttachmentUsageFlags::DEPTH_STENCIL_ATTACHMENT;
+		colorAttachmentCount = m_has_depth_attachment ? attachment_count - 1 : attachment_count;
+
+		std::vector<VkAttachmentDescription> attachments_desc(attachment_count);
+		for (u32 i = 0; i < attachment_count; i++) {
+			const AttachmentCreateInfo& create_info = attachment_create_info[i];
+			bool depth = create_info.usage & AttachmentUsageFlags::DEPTH_STENCIL_ATTACHMENT;
+			bool stored = std::find(read_after.begin(), read_after.end(), i) != read_after.end();
+			bool read_by_subpass = std::any_of(subpass_create_info.begin(), subpass_create_info.end(), [i](const SubpassCreateInfo& subpass) {
+				return std::find(subpass.input_attachments.begin(), subpass.input_attachments.end(), i) != subpass.input_attachments.end();
+			});
+
+			attachments_desc[i].samples = VK_SAMPLE_COUNT_1_BIT;
+			attachments_desc[i].format = ToVkImageFormat(create_info.format);
+			attachments_desc[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			// color attachments only read by later subpasses are read where geometry was written, depth is always
+			// tested against the clear value
+			attachments_desc[i].loadOp = read_by_subpass && !stored && !depth ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_CLEAR;
+			attachments_desc[i].storeOp = stored ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachments_desc[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachments_desc[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			if (stored) {
+				attachments_desc[i].finalLayout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+			else {
+				attachments_desc[i].finalLayout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			}
+		}
+
+		// references must stay alive until the render pass is created
+		std::vector<std::vector<VkAttachmentReference>> color_references(subpass_create_info.size());
+		std::vector<std::vector<VkAttachmentReference>> input_references(subpass_create_info.size());
+		VkAttachmentReference depth_reference{ attachment_count - 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+		std::vector<VkSubpassDescription> subpasses(subpass_create_info.size());
+		m_subpass_color_attachment_counts.resize(subpass_create_info.size());
+		for (u32 i = 0; i < subpass_create_info.size(); i++) {
+			for (u32 attachment : subpass_create_info[i].color_attachments) {
+				color_references[i].push_back(VkAttachmentReference{ attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+			}
+			for (u32 attachment : subpass_create_info[i].input_attachments) {
+				bool depth = attachment_create_info[attachment].usage & AttachmentUsageFlags::DEPTH_STENCIL_ATTACHMENT;
+				input_references[i].push_back(VkAttachmentReference{ attachment, depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+			}
+			subpasses[i].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpasses[i].colorAttachmentCount = static_cast<u32>(color_references[i].size());
+			subpasses[i].pColorAttachments = color_references[i].data();
+			subpasses[i].inputAttachmentCount = static_cast<u32>(input_references[i].size());
+			subpasses[i].pInputAttachments = input_references[i].data();
+			subpasses[i].pDepthStencilAttachment = subpass_create_info[i].depth_attachment ? &depth_reference : nullptr;
+			m_subpass_color_attachment_counts[i] = subpasses[i].colorAttachmentCount;
+		}
+
+		std::vector<VkSubpassDependency> dependencies;
+		{
+			VkSubpassDependency dependency{};
+			dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+			dependency.dstSubpass = 0;
+			dependency.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+			dependency.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_MEMORY_READ_BIT;
+			dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+			dependencies.push_back(dependency);
+		}
+		// each subpass reads what the previous one wrote at the same pixel, by region keeps it in tile memory
+		for (u32 i = 1; i < subpasses.size(); i++) {
+			VkSubpassDependency dependency{};
+			dependency.srcSubpass = i - 1;
+			dependency.dstSubpass = i;
+			dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			dependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+			dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+			dependencies.push_back(dependency);
+		}
+		{
+			VkSubpassDependency dependency{};
+			dependency.srcSubpass = static_cast<u32>(subpasses.size() - 1);
+			dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+			dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			dependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			dependencies.push_back(dependency);
+		}
+
+		VkRenderPassCreateInfo render_pass_info{};
+		render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		render_pass_info.attachmentCount = attachment_count;
+		render_pass_info.pAttachments = attachments_desc.data();
+		render_pass_info.subpassCount = static_cast<u32>(subpasses.size());
+		render_pass_info.pSubpasses = subpasses.data();
+		render_pass_info.dependencyCount = static_cast<u32>(dependencies.size());
+		render_pass_info.pDependencies = dependencies.data();
+
+		CHECK_VK_RESULT(vkCreateRenderPass(m_device->Get(), &render_pass_info, nullptr, &m_render_pass));
+	}
+
 	RenderPass::~RenderPass()
 	{
 		vkDestroyRenderPass(m_device->Get(), m_render_pass, nullptr);
@@ -107,4 +226,9 @@ namespace Horizon {
 	{
 		return m_render_pass;
 	}
+
+	u32 RenderPass::GetColorAttachmentCount(u32 subpass) const noexcept
+	{
+		return m_subpass_color_attachment_counts[subpass];
+	}
 }
\ No newline at end of file
@@ -8,17 +8,34 @@
 
 namespace Horizon {
 
+	// attachments used by one subpass, as indices into the render pass attachments
+	struct SubpassCreateInfo {
+		std::vector<u32> color_attachments;
+		std::vector<u32> input_attachments;
+		// the depth attachment is always the last render pass attachment
+		bool depth_attachment = false;
+	};
+
 	class RenderPass
 	{
 	public:
-		RenderPass(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info);
+		// load_attachments keeps the content of a previous pass over the same attachments instead of clearing
+		RenderPass(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, bool load_attachments = false);
+		// subpasses run in order, each one may read the attachments written by earlier subpasses as input attachments.
+		// read_after lists the attachments passes after this render pass sample, only those are stored, the others
+		// live in tile memory and color attachments only read by later subpasses are not cleared either
+		RenderPass(std::shared_ptr<Device> device, const std::vector<AttachmentCreateInfo>& attachment_create_info, const std::vector<SubpassCreateInfo>& subpass_create_info, const std::vector<u32>& read_after);
 		~RenderPass();
 		VkRenderPass Get() const noexcept;
+		u32 GetColorAttachmentCount(u32 subpass) const noexcept;
 	private:
-		void CreateRenderPass(const std::vector<AttachmentCreateInfo>& attachment_create_info);
+		void CreateRenderPass(const std::vector<AttachmentCreateInfo>& attachment_create_info, bool load_attachments);
+		void CreateRenderPass(const std::vector<AttachmentCreateInfo>& attachment_create_info, const std::vector<SubpassCreateInfo>& subpass_create_info, const std::vector<u32>& read_after);
 	public:
 		bool m_has_depth_attachment = false;
+		// color attachments of the whole render pass, for clear values
 		u32 colorAttachmentCount = 0;
+		std::vector<u32> m_subpass_color_attachment_counts;
 	private:
 		std::shared_ptr<Device> m_device = nullptr;
 		VkRenderPass m_render_pass;
@@ -9,9 +9,16 @@ namespace Horizon {
 		VkPipelineStageFlags src_stage = ToVkPipelineStage(desc.src_stage);
 		VkPipelineStageFlags dst_stage = ToVkPipelineStage(desc.dst_stage);
 
+		std::vector<VkMemoryBarrier> memory_barriers(desc.memory_barriers.size());
 		std::vector<VkBufferMemoryBarrier> buffer_memory_barriers(desc.buffer_memory_barriers.size());
 		std::vector<VkImageMemoryBarrier> image_memory_barriers(desc.image_memory_barriers.size());
 
+		for (u32 i = 0; i < desc.memory_barriers.size(); i++) {
+			memory_barriers[i].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memory_barriers[i].srcAccessMask = ToVkMemoryAccessFlags(desc.memory_barriers[i].src_access_mask);
+			memory_barriers[i].dstAccessMask = ToVkMemoryAccessFlags(desc.memory_barriers[i].dst_access_mask);
+		}
+
 		for (u32 i = 0; i < desc.buffer_memory_barriers.size(); i++) {
 			buffer_memory_barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
 			buffer_memory_barriers[i].srcAccessMask = ToVkMemoryAccessFlags(desc.buffer_memory_barriers[i].src_access_mask);
@@ -19,6 +26,8 @@ namespace Horizon {
 			buffer_memory_barriers[i].buffer = static_cast<VkBuffer>(desc.buffer_memory_barriers[i].buffer);
 			buffer_memory_barriers[i].offset = desc.buffer_memory_barriers[i].offset;
 			buffer_memory_barriers[i].size = desc.buffer_memory_barriers[i].size;
+			buffer_memory_barriers[i].srcQueueFamilyIndex = desc.buffer_memory_barriers[i].src_queue_family_index;
+			buffer_memory_barriers[i].dstQueueFamilyIndex = desc.buffer_memory_barriers[i].dst_queue_family_index;
 		}
 
 		for (u32 i = 0; i < desc.image_memory_barriers.size(); i++) {
@@ -29,10 +38,12 @@ namespace Horizon {
 			image_memory_barriers[i].newLayout = ToVkImageLayout(desc.image_memory_barriers[i].dst_usage);
 			image_memory_barriers[i].image = desc.image_memory_barriers[i].texture->GetImage();
 			image_memory_barriers[i].subresourceRange = desc.image_memory_barriers[i].texture->GetSubresourceRange();
+			image_memory_barriers[i].srcQueueFamilyIndex = desc.image_memory_barriers[i].src_queue_family_index;
+			image_memory_barriers[i].dstQueueFamilyIndex = desc.image_memory_barriers[i].dst_queue_family_index;
 
 		}
 
-		vkCmdPipelineBarrier(command_buffer->Get(i), src_stage, dst_stage, 0, 0, nullptr, desc.buffer_memory_barriers.size(), buffer_memory_barriers.data(), desc.image_memory_barriers.size(), image_memory_barriers.data());
+		vkCmdPipelineBarrier(command_buffer->Get(i), src_stage, dst_stage, 0, desc.memory_barriers.size(), memory_barriers.data(), desc.buffer_memory_barriers.size(), buffer_memory_barriers.data(), desc.image_memory_barriers.size(), image_memory_barriers.data());
 	}
 
 }
\ No newline at end of file
@@ -8,6 +8,11 @@
 
 namespace Horizon{
 
+	// covers all resources, e.g. framebuffer attachments that are not textures
+	struct MemoryBarrierDesc {
+		MemoryAccessFlags src_access_mask, dst_access_mask;
+	};
+
 	struct BufferMemoryBarrierDesc {
 		MemoryAccessFlags src_access_mask, dst_access_mask;
 		void* buffer;
@@ -25,6 +30,7 @@ namespace Horizon{
 
 	struct BarrierDesc {
 		u32 src_stage, dst_stage;
+		std::vector<MemoryBarrierDesc> memory_barriers;
 		std::vector<BufferMemoryBarrierDesc> buffer_memory_barriers;
 		std::vector<ImageMemoryBarrierDesc> image_memory_barriers;
 	};
@@ -1,6 +1,7 @@
 #include "ShaderModule.h"
 
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 
 #include <runtime/core/log/Log.h>
@@ -12,6 +13,7 @@ namespace Horizon {
 		std::vector<char> code = readFile(path);
 		if (code.empty()) {
 			LOG_ERROR("shader code in {} is empty", path);
+			throw std::runtime_error("empty shader file: " + path);
 		}
 		VkShaderModuleCreateInfo shaderModuleCreateInfo{};
 		shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -37,6 +39,7 @@ namespace Horizon {
 		std::ifstream file(path, std::ios::ate | std::ios::binary);
 		if (!file.is_open()) {
 			LOG_ERROR("failed to open shader file: {}", path);
+			throw std::runtime_error("failed to open shader file: " + path);
 		}
 		size_t fileSize = (size_t)file.tellg();
 		std::vector<char> buffer(fileSize);
@@ -0,0 +1,72 @@
+#include "StorageBuffer.h"
+
+#include <algorithm>
+
+#include <runtime/core/log/Log.h>
+
+namespace Horizon {
+
+	StorageBuffer::StorageBuffer(std::shared_ptr<Device> device, u64 buffer_size, VkBufferUsageFlags usage, bool host_visible) : m_device(device), m_usage(usage), m_host_visible(host_visible)
+	{
+		create(buffer_size);
+	}
+
+	StorageBuffer::~StorageBuffer()
+	{
+		destroy();
+	}
+
+	void StorageBuffer::update(const void* data, u64 data_size, u64 offset)
+	{
+		if (!m_host_visible) {
+			LOG_ERROR("storage buffer is not host visible");
+			return;
+		}
+		if (offset + data_size > m_size) {
+			LOG_ERROR("storage buffer update out of range, size: {}, offset: {}, data size: {}", m_size, offset, data_size);
+			return;
+		}
+		void* mapped;
+		vkMapMemory(m_device->Get(), m_storage_buffer_memory, offset, data_size, 0, &mapped);
+		memcpy(mapped, data, data_size);
+		vkUnmapMemory(m_device->Get(), m_storage_buffer_memory);
+	}
+
+	void StorageBuffer::reserve(u64 buffer_size)
+	{
+		if (buffer_size <= m_size) {
+			return;
+		}
+		destroy();
+		create(buffer_size);
+	}
+
+	VkBuffer StorageBuffer::Get() const noexcept
+	{
+		return m_storage_buffer;
+	}
+
+	u64 StorageBuffer::size() const noexcept
+	{
+		return m_size;
+	}
+
+	void StorageBuffer::create(u64 buffer_size)
+	{
+		// zero sized buffers are invalid, keep a minimum so descriptors can always be written
+		m_size = (std::max)(buffer_size, static_cast<u64>(16));
+		VkMemoryPropertyFlags properties = m_host_visible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), m_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | m_usage, properties, m_storage_buffer, m_storage_buffer_memory);
+		bufferDescriptrInfo.buffer = m_storage_buffer;
+		bufferDescriptrInfo.offset = 0;
+		bufferDescriptrInfo.range = m_size;
+	}
+
+	void StorageBuffer::destroy()
+	{
+		vkDestroyBuffer(m_device->Get(), m_storage_buffer, nullptr);
+		vkFreeMemory(m_device->Get(), m_storage_buffer_memory, nullptr);
+		m_storage_buffer = VK_NULL_HANDLE;
+		m_storage_buffer_memory = VK_NULL_HANDLE;
+	}
+}
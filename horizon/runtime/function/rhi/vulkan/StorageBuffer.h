@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <runtime/function/rhi/RenderContext.h>
+#include "Device.h"
+#include "VulkanBuffer.h"
+
+namespace Horizon {
+
+	// shader storage buffer, host visible buffers are written from the cpu with update(),
+	// device local ones are only written by the gpu (e.g. indirect draw commands)
+	class StorageBuffer : public DescriptorBase
+	{
+	public:
+		StorageBuffer(std::shared_ptr<Device> device, u64 buffer_size, VkBufferUsageFlags usage = 0, bool host_visible = true);
+		~StorageBuffer();
+		void update(const void* data, u64 data_size, u64 offset = 0);
+		// recreate the buffer if it is smaller than buffer_size, previous content is lost
+		void reserve(u64 buffer_size);
+		VkBuffer Get()const noexcept;
+		u64 size()const noexcept;
+	private:
+		void create(u64 buffer_size);
+		void destroy();
+	private:
+		std::shared_ptr<Device> m_device = nullptr;
+		VkBuffer m_storage_buffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_storage_buffer_memory = VK_NULL_HANDLE;
+		VkBufferUsageFlags m_usage;
+		bool m_host_visible;
+		u64 m_size = 0;
+	};
+
+}
@@ -140,14 +140,24 @@ namespace Horizon {
 		image_create_info.extent.width = create_info.width;
 		image_create_info.extent.height = create_info.height;
 		image_create_info.extent.depth = create_info.depth;
-		image_create_info.mipLevels = 1;
+		mipLevels = create_info.mip_levels;
+		image_create_info.mipLevels = mipLevels;
 		image_create_info.arrayLayers = 1;
 		image_create_info.format = ToVkImageFormat(create_info.texture_format);
 		image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
 		image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		image_create_info.usage = ToVkImageUsage(create_info.texture_usage);
 		image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		QueueFamilyIndices queue_family_indices = m_device->getQueueFamilyIndices();
+		u32 queue_families[] = { queue_family_indices.getGraphics(), queue_family_indices.getCompute() };
+		if (create_info.async_compute && queue_family_indices.hasAsyncCompute()) {
+			image_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			image_create_info.queueFamilyIndexCount = 2;
+			image_create_info.pQueueFamilyIndices = queue_families;
+		}
 		image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		m_extent = image_create_info.extent;
+		m_texel_size = GetTextureFormatSize(create_info.texture_format);
 
 		CHECK_VK_RESULT(vkCreateImage(m_device->Get(), &image_create_info, nullptr, &m_image));
 
@@ -190,6 +200,21 @@ namespace Horizon {
 		createImageView(image_create_info.format, type);
 		createSampler();
 
+		if (mipLevels > 1) {
+			m_mip_image_views.resize(mipLevels);
+			for (u32 mip = 0; mip < mipLevels; mip++) {
+				VkImageViewCreateInfo view_info{};
+				view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				view_info.image = m_image;
+				view_info.viewType = type;
+				view_info.format = image_create_info.format;
+				view_info.subresourceRange = subresource_range;
+				view_info.subresourceRange.baseMipLevel = mip;
+				view_info.subresourceRange.levelCount = 1;
+				CHECK_VK_RESULT(vkCreateImageView(m_device->Get(), &view_info, nullptr, &m_mip_image_views[mip]));
+			}
+		}
+
 		// fill descriptor info
 		switch (create_info.texture_usage) {
 		case TextureUsage::TEXTURE_USAGE_R:
@@ -208,6 +233,9 @@ namespace Horizon {
 
 	Texture::~Texture()
 	{
+		for (auto& view : m_mip_image_views) {
+			vkDestroyImageView(m_device->Get(), view, nullptr);
+		}
 		vkDestroyImage(m_device->Get(), m_image, nullptr);
 		vkDestroyImageView(m_device->Get(), m_image_view, nullptr);
 		vkDestroySampler(m_device->Get(), m_sampler, nullptr);
@@ -295,7 +323,7 @@ namespace Horizon {
 		barrier.image = m_image;
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.levelCount = mipLevels;
 		barrier.subresourceRange.baseArrayLayer = 0;
 		barrier.subresourceRange.layerCount = 1;
 
@@ -370,7 +398,7 @@ namespace Horizon {
 		viewInfo.format = format;
 		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		viewInfo.subresourceRange.baseMipLevel = 0;
-		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.levelCount = mipLevels;
 		viewInfo.subresourceRange.baseArrayLayer = 0;
 		viewInfo.subresourceRange.layerCount = 1;
 		subresource_range = viewInfo.subresourceRange;
@@ -393,10 +421,105 @@ namespace Horizon {
 		samplerInfo.compareEnable = VK_FALSE;
 		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
 		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.maxLod = static_cast<f32>(mipLevels);
 
 		vkCreateSampler(m_device->Get(), &samplerInfo, nullptr, &m_sampler);
 	}
 
+	std::shared_ptr<DescriptorBase> Texture::GetMipDescriptor(u32 mip) const noexcept
+	{
+		std::shared_ptr<DescriptorBase> descriptor = std::make_shared<DescriptorBase>();
+		descriptor->imageDescriptorInfo = imageDescriptorInfo;
+		if (mip < m_mip_image_views.size()) {
+			descriptor->imageDescriptorInfo.imageView = m_mip_image_views[mip];
+		}
+		else if (mip != 0) {
+			LOG_ERROR("texture mip level {} out of range, mip levels: {}", mip, mipLevels);
+		}
+		return descriptor;
+	}
+
+	u64 Texture::GetDataSize() const noexcept
+	{
+		return static_cast<u64>(m_extent.width) * m_extent.height * m_extent.depth * m_texel_size;
+	}
+
+	// copies between the image in the general layout and a host visible buffer, waiting for all shader work
+	// before and making the result visible to the shaders after
+	static void CopyGeneralImage(std::shared_ptr<CommandBuffer> command_buffer, VkImage image, VkExtent3D extent, VkBuffer buffer, bool to_buffer)
+	{
+		VkCommandBuffer cmdbuf = command_buffer->beginSingleTimeCommands();
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = to_buffer ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(cmdbuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = extent;
+		if (to_buffer) {
+			vkCmdCopyImageToBuffer(cmdbuf, image, VK_IMAGE_LAYOUT_GENERAL, buffer, 1, &region);
+		}
+		else {
+			vkCmdCopyBufferToImage(cmdbuf, buffer, image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+		}
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(cmdbuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		command_buffer->endSingleTimeCommands(cmdbuf);
+	}
+
+	void Texture::ReadBack(std::vector<u8>& data)
+	{
+		VkDeviceSize buffer_size = GetDataSize();
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+		CopyGeneralImage(m_command_buffer, m_image, m_extent, stagingBuffer, true);
+
+		data.resize(buffer_size);
+		void* mapped;
+		vkMapMemory(m_device->Get(), stagingBufferMemory, 0, buffer_size, 0, &mapped);
+		memcpy(data.data(), mapped, static_cast<size_t>(buffer_size));
+		vkUnmapMemory(m_device->Get(), stagingBufferMemory);
+
+		vkDestroyBuffer(m_device->Get(), stagingBuffer, nullptr);
+		vkFreeMemory(m_device->Get(), stagingBufferMemory, nullptr);
+	}
+
+	void Texture::Upload(const std::vector<u8>& data)
+	{
+		VkDeviceSize buffer_size = GetDataSize();
+		if (data.size() != buffer_size) {
+			LOG_ERROR("texture upload of " + std::to_string(data.size()) + " bytes, expected " + std::to_string(buffer_size));
+			return;
+		}
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+		void* mapped;
+		vkMapMemory(m_device->Get(), stagingBufferMemory, 0, buffer_size, 0, &mapped);
+		memcpy(mapped, data.data(), static_cast<size_t>(buffer_size));
+		vkUnmapMemory(m_device->Get(), stagingBufferMemory);
+
+		CopyGeneralImage(m_command_buffer, m_image, m_extent, stagingBuffer, false);
+
+		vkDestroyBuffer(m_device->Get(), stagingBuffer, nullptr);
+		vkFreeMemory(m_device->Get(), stagingBufferMemory, nullptr);
+	}
+
 	void Texture::destroy()
 	{
 		vkDestroyImageView(m_device->Get(), m_image_view, nullptr);
@@ -14,6 +14,9 @@ namespace Horizon {
 		TextureFormat texture_format;
 		TextureUsage texture_usage;
 		u32 width, height, depth = 1;
+		u32 mip_levels = 1;
+		// also accessed on the async compute queue, shared between the queue families instead of transferring ownership
+		bool async_compute = false;
 	};
 
 	class Texture : public DescriptorBase
@@ -31,15 +34,26 @@ namespace Horizon {
 		void destroy();
 		inline VkImage GetImage() const noexcept { return m_image; }
 		inline VkImageSubresourceRange GetSubresourceRange() const noexcept { return subresource_range; }
+		inline u32 GetMipLevels() const noexcept { return mipLevels; }
+		inline VkExtent3D GetExtent() const noexcept { return m_extent; }
+		// descriptor of a single mip level, for writing a mip chain from compute shaders
+		std::shared_ptr<DescriptorBase> GetMipDescriptor(u32 mip) const noexcept;
+		// contents of mip 0, tightly packed. only for storage textures, which stay in the general layout
+		u64 GetDataSize() const noexcept;
+		void ReadBack(std::vector<u8>& data);
+		void Upload(const std::vector<u8>& data);
 	private:
 		std::shared_ptr<Device> m_device = nullptr;
 		std::shared_ptr<CommandBuffer> m_command_buffer = nullptr;
 		u8* buffer = nullptr;
 		i32 texWidth, texHeight, texChannels;
-		u32 mipLevels;
+		u32 mipLevels = 1;
+		VkExtent3D m_extent{};
+		u32 m_texel_size = 0;
 		VkImage m_image;
 		VkDeviceMemory m_image_memory;
 		VkImageView m_image_view;
+		std::vector<VkImageView> m_mip_image_views;
 		VkSampler m_sampler;
 		VkImageSubresourceRange subresource_range;
 		VkDescriptorImageInfo mDescriptorImageInfo;
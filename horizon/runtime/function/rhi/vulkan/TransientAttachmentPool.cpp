@@ -0,0 +1,186 @@
+#include "TransientAttachmentPool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include <runtime/core/log/Log.h>
+#include <runtime/function/rhi/vulkan/VulkanEnums.h>
+
+namespace Horizon {
+
+	TransientAttachmentPool::TransientAttachmentPool(std::shared_ptr<Device> device) noexcept : m_device(device)
+	{
+	}
+
+	TransientAttachmentPool::~TransientAttachmentPool() noexcept
+	{
+		for (auto& heap : m_heaps) {
+			vkFreeMemory(m_device->Get(), heap.memory, nullptr);
+		}
+	}
+
+	void TransientAttachmentPool::Register(Framebuffer* framebuffer) noexcept
+	{
+		if (m_allocated) {
+			LOG_ERROR("framebuffers must be registered before the pool is allocated");
+			return;
+		}
+		m_framebuffers.push_back(framebuffer);
+		m_lifetimes.emplace_back(framebuffer->m_frame_buffer_attachments.size());
+	}
+
+	void TransientAttachmentPool::Unregister(Framebuffer* framebuffer) noexcept
+	{
+		auto it = std::find(m_framebuffers.begin(), m_framebuffers.end(), framebuffer);
+		if (it != m_framebuffers.end()) {
+			m_lifetimes.erase(m_lifetimes.begin() + (it - m_framebuffers.begin()));
+			m_framebuffers.erase(it);
+		}
+		m_placements.erase(std::remove_if(m_placements.begin(), m_placements.end(), [framebuffer](const Placement& placement) { return placement.framebuffer == framebuffer; }), m_placements.end());
+	}
+
+	void TransientAttachmentPool::SetLifetime(const Framebuffer* framebuffer, const std::vector<u32>& attachments, u32 first, u32 last) noexcept
+	{
+		auto it = std::find(m_framebuffers.begin(), m_framebuffers.end(), framebuffer);
+		if (it == m_framebuffers.end()) {
+			return;
+		}
+		std::vector<Lifetime>& lifetimes = m_lifetimes[it - m_framebuffers.begin()];
+		for (u32 a = 0; a < lifetimes.size(); a++) {
+			if (!attachments.empty() && std::find(attachments.begin(), attachments.end(), a) == attachments.end()) {
+				continue;
+			}
+			Lifetime& lifetime = lifetimes[a];
+			lifetime.first = lifetime.assigned ? std::min(lifetime.first, first) : first;
+			lifetime.last = lifetime.assigned ? std::max(lifetime.last, last) : last;
+			lifetime.assigned = true;
+		}
+	}
+
+	void TransientAttachmentPool::Allocate() noexcept
+	{
+		if (m_allocated) {
+			return;
+		}
+		m_allocated = true;
+
+		for (u32 f = 0; f < m_framebuffers.size(); f++) {
+			auto& attachments = m_framebuffers[f]->m_frame_buffer_attachments;
+			for (u32 a = 0; a < attachments.size(); a++) {
+				if (!attachments[a].m_aliased) {
+					continue;
+				}
+				Placement placement{};
+				placement.framebuffer = m_framebuffers[f];
+				placement.attachment = a;
+				vkGetImageMemoryRequirements(m_device->Get(), attachments[a].m_image, &placement.requirements);
+				placement.memory_type = FindMemoryType(m_device->getPhysicalDevice(), placement.requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+				placement.lifetime = m_lifetimes[f][a];
+				m_placements.push_back(placement);
+			}
+		}
+
+		// largest first, each attachment goes to the lowest offset that does not overlap an attachment alive at the same time
+		std::vector<u32> order(m_placements.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [this](u32 a, u32 b) { return m_placements[a].requirements.size > m_placements[b].requirements.size; });
+
+		std::vector<u32> placed;
+		for (u32 p : order) {
+			Placement& placement = m_placements[p];
+
+			auto heap = std::find_if(m_heaps.begin(), m_heaps.end(), [&placement](const Heap& heap) { return heap.memory_type == placement.memory_type; });
+			if (heap == m_heaps.end()) {
+				m_heaps.push_back(Heap{ placement.memory_type });
+				heap = m_heaps.end() - 1;
+			}
+			placement.heap = static_cast<u32>(heap - m_heaps.begin());
+
+			std::vector<const Placement*> conflicts;
+			for (u32 other : placed) {
+				const Placement& o = m_placements[other];
+				bool alive_together = o.lifetime.first <= placement.lifetime.last && placement.lifetime.first <= o.lifetime.last;
+				if (o.heap == placement.heap && alive_together) {
+					conflicts.push_back(&o);
+				}
+			}
+
+			VkDeviceSize alignment = placement.requirements.alignment;
+			std::vector<VkDeviceSize> candidates{ 0 };
+			for (const Placement* conflict : conflicts) {
+				candidates.push_back((conflict->offset + conflict->requirements.size + alignment - 1) / alignment * alignment);
+			}
+			std::sort(candidates.begin(), candidates.end());
+			for (VkDeviceSize offset : candidates) {
+				bool fits = std::none_of(conflicts.begin(), conflicts.end(), [&](const Placement* conflict) {
+					return offset < conflict->offset + conflict->requirements.size && conflict->offset < offset + placement.requirements.size;
+				});
+				if (fits) {
+					placement.offset = offset;
+					break;
+				}
+			}
+			heap->size = std::max(heap->size, placement.offset + placement.requirements.size);
+			placed.push_back(p);
+		}
+
+		for (auto& heap : m_heaps) {
+			VkMemoryAllocateInfo allocate_info{};
+			allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocate_info.allocationSize = heap.size;
+			allocate_info.memoryTypeIndex = heap.memory_type;
+			CHECK_VK_RESULT(vkAllocateMemory(m_device->Get(), &allocate_info, nullptr, &heap.memory));
+		}
+
+		for (const auto& placement : m_placements) {
+			placement.framebuffer->m_frame_buffer_attachments[placement.attachment].BindMemory(m_device, m_heaps[placement.heap].memory, placement.offset);
+		}
+		for (auto framebuffer : m_framebuffers) {
+			framebuffer->createFrameBuffer(framebuffer->m_render_context.width, framebuffer->m_render_context.height, 1);
+		}
+
+		LOG_INFO("transient attachments: " + std::to_string(GetPeakMemory() >> 20) + " MB aliased, " + std::to_string(GetNaiveMemory() >> 20) + " MB with dedicated allocations");
+	}
+
+	bool TransientAttachmentPool::IsAllocated() const noexcept
+	{
+		return m_allocated;
+	}
+
+	bool TransientAttachmentPool::Aliases(const Framebuffer* a, const std::vector<u32>& attachments_a, const Framebuffer* b, const std::vector<u32>& attachments_b) const noexcept
+	{
+		auto selected = [](const Placement& placement, const Framebuffer* framebuffer, const std::vector<u32>& attachments) {
+			return placement.framebuffer == framebuffer && (attachments.empty() || std::find(attachments.begin(), attachments.end(), placement.attachment) != attachments.end());
+		};
+		for (const auto& pa : m_placements) {
+			if (!selected(pa, a, attachments_a)) {
+				continue;
+			}
+			for (const auto& pb : m_placements) {
+				if (&pa != &pb && selected(pb, b, attachments_b) && pa.heap == pb.heap && pa.offset < pb.offset + pb.requirements.size && pb.offset < pa.offset + pa.requirements.size) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	u64 TransientAttachmentPool::GetPeakMemory() const noexcept
+	{
+		u64 size = 0;
+		for (const auto& heap : m_heaps) {
+			size += heap.size;
+		}
+		return size;
+	}
+
+	u64 TransientAttachmentPool::GetNaiveMemory() const noexcept
+	{
+		u64 size = 0;
+		for (const auto& placement : m_placements) {
+			size += placement.requirements.size;
+		}
+		return size;
+	}
+}
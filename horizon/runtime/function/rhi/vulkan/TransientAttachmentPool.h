@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <runtime/function/rhi/RenderContext.h>
+#include "Device.h"
+#include "Framebuffer.h"
+
+namespace Horizon {
+
+	// places ALIASED_ATTACHMENT attachments in shared device memory when their
+	// lifetimes within a frame do not overlap. framebuffers register themselves before Allocate, which binds
+	// the memory, creates the image views and finishes the framebuffers.
+	// the render graph supplies the lifetimes and inserts the barriers between attachments sharing memory
+	class TransientAttachmentPool
+	{
+	public:
+		TransientAttachmentPool(std::shared_ptr<Device> device) noexcept;
+		~TransientAttachmentPool() noexcept;
+
+		void Register(Framebuffer* framebuffer) noexcept;
+		void Unregister(Framebuffer* framebuffer) noexcept;
+
+		// first and last render graph level attachments of the framebuffer are used in, all of them if attachments is
+		// empty. repeated calls widen the lifetime, attachments without a lifetime are never aliased
+		void SetLifetime(const Framebuffer* framebuffer, const std::vector<u32>& attachments, u32 first, u32 last) noexcept;
+		void Allocate() noexcept;
+		bool IsAllocated() const noexcept;
+
+		// true if one of the attachments of a shares memory with one of the attachments of b, empty lists are all attachments
+		bool Aliases(const Framebuffer* a, const std::vector<u32>& attachments_a, const Framebuffer* b, const std::vector<u32>& attachments_b) const noexcept;
+
+		// memory of all heaps, and what the attachments would take with dedicated allocations
+		u64 GetPeakMemory() const noexcept;
+		u64 GetNaiveMemory() const noexcept;
+	private:
+		struct Lifetime {
+			u32 first = 0;
+			u32 last = ~0u;
+			bool assigned = false;
+		};
+
+		struct Placement {
+			Framebuffer* framebuffer;
+			u32 attachment;
+			VkMemoryRequirements requirements;
+			u32 memory_type;
+			u32 heap;
+			VkDeviceSize offset;
+			Lifetime lifetime;
+		};
+
+		struct Heap {
+			u32 memory_type;
+			VkDeviceSize size = 0;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+		};
+
+		std::shared_ptr<Device> m_device;
+		std::vector<Framebuffer*> m_framebuffers;
+		// per framebuffer and attachment
+		std::vector<std::vector<Lifetime>> m_lifetimes;
+		std::vector<Placement> m_placements;
+		std::vector<Heap> m_heaps;
+		bool m_allocated = false;
+	};
+}
@@ -15,7 +15,13 @@ namespace Horizon {
 	void UniformBuffer::update(void* Ub, u64 buffer_size)
 	{
 		if (!m_uniform_buffer) {
-			vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_uniform_buffer, m_uniform_buffer_memory);
+			// only written by the host, sharing it with the async compute queue costs nothing
+			QueueFamilyIndices queue_family_indices = m_device->getQueueFamilyIndices();
+			std::vector<u32> queue_families;
+			if (queue_family_indices.hasAsyncCompute()) {
+				queue_families = { queue_family_indices.getGraphics(), queue_family_indices.getCompute() };
+			}
+			vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_uniform_buffer, m_uniform_buffer_memory, queue_families);
 			m_size = buffer_size;
 			bufferDescriptrInfo.buffer = m_uniform_buffer;
 			bufferDescriptrInfo.offset = 0;
@@ -29,6 +29,20 @@ namespace Horizon {
 
 			return attributeDescriptions;
 		}
+
+		// position stream of depth only passes, see Model::BindPositionBuffers
+		static VkVertexInputBindingDescription getPositionBindingDescription() {
+			VkVertexInputBindingDescription bindingDescription{ 0, sizeof(Math::vec3), VK_VERTEX_INPUT_RATE_VERTEX };
+			return bindingDescription;
+		}
+
+		static std::vector<VkVertexInputAttributeDescription> getPositionAttributeDescriptions() {
+			std::vector<VkVertexInputAttributeDescription> attributeDescriptions{
+			{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+			};
+
+			return attributeDescriptions;
+		}
 	};
 
 }
\ No newline at end of file
@@ -5,23 +5,32 @@ namespace Horizon {
 	VertexBuffer::VertexBuffer(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer, const std::vector<Vertex>& vertices) :m_device(device)
 	{
 		m_vertices_count = vertices.size();
-		VkDeviceSize buffer_size = sizeof(vertices[0]) * m_vertices_count;
+		Upload(command_buffer, vertices.data(), sizeof(vertices[0]) * m_vertices_count);
+	}
 
+	VertexBuffer::VertexBuffer(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer, const std::vector<Math::vec3>& positions) :m_device(device)
+	{
+		m_vertices_count = positions.size();
+		Upload(command_buffer, positions.data(), sizeof(positions[0]) * m_vertices_count);
+	}
+
+	void VertexBuffer::Upload(std::shared_ptr<CommandBuffer> command_buffer, const void* vertices, VkDeviceSize buffer_size)
+	{
 		// create stage buffer
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
-		vk_createBuffer(device->Get(), device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
 		// upload cpu data
 		void* data;
 		vkMapMemory(m_device->Get(), stagingBufferMemory, 0, buffer_size, 0, &data);
-		memcpy(data, vertices.data(), buffer_size);
+		memcpy(data, vertices, buffer_size);
 		vkUnmapMemory(m_device->Get(), stagingBufferMemory);
 
 		// create actual vertex buffer
-		vk_createBuffer(device->Get(), device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertex_buffer, m_vertex_buffer_memory);
+		vk_createBuffer(m_device->Get(), m_device->getPhysicalDevice(), buffer_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertex_buffer, m_vertex_buffer_memory);
 
-		vk_copyBuffer(device, command_buffer, stagingBuffer, m_vertex_buffer, buffer_size);
+		vk_copyBuffer(m_device, command_buffer, stagingBuffer, m_vertex_buffer, buffer_size);
 
 		VkCommandBuffer cmdbuf = command_buffer->beginSingleTimeCommands();
 		VkBufferMemoryBarrier bufferMemoryBarrier{};
@@ -34,8 +43,8 @@ namespace Horizon {
 		vkCmdPipelineBarrier(cmdbuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &bufferMemoryBarrier, 0, nullptr);
 		command_buffer->endSingleTimeCommands(cmdbuf);
 
-		vkDestroyBuffer(device->Get(), stagingBuffer, nullptr);
-		vkFreeMemory(device->Get(), stagingBufferMemory, nullptr);
+		vkDestroyBuffer(m_device->Get(), stagingBuffer, nullptr);
+		vkFreeMemory(m_device->Get(), stagingBufferMemory, nullptr);
 	}
 
 	//VertexBuffer::VertexBuffer(const VertexBuffer&& rhs)
@@ -12,11 +12,15 @@ namespace Horizon {
 	public:
 		VertexBuffer() = default;
 		VertexBuffer(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer, const std::vector<Vertex>& vertices);
+		// position only stream
+		VertexBuffer(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer, const std::vector<Math::vec3>& positions);
 		//VertexBuffer(const VertexBuffer&& rhs);
 		//VertexBuffer& operator=(VertexBuffer&& rhs);
 		~VertexBuffer();
 		VkBuffer Get()const noexcept;
 		u64 getVerticesCount()const noexcept;
+	private:
+		void Upload(std::shared_ptr<CommandBuffer> command_buffer, const void* vertices, VkDeviceSize buffer_size);
 	private:
 		std::shared_ptr<Device> m_device = nullptr;
 		VkBuffer m_vertex_buffer;
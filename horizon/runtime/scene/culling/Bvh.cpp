@@ -0,0 +1,498 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Horizon {
+
+	namespace {
+
+		f32 SurfaceArea(const BoundingBox& box) noexcept
+		{
+			Math::vec3 d = box.max - box.min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		BoundingBox Union(const BoundingBox& a, const BoundingBox& b) noexcept
+		{
+			BoundingBox ret = a;
+			ret.Merge(b);
+			return ret;
+		}
+
+		bool Overlaps(const BoundingBox& a, const BoundingBox& b) noexcept
+		{
+			return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+				a.min.y <= b.max.y && a.max.y >= b.min.y &&
+				a.min.z <= b.max.z && a.max.z >= b.min.z;
+		}
+
+		// slab test, t_entry is clamped to 0 when the origin is inside the box
+		bool IntersectRayBox(const Ray& ray, const Math::vec3& inv_dir, const BoundingBox& box, f32 t_max, f32& t_entry) noexcept
+		{
+			Math::vec3 t0 = (box.min - ray.origin) * inv_dir;
+			Math::vec3 t1 = (box.max - ray.origin) * inv_dir;
+			Math::vec3 t_near = Math::min(t0, t1);
+			Math::vec3 t_far = Math::max(t0, t1);
+			f32 enter = (std::max)((std::max)(t_near.x, t_near.y), (std::max)(t_near.z, 0.0f));
+			f32 exit = (std::min)((std::min)(t_far.x, t_far.y), (std::min)(t_far.z, t_max));
+			t_entry = enter;
+			return enter <= exit;
+		}
+	}
+
+	void Bvh::Build(const std::vector<BoundingBox>& bounds) noexcept
+	{
+		Clear();
+		std::vector<std::pair<u32, BoundingBox>> leaves;
+		leaves.reserve(bounds.size());
+		for (u32 i = 0; i < bounds.size(); i++) {
+			leaves.emplace_back(i, bounds[i]);
+		}
+		m_item_to_leaf.assign(bounds.size(), k_invalid_index);
+		m_nodes.reserve(bounds.size() * 2);
+		if (!leaves.empty()) {
+			m_root = BuildRange(leaves, 0, static_cast<u32>(leaves.size()), k_invalid_index);
+		}
+		m_item_count = static_cast<u32>(leaves.size());
+		m_internal_area = InternalArea();
+		m_built_area = m_internal_area;
+	}
+
+	void Bvh::Clear() noexcept
+	{
+		m_nodes.clear();
+		m_free_nodes.clear();
+		m_item_to_leaf.clear();
+		m_dirty_leaves.clear();
+		m_root = k_invalid_index;
+		m_item_count = 0;
+		m_built_area = 0.0f;
+		m_internal_area = 0.0f;
+	}
+
+	u32 Bvh::BuildRange(std::vector<std::pair<u32, BoundingBox>>& leaves, u32 begin, u32 end, u32 parent) noexcept
+	{
+		u32 index = AllocateNode();
+		m_nodes[index].parent = parent;
+
+		if (end - begin == 1) {
+			m_nodes[index].box = leaves[begin].second;
+			m_nodes[index].item = leaves[begin].first;
+			m_item_to_leaf[leaves[begin].first] = index;
+			return index;
+		}
+
+		// median split along the longest axis of the centroid bounds
+		BoundingBox centroid_bounds;
+		for (u32 i = begin; i < end; i++) {
+			centroid_bounds.Merge(leaves[i].second.Center());
+		}
+		Math::vec3 size = centroid_bounds.max - centroid_bounds.min;
+		u32 axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+		u32 mid = begin + (end - begin) / 2;
+		std::nth_element(leaves.begin() + begin, leaves.begin() + mid, leaves.begin() + end, [axis](const auto& a, const auto& b) {
+			return a.second.Center()[axis] < b.second.Center()[axis];
+		});
+
+		// m_nodes may reallocate during recursion, do not hold references across calls
+		u32 left = BuildRange(leaves, begin, mid, index);
+		u32 right = BuildRange(leaves, mid, end, index);
+		m_nodes[index].left = left;
+		m_nodes[index].right = right;
+		m_nodes[index].box = Union(m_nodes[left].box, m_nodes[right].box);
+		return index;
+	}
+
+	void Bvh::Insert(u32 item, const BoundingBox& box) noexcept
+	{
+		if (item >= m_item_to_leaf.size()) {
+			m_item_to_leaf.resize(item + 1, k_invalid_index);
+		}
+		if (m_item_to_leaf[item] != k_invalid_index) {
+			Update(item, box);
+			return;
+		}
+
+		u32 leaf = AllocateNode();
+		m_nodes[leaf].box = box;
+		m_nodes[leaf].item = item;
+		m_item_to_leaf[item] = leaf;
+		m_item_count++;
+
+		if (m_root == k_invalid_index) {
+			m_root = leaf;
+			return;
+		}
+
+		// descend towards the sibling with the lowest surface area cost
+		u32 index = m_root;
+		while (!m_nodes[index].IsLeaf()) {
+			const Node& node = m_nodes[index];
+			f32 area = SurfaceArea(node.box);
+			f32 combined_area = SurfaceArea(Union(node.box, box));
+			f32 cost = 2.0f * combined_area;
+			f32 inheritance_cost = 2.0f * (combined_area - area);
+
+			auto child_cost = [&](u32 child) {
+				const Node& c = m_nodes[child];
+				f32 merged = SurfaceArea(Union(c.box, box));
+				return (c.IsLeaf() ? merged : merged - SurfaceArea(c.box)) + inheritance_cost;
+			};
+			f32 cost_left = child_cost(node.left);
+			f32 cost_right = child_cost(node.right);
+
+			if (cost < cost_left && cost < cost_right) {
+				break;
+			}
+			index = cost_left < cost_right ? node.left : node.right;
+		}
+
+		u32 sibling = index;
+		u32 old_parent = m_nodes[sibling].parent;
+		u32 new_parent = AllocateNode();
+		m_nodes[new_parent].parent = old_parent;
+		m_nodes[new_parent].left = sibling;
+		m_nodes[new_parent].right = leaf;
+		m_nodes[new_parent].box = Union(m_nodes[sibling].box, box);
+		m_internal_area += SurfaceArea(m_nodes[new_parent].box);
+		m_nodes[sibling].parent = new_parent;
+		m_nodes[leaf].parent = new_parent;
+
+		if (old_parent == k_invalid_index) {
+			m_root = new_parent;
+		}
+		else if (m_nodes[old_parent].left == sibling) {
+			m_nodes[old_parent].left = new_parent;
+		}
+		else {
+			m_nodes[old_parent].right = new_parent;
+		}
+		RefitAncestors(new_parent);
+	}
+
+	void Bvh::Remove(u32 item) noexcept
+	{
+		if (!Contains(item)) {
+			return;
+		}
+		u32 leaf = m_item_to_leaf[item];
+		m_item_to_leaf[item] = k_invalid_index;
+		m_item_count--;
+
+		if (leaf == m_root) {
+			FreeNode(leaf);
+			m_root = k_invalid_index;
+			return;
+		}
+
+		u32 parent = m_nodes[leaf].parent;
+		u32 grand_parent = m_nodes[parent].parent;
+		u32 sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+		m_internal_area -= SurfaceArea(m_nodes[parent].box);
+
+		if (grand_parent == k_invalid_index) {
+			m_root = sibling;
+			m_nodes[sibling].parent = k_invalid_index;
+		}
+		else {
+			if (m_nodes[grand_parent].left == parent) {
+				m_nodes[grand_parent].left = sibling;
+			}
+			else {
+				m_nodes[grand_parent].right = sibling;
+			}
+			m_nodes[sibling].parent = grand_parent;
+			RefitAncestors(grand_parent);
+		}
+		FreeNode(parent);
+		FreeNode(leaf);
+	}
+
+	bool Bvh::Contains(u32 item) const noexcept
+	{
+		return item < m_item_to_leaf.size() && m_item_to_leaf[item] != k_invalid_index;
+	}
+
+	void Bvh::Update(u32 item, const BoundingBox& box) noexcept
+	{
+		if (!Contains(item)) {
+			Insert(item, box);
+			return;
+		}
+		u32 leaf = m_item_to_leaf[item];
+		m_nodes[leaf].box = box;
+		m_dirty_leaves.push_back(leaf);
+	}
+
+	bool Bvh::Refit() noexcept
+	{
+		if (m_dirty_leaves.empty()) {
+			return false;
+		}
+
+		// mark the paths to the root, then recompute marked nodes children first
+		for (u32 leaf : m_dirty_leaves) {
+			u32 index = m_nodes[leaf].parent;
+			while (index != k_invalid_index && !m_nodes[index].dirty) {
+				m_nodes[index].dirty = true;
+				index = m_nodes[index].parent;
+			}
+		}
+		m_dirty_leaves.clear();
+
+		if (m_root == k_invalid_index || !m_nodes[m_root].dirty) {
+			return false;
+		}
+
+		bool changed = false;
+		std::vector<std::pair<u32, bool>> stack;
+		stack.emplace_back(m_root, false);
+		while (!stack.empty()) {
+			auto [index, children_done] = stack.back();
+			stack.pop_back();
+			Node& node = m_nodes[index];
+			if (children_done) {
+				changed |= SetInternalBox(index, Union(m_nodes[node.left].box, m_nodes[node.right].box));
+				node.dirty = false;
+				continue;
+			}
+			stack.emplace_back(index, true);
+			if (m_nodes[node.left].dirty) {
+				stack.emplace_back(node.left, false);
+			}
+			if (m_nodes[node.right].dirty) {
+				stack.emplace_back(node.right, false);
+			}
+		}
+		return changed;
+	}
+
+	bool Bvh::RebuildIfDegraded(f32 ratio) noexcept
+	{
+		if (m_item_count < 2 || m_internal_area <= m_built_area * ratio) {
+			return false;
+		}
+
+		// removed items leave holes in the item range, rebuild only the live ones
+		std::vector<std::pair<u32, BoundingBox>> leaves;
+		leaves.reserve(m_item_count);
+		for (u32 item = 0; item < m_item_to_leaf.size(); item++) {
+			if (m_item_to_leaf[item] != k_invalid_index) {
+				leaves.emplace_back(item, m_nodes[m_item_to_leaf[item]].box);
+			}
+		}
+		u32 item_range = static_cast<u32>(m_item_to_leaf.size());
+		Clear();
+		m_item_to_leaf.assign(item_range, k_invalid_index);
+		m_root = BuildRange(leaves, 0, static_cast<u32>(leaves.size()), k_invalid_index);
+		m_item_count = static_cast<u32>(leaves.size());
+		// also drops the rounding the incremental updates accumulated
+		m_internal_area = InternalArea();
+		m_built_area = m_internal_area;
+		return true;
+	}
+
+	void Bvh::CullFrustum(const Frustum& frustum, std::vector<u32>& items) const noexcept
+	{
+		if (m_root == k_invalid_index) {
+			return;
+		}
+		std::vector<u32> stack{ m_root };
+		while (!stack.empty()) {
+			u32 index = stack.back();
+			stack.pop_back();
+			const Node& node = m_nodes[index];
+			FrustumTestResult result = frustum.Classify(node.box);
+			if (result == FrustumTestResult::OUTSIDE) {
+				continue;
+			}
+			if (result == FrustumTestResult::INSIDE) {
+				CollectItems(index, items);
+				continue;
+			}
+			if (node.IsLeaf()) {
+				items.push_back(node.item);
+			}
+			else {
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	bool Bvh::RayCast(const Ray& ray, RayHit& hit, const RayCastCallback& callback) const noexcept
+	{
+		if (m_root == k_invalid_index) {
+			return false;
+		}
+		// zero components become a huge signed slope instead of inf, so origins on a slab plane do not produce 0 * inf
+		Math::vec3 inv_dir;
+		for (u32 i = 0; i < 3; i++) {
+			inv_dir[i] = ray.direction[i] == 0.0f ? std::copysign(FLT_MAX, ray.direction[i]) : 1.0f / ray.direction[i];
+		}
+		f32 t_entry;
+		if (!IntersectRayBox(ray, inv_dir, m_nodes[m_root].box, hit.distance, t_entry)) {
+			return false;
+		}
+
+		bool found = false;
+		std::vector<std::pair<u32, f32>> stack{ { m_root, t_entry } };
+		while (!stack.empty()) {
+			auto [index, t_node] = stack.back();
+			stack.pop_back();
+			// a closer hit was found after this node was pushed
+			if (t_node > hit.distance) {
+				continue;
+			}
+			const Node& node = m_nodes[index];
+			if (node.IsLeaf()) {
+				f32 distance = t_node;
+				if (callback && !callback(node.item, ray, distance)) {
+					continue;
+				}
+				if (distance < hit.distance) {
+					hit.distance = distance;
+					hit.item = node.item;
+					found = true;
+				}
+				continue;
+			}
+
+			f32 t_left, t_right;
+			bool hit_left = IntersectRayBox(ray, inv_dir, m_nodes[node.left].box, hit.distance, t_left);
+			bool hit_right = IntersectRayBox(ray, inv_dir, m_nodes[node.right].box, hit.distance, t_right);
+			// push the far child first so the near one is visited first
+			if (hit_left && hit_right) {
+				if (t_left < t_right) {
+					stack.emplace_back(node.right, t_right);
+					stack.emplace_back(node.left, t_left);
+				}
+				else {
+					stack.emplace_back(node.left, t_left);
+					stack.emplace_back(node.right, t_right);
+				}
+			}
+			else if (hit_left) {
+				stack.emplace_back(node.left, t_left);
+			}
+			else if (hit_right) {
+				stack.emplace_back(node.right, t_right);
+			}
+		}
+		return found;
+	}
+
+	void Bvh::QueryBox(const BoundingBox& box, std::vector<u32>& items) const noexcept
+	{
+		if (m_root == k_invalid_index) {
+			return;
+		}
+		std::vector<u32> stack{ m_root };
+		while (!stack.empty()) {
+			u32 index = stack.back();
+			stack.pop_back();
+			const Node& node = m_nodes[index];
+			if (!Overlaps(node.box, box)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				items.push_back(node.item);
+			}
+			else {
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	u32 Bvh::GetItemCount() const noexcept
+	{
+		return m_item_count;
+	}
+
+	u32 Bvh::GetHeight() const noexcept
+	{
+		if (m_root == k_invalid_index) {
+			return 0;
+		}
+		u32 height = 0;
+		std::vector<std::pair<u32, u32>> stack{ { m_root, 1 } };
+		while (!stack.empty()) {
+			auto [index, depth] = stack.back();
+			stack.pop_back();
+			height = (std::max)(height, depth);
+			if (!m_nodes[index].IsLeaf()) {
+				stack.emplace_back(m_nodes[index].left, depth + 1);
+				stack.emplace_back(m_nodes[index].right, depth + 1);
+			}
+		}
+		return height;
+	}
+
+	u32 Bvh::AllocateNode() noexcept
+	{
+		if (!m_free_nodes.empty()) {
+			u32 index = m_free_nodes.back();
+			m_free_nodes.pop_back();
+			m_nodes[index] = Node{};
+			return index;
+		}
+		m_nodes.emplace_back();
+		return static_cast<u32>(m_nodes.size() - 1);
+	}
+
+	void Bvh::FreeNode(u32 index) noexcept
+	{
+		m_nodes[index] = Node{};
+		m_free_nodes.push_back(index);
+	}
+
+	void Bvh::RefitAncestors(u32 index) noexcept
+	{
+		while (index != k_invalid_index) {
+			const Node& node = m_nodes[index];
+			SetInternalBox(index, Union(m_nodes[node.left].box, m_nodes[node.right].box));
+			index = node.parent;
+		}
+	}
+
+	bool Bvh::SetInternalBox(u32 index, const BoundingBox& box) noexcept
+	{
+		Node& node = m_nodes[index];
+		if (node.box.min == box.min && node.box.max == box.max) {
+			return false;
+		}
+		m_internal_area += SurfaceArea(box) - SurfaceArea(node.box);
+		node.box = box;
+		return true;
+	}
+
+	void Bvh::CollectItems(u32 index, std::vector<u32>& items) const noexcept
+	{
+		std::vector<u32> stack{ index };
+		while (!stack.empty()) {
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (node.IsLeaf()) {
+				items.push_back(node.item);
+			}
+			else {
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	f32 Bvh::InternalArea() const noexcept
+	{
+		f32 area = 0.0f;
+		for (const Node& node : m_nodes) {
+			if (node.left != k_invalid_index) {
+				area += SurfaceArea(node.box);
+			}
+		}
+		return area;
+	}
+}
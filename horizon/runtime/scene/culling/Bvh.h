@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+#include <runtime/core/math/BoundingBox.h>
+#include <runtime/scene/culling/Frustum.h>
+
+namespace Horizon {
+
+	struct Ray {
+		Math::vec3 origin;
+		Math::vec3 direction;
+	};
+
+	struct RayHit {
+		u32 item = ~0u;
+		f32 distance = (std::numeric_limits<f32>::max)();
+	};
+
+	// optional narrow phase for ray casts, return true and write the hit distance if the item is really hit
+	using RayCastCallback = std::function<bool(u32 item, const Ray& ray, f32& distance)>;
+
+	// dynamic aabb tree with one item per leaf. items are user indices, e.g. render object indices.
+	// moving items are refitted in place, insert/remove update the tree incrementally and
+	// the tree is rebuilt top down when refits have degraded it too much.
+	class Bvh {
+	public:
+		static constexpr u32 k_invalid_index = ~0u;
+
+		// rebuild the tree from scratch, item i has bounds[i]
+		void Build(const std::vector<BoundingBox>& bounds) noexcept;
+		void Clear() noexcept;
+
+		void Insert(u32 item, const BoundingBox& box) noexcept;
+		void Remove(u32 item) noexcept;
+		bool Contains(u32 item) const noexcept;
+
+		// change the bounds of an item, takes effect after Refit()
+		void Update(u32 item, const BoundingBox& box) noexcept;
+		// true if the bounds of an internal node changed
+		bool Refit() noexcept;
+
+		// rebuild if the summed area of internal nodes grew past ratio times the area after the last build.
+		// the area is kept up to date as boxes change, so the check is constant time
+		bool RebuildIfDegraded(f32 ratio = 1.5f) noexcept;
+
+		void CullFrustum(const Frustum& frustum, std::vector<u32>& items) const noexcept;
+		bool RayCast(const Ray& ray, RayHit& hit, const RayCastCallback& callback = nullptr) const noexcept;
+		void QueryBox(const BoundingBox& box, std::vector<u32>& items) const noexcept;
+
+		u32 GetItemCount() const noexcept;
+		u32 GetHeight() const noexcept;
+	private:
+		struct Node {
+			BoundingBox box;
+			u32 parent = k_invalid_index;
+			u32 left = k_invalid_index;
+			u32 right = k_invalid_index;
+			u32 item = k_invalid_index;
+			bool dirty = false;
+
+			bool IsLeaf() const noexcept { return left == k_invalid_index; }
+		};
+
+		u32 AllocateNode() noexcept;
+		void FreeNode(u32 index) noexcept;
+		u32 BuildRange(std::vector<std::pair<u32, BoundingBox>>& leaves, u32 begin, u32 end, u32 parent) noexcept;
+		void RefitAncestors(u32 index) noexcept;
+		// sets the box of an internal node and tracks the internal area, false if the box did not change
+		bool SetInternalBox(u32 index, const BoundingBox& box) noexcept;
+		void CollectItems(u32 index, std::vector<u32>& items) const noexcept;
+		f32 InternalArea() const noexcept;
+	private:
+		std::vector<Node> m_nodes;
+		std::vector<u32> m_free_nodes;
+		std::vector<u32> m_item_to_leaf;
+		std::vector<u32> m_dirty_leaves;
+		u32 m_root = k_invalid_index;
+		u32 m_item_count = 0;
+		f32 m_built_area = 0.0f;
+		f32 m_internal_area = 0.0f;
+	};
+}
@@ -0,0 +1,152 @@
+#include "Frustum.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HORIZON_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Horizon {
+
+	Frustum::Frustum(const Math::mat4& view_projection) noexcept
+	{
+		// glm matrices are column major, m[col][row]
+		auto row = [&view_projection](u32 r) {
+			return Math::vec4(view_projection[0][r], view_projection[1][r], view_projection[2][r], view_projection[3][r]);
+		};
+
+		planes[0] = row(3) + row(0);
+		planes[1] = row(3) - row(0);
+		planes[2] = row(3) + row(1);
+		planes[3] = row(3) - row(1);
+		// reverse z: z >= 0 bounds the far side, z <= w the near side
+		planes[4] = row(2);
+		planes[5] = row(3) - row(2);
+
+		for (auto& plane : planes) {
+			plane /= Math::length(Math::vec3(plane));
+		}
+	}
+
+	bool Frustum::Intersects(const BoundingBox& box) const noexcept
+	{
+		Math::vec3 center = box.Center();
+		Math::vec3 extent = box.Extent();
+		for (auto& plane : planes) {
+			Math::vec3 normal = Math::vec3(plane);
+			f32 distance = Math::dot(normal, center) + plane.w;
+			f32 radius = Math::dot(Math::abs(normal), extent);
+			if (distance + radius < 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	FrustumTestResult Frustum::Classify(const BoundingBox& box) const noexcept
+	{
+		Math::vec3 center = box.Center();
+		Math::vec3 extent = box.Extent();
+		FrustumTestResult result = FrustumTestResult::INSIDE;
+		for (auto& plane : planes) {
+			Math::vec3 normal = Math::vec3(plane);
+			f32 distance = Math::dot(normal, center) + plane.w;
+			f32 radius = Math::dot(Math::abs(normal), extent);
+			if (distance + radius < 0.0f) {
+				return FrustumTestResult::OUTSIDE;
+			}
+			if (distance - radius < 0.0f) {
+				result = FrustumTestResult::INTERSECT;
+			}
+		}
+		return result;
+	}
+
+	void BoundsSoA::Resize(u32 count) noexcept
+	{
+		m_count = count;
+		// pad to a multiple of 4 so the batch test can always load full lanes
+		u32 padded_count = (count + 3) & ~3u;
+		center_x.resize(padded_count, 0.0f);
+		center_y.resize(padded_count, 0.0f);
+		center_z.resize(padded_count, 0.0f);
+		extent_x.resize(padded_count, 0.0f);
+		extent_y.resize(padded_count, 0.0f);
+		extent_z.resize(padded_count, 0.0f);
+	}
+
+	void BoundsSoA::Set(u32 index, const BoundingBox& box) noexcept
+	{
+		Math::vec3 center = box.Center();
+		Math::vec3 extent = box.Extent();
+		center_x[index] = center.x;
+		center_y[index] = center.y;
+		center_z[index] = center.z;
+		extent_x[index] = extent.x;
+		extent_y[index] = extent.y;
+		extent_z[index] = extent.z;
+	}
+
+	BoundingBox BoundsSoA::Get(u32 index) const noexcept
+	{
+		Math::vec3 center(center_x[index], center_y[index], center_z[index]);
+		Math::vec3 extent(extent_x[index], extent_y[index], extent_z[index]);
+		return BoundingBox(center - extent, center + extent);
+	}
+
+	u32 BoundsSoA::Size() const noexcept
+	{
+		return m_count;
+	}
+
+	u32 CullBounds(const Frustum& frustum, const BoundsSoA& bounds, std::vector<u8>& visibility) noexcept
+	{
+		u32 count = bounds.Size();
+		visibility.resize(count);
+		u32 visible_count = 0;
+		u32 i = 0;
+
+#ifdef HORIZON_CULLING_SSE
+		// 4 boxes per iteration, a box is rejected if it is fully behind any plane
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= ((count + 3) & ~3u); i += 4) {
+			__m128 cx = _mm_loadu_ps(&bounds.center_x[i]);
+			__m128 cy = _mm_loadu_ps(&bounds.center_y[i]);
+			__m128 cz = _mm_loadu_ps(&bounds.center_z[i]);
+			__m128 ex = _mm_loadu_ps(&bounds.extent_x[i]);
+			__m128 ey = _mm_loadu_ps(&bounds.extent_y[i]);
+			__m128 ez = _mm_loadu_ps(&bounds.extent_z[i]);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const auto& plane : frustum.planes) {
+				__m128 nx = _mm_set1_ps(plane.x);
+				__m128 ny = _mm_set1_ps(plane.y);
+				__m128 nz = _mm_set1_ps(plane.z);
+				__m128 abs_nx = _mm_set1_ps(Math::abs(plane.x));
+				__m128 abs_ny = _mm_set1_ps(Math::abs(plane.y));
+				__m128 abs_nz = _mm_set1_ps(Math::abs(plane.z));
+
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(plane.w)));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_nx, ex), _mm_mul_ps(abs_ny, ey)), _mm_mul_ps(abs_nz, ez));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+			}
+
+			i32 mask = _mm_movemask_ps(inside);
+			u32 lanes = (std::min)(4u, count - i);
+			for (u32 lane = 0; lane < lanes; lane++) {
+				u8 visible = (mask >> lane) & 1;
+				visibility[i + lane] = visible;
+				visible_count += visible;
+			}
+		}
+#endif
+
+		for (; i < count; i++) {
+			u8 visible = frustum.Intersects(bounds.Get(i)) ? 1 : 0;
+			visibility[i] = visible;
+			visible_count += visible;
+		}
+		return visible_count;
+	}
+}
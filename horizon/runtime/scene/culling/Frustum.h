@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+#include <runtime/core/math/BoundingBox.h>
+
+namespace Horizon {
+
+	enum class FrustumTestResult {
+		OUTSIDE,
+		INTERSECT,
+		INSIDE
+	};
+
+	class Frustum {
+	public:
+		Frustum() noexcept = default;
+
+		// extract planes from a clip space matrix, clip volume is -w <= x, y <= w, 0 <= z <= w.
+		// the camera projects with reverse z, so z = w is the near plane and z = 0 the far plane
+		explicit Frustum(const Math::mat4& view_projection) noexcept;
+
+		bool Intersects(const BoundingBox& box) const noexcept;
+
+		// distinguishes fully contained boxes so hierarchical culling can skip testing children
+		FrustumTestResult Classify(const BoundingBox& box) const noexcept;
+	public:
+		// left, right, bottom, top, far (z >= 0), near (z <= w) with reverse z. xyz: inward normal, w: distance
+		std::array<Math::vec4, 6> planes{};
+	};
+
+	// bounds in structure of arrays layout, stored as center and half extent for batch culling
+	class BoundsSoA {
+	public:
+		void Resize(u32 count) noexcept;
+		void Set(u32 index, const BoundingBox& box) noexcept;
+		BoundingBox Get(u32 index) const noexcept;
+		u32 Size() const noexcept;
+	public:
+		std::vector<f32> center_x, center_y, center_z;
+		std::vector<f32> extent_x, extent_y, extent_z;
+	private:
+		u32 m_count = 0;
+	};
+
+	// test all bounds against the frustum, visibility[i] is 1 if box i is potentially visible, returns visible count
+	u32 CullBounds(const Frustum& frustum, const BoundsSoA& bounds, std::vector<u8>& visibility) noexcept;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <runtime/core/math/Math.h>
+#include <runtime/core/math/BoundingBox.h>
+#include <runtime/scene/light/Light.h>
+
+namespace Horizon {
+
+	class Model;
+	class MeshPrimitive;
+
+	// components are plain data, systems iterate their dense arrays.
+	// render entities get a transform, a renderable and a bounds component together and are destroyed as a whole,
+	// so the three pools keep them in the same dense order
+
+	struct TransformComponent {
+		// world = instance * local
+		Math::mat4 world = Math::mat4(1.0f);
+		// node matrix of the mesh, written by the scene when the model moves
+		Math::mat4 local = Math::mat4(1.0f);
+		u32 instance = 0;
+		// set when local or the instance transform is written
+		u8 dirty = 1;
+	};
+
+	struct RenderableComponent {
+		Model* model = nullptr;
+		MeshPrimitive* primitive = nullptr;
+		u32 material_id = 0;
+		u32 primitive_id = 0;
+		// render object index, shared with the bvh, the world bounds array and the gpu driven pass
+		u32 object = 0;
+	};
+
+	struct BoundsComponent {
+		BoundingBox local;
+		BoundingBox world;
+	};
+
+	// the dense light array is uploaded as is, slot i is light i on the gpu
+	struct LightComponent {
+		LightParams params;
+	};
+	static_assert(sizeof(LightComponent) == sizeof(LightParams), "light components are uploaded without repacking");
+}
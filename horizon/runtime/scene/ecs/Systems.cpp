@@ -0,0 +1,47 @@
+#include "Systems.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Horizon {
+
+	void UpdateTransforms(World& world, const std::vector<Math::mat4>& instance_transforms, std::vector<u32>& moved) noexcept
+	{
+		ComponentPool<TransformComponent>& transforms = world.Pool<TransformComponent>();
+		ComponentPool<BoundsComponent>& bounds = world.Pool<BoundsComponent>();
+		assert(transforms.Size() == bounds.Size());
+
+		TransformComponent* transform_data = transforms.Data();
+		BoundsComponent* bounds_data = bounds.Data();
+		for (u32 i = 0; i < transforms.Size(); i++) {
+			TransformComponent& transform = transform_data[i];
+			if (!transform.dirty) {
+				continue;
+			}
+			transform.world = instance_transforms[transform.instance] * transform.local;
+			transform.dirty = 0;
+			bounds_data[i].world = bounds_data[i].local.Transform(transform.world);
+			moved.push_back(i);
+		}
+	}
+
+	void BuildDrawList(World& world, const std::vector<u8>& visibility, Pipeline* pipeline, const Math::vec3& camera_pos, DrawList& draw_list) noexcept
+	{
+		ComponentPool<RenderableComponent>& renderables = world.Pool<RenderableComponent>();
+		ComponentPool<TransformComponent>& transforms = world.Pool<TransformComponent>();
+		ComponentPool<BoundsComponent>& bounds = world.Pool<BoundsComponent>();
+		assert(renderables.Size() == transforms.Size() && renderables.Size() == bounds.Size());
+
+		const RenderableComponent* renderable_data = renderables.Data();
+		const TransformComponent* transform_data = transforms.Data();
+		const BoundsComponent* bounds_data = bounds.Data();
+		for (u32 i = 0; i < renderables.Size(); i++) {
+			const RenderableComponent& renderable = renderable_data[i];
+			if (!visibility[renderable.object]) {
+				continue;
+			}
+			f32 depth = Math::length(bounds_data[i].world.Center() - camera_pos);
+			draw_list.Add(DrawItem{ DrawKey::Make(0, renderable.material_id, renderable.primitive_id, depth), pipeline, renderable.model, renderable.primitive, transform_data[i].world });
+		}
+	}
+}
\ No newline at end of file
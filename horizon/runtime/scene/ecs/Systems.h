@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+#include <runtime/scene/ecs/World.h>
+#include <runtime/scene/scene/DrawList.h>
+
+namespace Horizon {
+
+	// systems run over the dense component arrays of a world, in the order listed here
+
+	// recompute world matrices and world bounds of dirty transforms, the dense slots of moved entities are appended to moved
+	void UpdateTransforms(World& world, const std::vector<Math::mat4>& instance_transforms, std::vector<u32>& moved) noexcept;
+
+	// add renderables whose render object is visible to the draw list, depth is the distance to the camera
+	void BuildDrawList(World& world, const std::vector<u8>& visibility, Pipeline* pipeline, const Math::vec3& camera_pos, DrawList& draw_list) noexcept;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+#include <runtime/scene/ecs/Components.h>
+
+namespace Horizon {
+
+	// stable entity handle, the generation changes when the slot is reused so stale handles are detected
+	struct Entity {
+		static constexpr u32 k_invalid_index = ~0u;
+
+		u32 index = k_invalid_index;
+		u32 generation = 0;
+
+		bool IsValid() const noexcept { return index != k_invalid_index; }
+		bool operator==(const Entity& rhs) const noexcept { return index == rhs.index && generation == rhs.generation; }
+		bool operator!=(const Entity& rhs) const noexcept { return !(*this == rhs); }
+	};
+
+	// sparse set: components are packed in a dense array, removal swaps the last component into the hole.
+	// systems iterate Data() linearly, GetEntity(i) is the owner of the i-th dense component
+	template<typename T>
+	class ComponentPool {
+	public:
+		T& Add(Entity entity, const T& component) noexcept
+		{
+			if (entity.index >= m_sparse.size()) {
+				m_sparse.resize(entity.index + 1, k_invalid_slot);
+			}
+			if (m_sparse[entity.index] != k_invalid_slot) {
+				m_dense[m_sparse[entity.index]] = component;
+				return m_dense[m_sparse[entity.index]];
+			}
+			m_sparse[entity.index] = static_cast<u32>(m_dense.size());
+			m_dense.push_back(component);
+			m_entities.push_back(entity);
+			return m_dense.back();
+		}
+
+		void Remove(Entity entity) noexcept
+		{
+			if (!Has(entity)) {
+				return;
+			}
+			u32 slot = m_sparse[entity.index];
+			u32 last = static_cast<u32>(m_dense.size() - 1);
+			if (slot != last) {
+				m_dense[slot] = std::move(m_dense[last]);
+				m_entities[slot] = m_entities[last];
+				m_sparse[m_entities[slot].index] = slot;
+			}
+			m_dense.pop_back();
+			m_entities.pop_back();
+			m_sparse[entity.index] = k_invalid_slot;
+		}
+
+		bool Has(Entity entity) const noexcept
+		{
+			return entity.index < m_sparse.size() && m_sparse[entity.index] != k_invalid_slot && m_entities[m_sparse[entity.index]] == entity;
+		}
+
+		// dense index of the component, changes when another component is swapped into a removed slot
+		u32 GetSlot(Entity entity) const noexcept { return m_sparse[entity.index]; }
+
+		T& Get(Entity entity) noexcept { return m_dense[m_sparse[entity.index]]; }
+		const T& Get(Entity entity) const noexcept { return m_dense[m_sparse[entity.index]]; }
+
+		T* Data() noexcept { return m_dense.data(); }
+		const T* Data() const noexcept { return m_dense.data(); }
+		Entity GetEntity(u32 slot) const noexcept { return m_entities[slot]; }
+		u32 Size() const noexcept { return static_cast<u32>(m_dense.size()); }
+
+		void Clear() noexcept
+		{
+			m_sparse.clear();
+			m_dense.clear();
+			m_entities.clear();
+		}
+	private:
+		static constexpr u32 k_invalid_slot = ~0u;
+
+		std::vector<u32> m_sparse;
+		std::vector<T> m_dense;
+		std::vector<Entity> m_entities;
+	};
+
+	// entity storage with one dense pool per component type
+	class World {
+	public:
+		Entity Create() noexcept
+		{
+			Entity entity;
+			if (!m_free_indices.empty()) {
+				entity.index = m_free_indices.back();
+				m_free_indices.pop_back();
+			}
+			else {
+				entity.index = static_cast<u32>(m_generations.size());
+				m_generations.push_back(0);
+			}
+			entity.generation = m_generations[entity.index];
+			m_alive_count++;
+			return entity;
+		}
+
+		void Destroy(Entity entity) noexcept
+		{
+			if (!IsAlive(entity)) {
+				return;
+			}
+			std::apply([entity](auto&... pools) { (pools.Remove(entity), ...); }, m_pools);
+			m_generations[entity.index]++;
+			m_free_indices.push_back(entity.index);
+			m_alive_count--;
+		}
+
+		bool IsAlive(Entity entity) const noexcept
+		{
+			return entity.index < m_generations.size() && m_generations[entity.index] == entity.generation;
+		}
+
+		u32 GetAliveCount() const noexcept { return m_alive_count; }
+
+		template<typename T>
+		T& AddComponent(Entity entity, const T& component) noexcept { return Pool<T>().Add(entity, component); }
+
+		template<typename T>
+		void RemoveComponent(Entity entity) noexcept { Pool<T>().Remove(entity); }
+
+		template<typename T>
+		bool HasComponent(Entity entity) const noexcept { return Pool<T>().Has(entity); }
+
+		template<typename T>
+		T& GetComponent(Entity entity) noexcept { return Pool<T>().Get(entity); }
+
+		template<typename T>
+		const T& GetComponent(Entity entity) const noexcept { return Pool<T>().Get(entity); }
+
+		template<typename T>
+		ComponentPool<T>& Pool() noexcept { return std::get<ComponentPool<T>>(m_pools); }
+
+		template<typename T>
+		const ComponentPool<T>& Pool() const noexcept { return std::get<ComponentPool<T>>(m_pools); }
+	private:
+		std::tuple<ComponentPool<TransformComponent>, ComponentPool<RenderableComponent>, ComponentPool<BoundsComponent>, ComponentPool<LightComponent>> m_pools;
+		std::vector<u32> m_generations;
+		std::vector<u32> m_free_indices;
+		u32 m_alive_count = 0;
+	};
+}
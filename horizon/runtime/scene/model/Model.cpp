@@ -1,5 +1,8 @@
 #include "Model.h"
 
+#include <array>
+
+
 #include <runtime/core/log/Log.h>
 #include <runtime/core/path/Path.h>
 #include <runtime/function/rhi/vulkan/VulkanBuffer.h>
@@ -26,6 +29,12 @@ namespace Horizon {
 
 
 			m_vertex_buffer = std::make_shared<VertexBuffer>(m_device, m_command_buffer, m_vertices);
+			// depth only passes fetch 12 instead of 32 bytes per vertex
+			std::vector<Math::vec3> positions(m_vertices.size());
+			for (u32 i = 0; i < m_vertices.size(); i++) {
+				positions[i] = m_vertices[i].pos;
+			}
+			m_position_buffer = std::make_shared<VertexBuffer>(m_device, m_command_buffer, positions);
 			m_index_buffer = std::make_shared<IndexBuffer>(m_device, m_command_buffer, m_indices);
 		}
 		else
@@ -39,15 +48,29 @@ namespace Horizon {
 	}
 
 	void Model::Draw(std::shared_ptr<Pipeline> pipeline, VkCommandBuffer command_buffer) noexcept
+	{
+		BindBuffers(command_buffer);
+		for (auto& node : m_nodes) {
+			DrawNode(node, pipeline, command_buffer);
+		}
+	}
+
+	void Model::BindBuffers(VkCommandBuffer command_buffer) noexcept
 	{
 		const VkDeviceSize offsets[1] = { 0 };
 		VkBuffer vertexBuffer = m_vertex_buffer->Get();
 
 		vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertexBuffer, offsets);
 		vkCmdBindIndexBuffer(command_buffer, m_index_buffer->Get(), 0, VK_INDEX_TYPE_UINT32);
-		for (auto& node : m_nodes) {
-			DrawNode(node, pipeline, command_buffer);
-		}
+	}
+
+	void Model::BindPositionBuffers(VkCommandBuffer command_buffer) noexcept
+	{
+		const VkDeviceSize offsets[1] = { 0 };
+		VkBuffer position_buffer = m_position_buffer->Get();
+
+		vkCmdBindVertexBuffers(command_buffer, 0, 1, &position_buffer, offsets);
+		vkCmdBindIndexBuffer(command_buffer, m_index_buffer->Get(), 0, VK_INDEX_TYPE_UINT32);
 	}
 
 	void Model::LoadTextures(tinygltf::Model& gltfModel) noexcept
@@ -245,105 +268,17 @@ namespace Horizon {
 		if (node.mesh > -1) {
 			const tinygltf::Mesh mesh = model.meshes[node.mesh];
 			std::shared_ptr<Mesh> newMesh = std::make_shared<Mesh>(m_device, newNode->matrix);
-			for (size_t j = 0; j < mesh.primitives.size(); j++) {
-				const tinygltf::Primitive& primitive = mesh.primitives[j];
-				uint32_t indexStart = static_cast<uint32_t>(indices.size());
-				uint32_t vertexStart = static_cast<uint32_t>(vertices.size());
-				uint32_t indexCount = 0;
-				uint32_t vertexCount = 0;
-				Math::vec3 posMin{};
-				Math::vec3 posMax{};
-				bool hasSkin = false;
-				bool hasIndices = primitive.indices > -1;
-				// Vertices
-				{
-					const f32* bufferPos = nullptr;
-					const f32* bufferNormals = nullptr;
-					const f32* bufferTexCoordSet0 = nullptr;
-					const f32* bufferTexCoordSet1 = nullptr;
-					const void* bufferJoints = nullptr;
-					const f32* bufferWeights = nullptr;
-
-					int posByteStride;
-					int normByteStride;
-					int uv0ByteStride;
-					int uv1ByteStride;
-					int jointByteStride;
-					int weightByteStride;
-
-					int jointComponentType;
-
-					// Position attribute is required
-					assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
-
-					const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
-					const tinygltf::BufferView& posView = model.bufferViews[posAccessor.bufferView];
-					bufferPos = reinterpret_cast<const f32*>(&(model.buffers[posView.buffer].data[posAccessor.byteOffset + posView.byteOffset]));
-					posMin = Math::vec3(posAccessor.minValues[0], posAccessor.minValues[1], posAccessor.minValues[2]);
-					posMax = Math::vec3(posAccessor.maxValues[0], posAccessor.maxValues[1], posAccessor.maxValues[2]);
-					vertexCount = static_cast<uint32_t>(posAccessor.count);
-					posByteStride = posAccessor.ByteStride(posView) ? (posAccessor.ByteStride(posView) / sizeof(f32)) : sizeof(Math::vec3) * 8;
-
-					if (primitive.attributes.find("NORMAL") != primitive.attributes.end()) {
-						const tinygltf::Accessor& normAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
-						const tinygltf::BufferView& normView = model.bufferViews[normAccessor.bufferView];
-						bufferNormals = reinterpret_cast<const f32*>(&(model.buffers[normView.buffer].data[normAccessor.byteOffset + normView.byteOffset]));
-						normByteStride = normAccessor.ByteStride(normView) ? (normAccessor.ByteStride(normView) / sizeof(f32)) : sizeof(Math::vec3) * 8;
-					}
-
-					if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end()) {
-						const tinygltf::Accessor& uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
-						const tinygltf::BufferView& uvView = model.bufferViews[uvAccessor.bufferView];
-						bufferTexCoordSet0 = reinterpret_cast<const f32*>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
-						uv0ByteStride = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(f32)) : sizeof(Math::vec3) * 8;
-					}
-					for (size_t v = 0; v < posAccessor.count; v++) {
-						Vertex vert;
-						vert.pos = Math::make_vec3(&bufferPos[v * posByteStride]);
-						vert.normal = Math::normalize(Math::vec3(bufferNormals ? Math::make_vec3(&bufferNormals[v * normByteStride]) : Math::vec3(0.0f)));
-						vert.uv0 = bufferTexCoordSet0 ? Math::make_vec2(&bufferTexCoordSet0[v * uv0ByteStride]) : Math::vec3(0.0f);
-						//vert.uv1 = bufferTexCoordSet1 ? Math::make_vec2(&bufferTexCoordSet1[v * uv1ByteStride]) : Math::vec3(0.0f);
-						vertices.push_back(vert);
-					}
-				}
-				// Indices
-				if (hasIndices)
-				{
-					const tinygltf::Accessor& accessor = model.accessors[primitive.indices > -1 ? primitive.indices : 0];
-					const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-					const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
-					indexCount = static_cast<uint32_t>(accessor.count);
-					const void* dataPtr = &(buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-
-					switch (accessor.componentType) {
-					case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
-						const uint32_t* buf = static_cast<const uint32_t*>(dataPtr);
-						for (size_t index = 0; index < accessor.count; index++) {
-							indices.push_back(buf[index] + vertexStart);
-						}
-						break;
-					}
-					case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
-						const uint16_t* buf = static_cast<const uint16_t*>(dataPtr);
-						for (size_t index = 0; index < accessor.count; index++) {
-							indices.push_back(buf[index] + vertexStart);
-						}
-						break;
-					}
-					case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
-						const uint8_t* buf = static_cast<const uint8_t*>(dataPtr);
-						for (size_t index = 0; index < accessor.count; index++) {
-							indices.push_back(buf[index] + vertexStart);
-						}
-						break;
-					}
-					default:
-						//std::cerr << "Index component type " << accessor.componentType << " not supported!" << std::endl;
-						return;
-					}
+			// nodes referencing the same gltf mesh share its primitives, so vertex data is loaded once
+			auto loaded_primitives = m_gltf_mesh_primitives.find(node.mesh);
+			if (loaded_primitives != m_gltf_mesh_primitives.end()) {
+				newMesh->primitives = loaded_primitives->second;
+			}
+			else {
+				// a primitive with an unsupported index type drops the whole node
+				if (!LoadPrimitives(newMesh, mesh, model, indices, vertices)) {
+					return;
 				}
-				newMesh->primitives.emplace_back(std::make_shared<MeshPrimitive>(indexStart, indexCount, vertexCount, primitive.material > -1 ? m_materials[primitive.material] : m_materials[0]));
+				m_gltf_mesh_primitives.emplace(node.mesh, newMesh->primitives);
 			}
 			newNode->mesh = newMesh;
 		}
@@ -356,18 +291,118 @@ namespace Horizon {
 		m_linear_nodes.push_back(newNode);
 	}
 
+	bool Model::LoadPrimitives(std::shared_ptr<Mesh> newMesh, const tinygltf::Mesh& mesh, const tinygltf::Model& model, std::vector<u32>& indices, std::vector<Vertex>& vertices) noexcept
+	{
+		for (size_t j = 0; j < mesh.primitives.size(); j++) {
+			const tinygltf::Primitive& primitive = mesh.primitives[j];
+			uint32_t indexStart = static_cast<uint32_t>(indices.size());
+			uint32_t vertexStart = static_cast<uint32_t>(vertices.size());
+			uint32_t indexCount = 0;
+			uint32_t vertexCount = 0;
+			Math::vec3 posMin{};
+			Math::vec3 posMax{};
+			bool hasSkin = false;
+			bool hasIndices = primitive.indices > -1;
+			// Vertices
+			{
+				const f32* bufferPos = nullptr;
+				const f32* bufferNormals = nullptr;
+				const f32* bufferTexCoordSet0 = nullptr;
+				const f32* bufferTexCoordSet1 = nullptr;
+				const void* bufferJoints = nullptr;
+				const f32* bufferWeights = nullptr;
+
+				int posByteStride;
+				int normByteStride;
+				int uv0ByteStride;
+				int uv1ByteStride;
+				int jointByteStride;
+				int weightByteStride;
+
+				int jointComponentType;
+
+				// Position attribute is required
+				assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
+
+				const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
+				const tinygltf::BufferView& posView = model.bufferViews[posAccessor.bufferView];
+				bufferPos = reinterpret_cast<const f32*>(&(model.buffers[posView.buffer].data[posAccessor.byteOffset + posView.byteOffset]));
+				posMin = Math::vec3(posAccessor.minValues[0], posAccessor.minValues[1], posAccessor.minValues[2]);
+				posMax = Math::vec3(posAccessor.maxValues[0], posAccessor.maxValues[1], posAccessor.maxValues[2]);
+				vertexCount = static_cast<uint32_t>(posAccessor.count);
+				posByteStride = posAccessor.ByteStride(posView) ? (posAccessor.ByteStride(posView) / sizeof(f32)) : sizeof(Math::vec3) * 8;
+
+				if (primitive.attributes.find("NORMAL") != primitive.attributes.end()) {
+					const tinygltf::Accessor& normAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
+					const tinygltf::BufferView& normView = model.bufferViews[normAccessor.bufferView];
+					bufferNormals = reinterpret_cast<const f32*>(&(model.buffers[normView.buffer].data[normAccessor.byteOffset + normView.byteOffset]));
+					normByteStride = normAccessor.ByteStride(normView) ? (normAccessor.ByteStride(normView) / sizeof(f32)) : sizeof(Math::vec3) * 8;
+				}
+
+				if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end()) {
+					const tinygltf::Accessor& uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
+					const tinygltf::BufferView& uvView = model.bufferViews[uvAccessor.bufferView];
+					bufferTexCoordSet0 = reinterpret_cast<const f32*>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
+					uv0ByteStride = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(f32)) : sizeof(Math::vec3) * 8;
+				}
+				for (size_t v = 0; v < posAccessor.count; v++) {
+					Vertex vert;
+					vert.pos = Math::make_vec3(&bufferPos[v * posByteStride]);
+					vert.normal = Math::normalize(Math::vec3(bufferNormals ? Math::make_vec3(&bufferNormals[v * normByteStride]) : Math::vec3(0.0f)));
+					vert.uv0 = bufferTexCoordSet0 ? Math::make_vec2(&bufferTexCoordSet0[v * uv0ByteStride]) : Math::vec3(0.0f);
+					//vert.uv1 = bufferTexCoordSet1 ? Math::make_vec2(&bufferTexCoordSet1[v * uv1ByteStride]) : Math::vec3(0.0f);
+					vertices.push_back(vert);
+				}
+			}
+			// Indices
+			if (hasIndices)
+			{
+				const tinygltf::Accessor& accessor = model.accessors[primitive.indices > -1 ? primitive.indices : 0];
+				const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+				const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+				indexCount = static_cast<uint32_t>(accessor.count);
+				const void* dataPtr = &(buffer.data[accessor.byteOffset + bufferView.byteOffset]);
+
+				switch (accessor.componentType) {
+				case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
+					const uint32_t* buf = static_cast<const uint32_t*>(dataPtr);
+					for (size_t index = 0; index < accessor.count; index++) {
+						indices.push_back(buf[index] + vertexStart);
+					}
+					break;
+				}
+				case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
+					const uint16_t* buf = static_cast<const uint16_t*>(dataPtr);
+					for (size_t index = 0; index < accessor.count; index++) {
+						indices.push_back(buf[index] + vertexStart);
+					}
+					break;
+				}
+				case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
+					const uint8_t* buf = static_cast<const uint8_t*>(dataPtr);
+					for (size_t index = 0; index < accessor.count; index++) {
+						indices.push_back(buf[index] + vertexStart);
+					}
+					break;
+				}
+				default:
+					//std::cerr << "Index component type " << accessor.componentType << " not supported!" << std::endl;
+					return false;
+				}
+			}
+			std::shared_ptr<MeshPrimitive> newPrimitive = std::make_shared<MeshPrimitive>(indexStart, indexCount, vertexCount, primitive.material > -1 ? m_materials[primitive.material] : m_materials[0]);
+			newPrimitive->bounds = BoundingBox(posMin, posMax);
+			newMesh->primitives.emplace_back(newPrimitive);
+		}
+		return true;
+	}
+
 	void Model::DrawNode(std::shared_ptr<Node> node, std::shared_ptr<Pipeline> pipeline, VkCommandBuffer command_buffer) noexcept
 	{
 		if (node->mesh) {
 			for (auto& primitive : node->mesh->primitives) {
-				std::vector<VkDescriptorSet> descriptors{ m_scene_descriptor_set->Get(),  primitive->material->m_material_descriptor_set->Get() };
-
-				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetLayout(), 0, descriptors.size(), descriptors.data(), 0, 0);
-				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->Get());
-				if (pipeline->hasPushConstants()) {
-					vkCmdPushConstants(command_buffer, pipeline->GetLayout(), SHADER_STAGE_VERTEX_SHADER, 0, sizeof(node->mesh->m_mesh_push_constant), &node->mesh->m_mesh_push_constant);
-				}
-				vkCmdDrawIndexed(command_buffer, primitive->indexCount, 1, primitive->firstIndex, 0, 0);
+				DrawPrimitive(node->mesh, primitive, pipeline, command_buffer);
 			}
 		}
 		for (auto& child : node->m_children) {
@@ -375,6 +410,18 @@ namespace Horizon {
 		}
 	}
 
+	void Model::DrawPrimitive(std::shared_ptr<Mesh> mesh, std::shared_ptr<MeshPrimitive> primitive, std::shared_ptr<Pipeline> pipeline, VkCommandBuffer command_buffer) noexcept
+	{
+		std::array<VkDescriptorSet, 2> descriptors{ m_scene_descriptor_set->Get(),  primitive->material->m_material_descriptor_set->Get() };
+
+		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetLayout(), 0, static_cast<u32>(descriptors.size()), descriptors.data(), 0, 0);
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->Get());
+		if (pipeline->hasPushConstants()) {
+			vkCmdPushConstants(command_buffer, pipeline->GetLayout(), SHADER_STAGE_VERTEX_SHADER, 0, sizeof(mesh->m_mesh_push_constant), &mesh->m_mesh_push_constant);
+		}
+		vkCmdDrawIndexed(command_buffer, primitive->indexCount, 1, primitive->firstIndex, 0, 0);
+	}
+
 	void Model::UpdateDescriptors() noexcept
 	{
 		for (auto& material : m_materials) {
@@ -389,6 +436,21 @@ namespace Horizon {
 		}
 	}
 
+	const std::vector<std::shared_ptr<Node>>& Model::GetLinearNodes() const noexcept
+	{
+		return m_linear_nodes;
+	}
+
+	bool Model::IsTransformDirty() const noexcept
+	{
+		return m_transform_dirty;
+	}
+
+	void Model::ClearTransformDirty() noexcept
+	{
+		m_transform_dirty = false;
+	}
+
 	void Model::UpdateNodeModelMatrix(std::shared_ptr<Node> node) noexcept
 	{
 
@@ -432,6 +494,7 @@ namespace Horizon {
 	void Model::SetModelMatrix(const Math::mat4& modelMatrix) noexcept
 	{
 		m_model_matrix = modelMatrix;
+		m_transform_dirty = true;
 	}
 
 	std::shared_ptr<DescriptorSet> Model::GetNodeMaterialDescriptorSet(std::shared_ptr<Node> node) noexcept
@@ -489,7 +552,9 @@ namespace Horizon {
 	}
 
 	void Node::update(const Math::mat4& modelMat) noexcept {
-		mesh->m_mesh_push_constant.modelMatrix = modelMat * getMatrix();
+		if (mesh) {
+			mesh->m_mesh_push_constant.modelMatrix = modelMat * getMatrix();
+		}
 		//mesh->meshUbStruct.model = modelMat * getMatrix();
 		//mesh->meshUb->update(&mesh->meshUbStruct, sizeof(mesh->meshUbStruct));
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 
 #include <vulkan/vulkan.hpp>
 #include "tiny_gltf.h"
@@ -13,6 +14,7 @@
 #include <runtime/function/rhi/vulkan/VertexBuffer.h>
 #include <runtime/function/rhi/vulkan/IndexBuffer.h>
 #include <runtime/function/rhi/vulkan/Texture.h>
+#include <runtime/core/math/BoundingBox.h>
 #include <runtime/scene/material/Material.h>
 
 
@@ -27,6 +29,8 @@ namespace Horizon {
 		uint32_t indexCount;
 		uint32_t vertexCount;
 		bool hasIndices;
+		// local space bounds from the position accessor
+		BoundingBox bounds;
 	};
 
 	class Mesh {
@@ -76,9 +80,19 @@ namespace Horizon {
 		void LoadTextures(tinygltf::Model& gltfModel) noexcept;
 		void LoadMaterials(tinygltf::Model& gltfModel) noexcept;
 		void LoadNode(std::shared_ptr<Node> m_parent, const tinygltf::Node& node, uint32_t nodeIndex, const tinygltf::Model& model, std::vector<u32>& indexBuffer, std::vector<Vertex>& vertexBuffer, f32 globalscale) noexcept;
+		// false if a primitive has an unsupported index type
+		bool LoadPrimitives(std::shared_ptr<Mesh> newMesh, const tinygltf::Mesh& mesh, const tinygltf::Model& model, std::vector<u32>& indexBuffer, std::vector<Vertex>& vertexBuffer) noexcept;
 		void DrawNode(std::shared_ptr<Node> node, std::shared_ptr<Pipeline> pipeline, VkCommandBuffer command_buffer) noexcept;
+		void BindBuffers(VkCommandBuffer command_buffer) noexcept;
+		// position stream and indices, for pipelines created with position_only
+		void BindPositionBuffers(VkCommandBuffer command_buffer) noexcept;
+		void DrawPrimitive(std::shared_ptr<Mesh> mesh, std::shared_ptr<MeshPrimitive> primitive, std::shared_ptr<Pipeline> pipeline, VkCommandBuffer command_buffer) noexcept;
 		void UpdateDescriptors() noexcept;
 		void UpdateModelMatrix() noexcept;
+		const std::vector<std::shared_ptr<Node>>& GetLinearNodes() const noexcept;
+		// set when the model matrix changes, cleared by the scene after world bounds are refreshed
+		bool IsTransformDirty() const noexcept;
+		void ClearTransformDirty() noexcept;
 		//std::shared_ptr<DescriptorSet> getMeshDescriptorSet();
 		std::shared_ptr<DescriptorSet> GetMaterialDescriptorSet() noexcept;
 		void SetModelMatrix(const Math::mat4& modelMatrix) noexcept;
@@ -95,8 +109,10 @@ namespace Horizon {
 
 
 		Math::mat4 m_model_matrix = Math::mat4(1.0);
+		bool m_transform_dirty = true;
 
 		std::shared_ptr<VertexBuffer> m_vertex_buffer = nullptr;
+		std::shared_ptr<VertexBuffer> m_position_buffer = nullptr;
 		std::shared_ptr<IndexBuffer> m_index_buffer = nullptr;
 
 		std::vector<Vertex> m_vertices;
@@ -104,6 +120,8 @@ namespace Horizon {
 
 		std::vector<std::shared_ptr<Node>> m_nodes;
 		std::vector<std::shared_ptr<Node>> m_linear_nodes;
+		// primitives of each gltf mesh index
+		std::unordered_map<int, std::vector<std::shared_ptr<MeshPrimitive>>> m_gltf_mesh_primitives;
 
 		std::vector<std::shared_ptr<Texture>> m_textures;
 		std::vector<std::shared_ptr<Material>> m_materials;
@@ -1,7 +1,13 @@
 #include "Atmosphere.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <runtime/core/log/Log.h>
 #include <runtime/core/path/Path.h>
 #include <runtime/function/rhi/vulkan/VulkanEnums.h>
+#include <runtime/function/rhi/vulkan/ResourceBarrier.h>
 #include <runtime/function/rhi/RenderContext.h>
 
 namespace Horizon
@@ -10,20 +16,24 @@ namespace Horizon
 		std::shared_ptr<PipelineManager> _pipeline_manager,
 		std::shared_ptr<Device> _device,
 		std::shared_ptr<CommandBuffer> command_buffer,
-		RenderContext& _render_context) noexcept
+		RenderContext& _render_context,
+		AtmosphereLutQuality lut_quality) noexcept : m_render_context(_render_context), m_pipeline_manager(_pipeline_manager), m_device(_device),
+		m_lut_quality(lut_quality), m_lut_desc(AtmosphereLutDesc::Get(lut_quality)), m_command_buffer(command_buffer)
 	{
 
 		CreateResources(_device, command_buffer);
+		LoadLutCache();
 
 		// transmittance lut
 
 		ComputePipelineCreateInfo transmittance_lut_create_info;
 		transmittance_lut_create_info.name = "transmittance_lut";
-		transmittance_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/transmittance_lut.comp.spv"));
+		transmittance_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "transmittance_lut", "comp"));
 		transmittance_lut_create_info.descriptor_layouts = transmittance_lut_descriptor_set_layouts;
-		transmittance_lut_create_info.group_count_x = 256 / 8;
-		transmittance_lut_create_info.group_count_y = 64 / 8;
+		transmittance_lut_create_info.group_count_x = (m_lut_desc.transmittance_width + 7) / 8;
+		transmittance_lut_create_info.group_count_y = (m_lut_desc.transmittance_height + 7) / 8;
 		transmittance_lut_create_info.group_count_z = 1;
+		transmittance_lut_create_info.push_constants = lut_push_constants;
 
 		m_transmittance_lut_pass = _pipeline_manager->CreateComputePipeline(transmittance_lut_create_info);
 
@@ -31,11 +41,12 @@ namespace Horizon
 
 		ComputePipelineCreateInfo direct_irradiance_lut_create_info;
 		direct_irradiance_lut_create_info.name = "direct_irradiance_lut";
-		direct_irradiance_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/direct_irradiance_lut.comp.spv"));
+		direct_irradiance_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "direct_irradiance_lut", "comp"));
 		direct_irradiance_lut_create_info.descriptor_layouts = direct_irradiance_lut_descriptor_set_layouts;
-		direct_irradiance_lut_create_info.group_count_x = 64 / 8;
-		direct_irradiance_lut_create_info.group_count_y = 16 / 8;
+		direct_irradiance_lut_create_info.group_count_x = (m_lut_desc.irradiance_width + 7) / 8;
+		direct_irradiance_lut_create_info.group_count_y = (m_lut_desc.irradiance_height + 7) / 8;
 		direct_irradiance_lut_create_info.group_count_z = 1;
+		direct_irradiance_lut_create_info.push_constants = lut_push_constants;
 
 		m_direct_irradiance_lut_pass = _pipeline_manager->CreateComputePipeline(direct_irradiance_lut_create_info);
 
@@ -43,11 +54,12 @@ namespace Horizon
 
 		ComputePipelineCreateInfo single_scattering_lut_create_info;
 		single_scattering_lut_create_info.name = "single_scattering_lut";
-		single_scattering_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/single_scattering_lut.comp.spv"));
+		single_scattering_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "single_scattering_lut", "comp"));
 		single_scattering_lut_create_info.descriptor_layouts = single_scattering_lut_descriptor_set_layouts;
-		single_scattering_lut_create_info.group_count_x = 256 / 4;
-		single_scattering_lut_create_info.group_count_y = 128 / 4;
-		single_scattering_lut_create_info.group_count_z = 32 / 4;
+		single_scattering_lut_create_info.group_count_x = (m_lut_desc.GetScatteringWidth() + 3) / 4;
+		single_scattering_lut_create_info.group_count_y = (m_lut_desc.scattering_mu_size + 3) / 4;
+		single_scattering_lut_create_info.group_count_z = (m_lut_desc.scattering_r_size + 3) / 4;
+		single_scattering_lut_create_info.push_constants = lut_push_constants;
 
 		m_single_scattering_lut_pass = _pipeline_manager->CreateComputePipeline(single_scattering_lut_create_info);
 
@@ -55,12 +67,12 @@ namespace Horizon
 
 		ComputePipelineCreateInfo scattering_density_lut_create_info;
 		scattering_density_lut_create_info.name = "scattering_density_lut";
-		scattering_density_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/scattering_density.comp.spv"));
+		scattering_density_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "scattering_density", "comp"));
 		scattering_density_lut_create_info.descriptor_layouts = scattering_density_lut_descriptor_set_layouts;
-		scattering_density_lut_create_info.group_count_x = 256 / 4;
-		scattering_density_lut_create_info.group_count_y = 128 / 4;
-		scattering_density_lut_create_info.group_count_z = 32 / 4;
-		scattering_density_lut_create_info.push_constants = scattering_order_push_constants;
+		scattering_density_lut_create_info.group_count_x = (m_lut_desc.GetScatteringWidth() + 3) / 4;
+		scattering_density_lut_create_info.group_count_y = (m_lut_desc.scattering_mu_size + 3) / 4;
+		scattering_density_lut_create_info.group_count_z = (m_lut_desc.scattering_r_size + 3) / 4;
+		scattering_density_lut_create_info.push_constants = lut_push_constants;
 
 		m_scattering_density_lut = _pipeline_manager->CreateComputePipeline(scattering_density_lut_create_info);
 
@@ -68,55 +80,79 @@ namespace Horizon
 
 		ComputePipelineCreateInfo indirect_irradiance_lut_create_info;
 		indirect_irradiance_lut_create_info.name = "indirect_irradiance_lut";
-		indirect_irradiance_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/indirect_irradiance_lut.comp.spv"));
+		indirect_irradiance_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "indirect_irradiance_lut", "comp"));
 		indirect_irradiance_lut_create_info.descriptor_layouts = indirect_irradiance_lut_descriptor_set_layouts;
-		indirect_irradiance_lut_create_info.group_count_x = 64 / 8;
-		indirect_irradiance_lut_create_info.group_count_y = 16 / 8;
+		indirect_irradiance_lut_create_info.group_count_x = (m_lut_desc.irradiance_width + 7) / 8;
+		indirect_irradiance_lut_create_info.group_count_y = (m_lut_desc.irradiance_height + 7) / 8;
 		indirect_irradiance_lut_create_info.group_count_z = 1;
-		indirect_irradiance_lut_create_info.push_constants = scattering_order_push_constants;
+		indirect_irradiance_lut_create_info.push_constants = lut_push_constants;
 		m_indirect_irradiance_lut = _pipeline_manager->CreateComputePipeline(indirect_irradiance_lut_create_info);
 
 		// multiple scattering lut 
 
 		ComputePipelineCreateInfo multi_scattering_lut_create_info;
 		multi_scattering_lut_create_info.name = "multi_scattering_lut";
-		multi_scattering_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/multi_scattering_lut.comp.spv"));
+		multi_scattering_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "multi_scattering_lut", "comp"));
 		multi_scattering_lut_create_info.descriptor_layouts = multi_scattering_lut_descriptor_set_layouts;
-		multi_scattering_lut_create_info.group_count_x = 256 / 4;
-		multi_scattering_lut_create_info.group_count_y = 128 / 4;
-		multi_scattering_lut_create_info.group_count_z = 32 / 4;
+		multi_scattering_lut_create_info.group_count_x = (m_lut_desc.GetScatteringWidth() + 3) / 4;
+		multi_scattering_lut_create_info.group_count_y = (m_lut_desc.scattering_mu_size + 3) / 4;
+		multi_scattering_lut_create_info.group_count_z = (m_lut_desc.scattering_r_size + 3) / 4;
+		multi_scattering_lut_create_info.push_constants = lut_push_constants;
 		 
 		m_multi_scattering_lut = _pipeline_manager->CreateComputePipeline(multi_scattering_lut_create_info);
 
+		// sky view lut
+
+		ComputePipelineCreateInfo sky_view_lut_create_info;
+		sky_view_lut_create_info.name = "sky_view_lut";
+		sky_view_lut_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "sky_view_lut", "comp"));
+		sky_view_lut_create_info.descriptor_layouts = sky_view_lut_descriptor_set_layouts;
+		sky_view_lut_create_info.group_count_x = (k_sky_view_lut_width + 7) / 8;
+		sky_view_lut_create_info.group_count_y = (k_sky_view_lut_height + 7) / 8;
+		sky_view_lut_create_info.group_count_z = 1;
+
+		m_sky_view_lut_pass = _pipeline_manager->CreateComputePipeline(sky_view_lut_create_info);
+
 		// camera volume
 
-		//ComputePipelineCreateInfo camera_volume_create_info;
-		//camera_volume_create_info.name = "camera_volume";
-		//camera_volume_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/camera_volume.comp.spv"));
-		//camera_volume_create_info.descriptor_layouts = camera_volume_descriptor_set_layouts;
-		//camera_volume_create_info.group_count_x = 256 / 4;
-		//camera_volume_create_info.group_count_y = 128 / 4;
-		//camera_volume_create_info.group_count_z = 32 / 4;
+		ComputePipelineCreateInfo camera_volume_create_info;
+		camera_volume_create_info.name = "camera_volume";
+		camera_volume_create_info.cs = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "camera_volume", "comp"));
+		camera_volume_create_info.descriptor_layouts = camera_volume_descriptor_set_layouts;
+		camera_volume_create_info.group_count_x = k_camera_volume_size / 4;
+		camera_volume_create_info.group_count_y = k_camera_volume_size / 4;
+		camera_volume_create_info.group_count_z = k_camera_volume_size / 4;
 
-		//m_camera_volume_pass = _pipeline_manager->CreateComputePipeline(camera_volume_create_info);
+		m_camera_volume_pass = _pipeline_manager->CreateComputePipeline(camera_volume_create_info);
 
 		// sky pass
 
 		GraphicsPipelineCreateInfo sky_pipeline_create_info;
 		sky_pipeline_create_info.name = "scatter";
 		sky_pipeline_create_info.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/scatter.vert.spv"));
-		sky_pipeline_create_info.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/scatter.frag.spv"));
+		sky_pipeline_create_info.ps = std::make_shared<Shader>(_device->Get(), GetLutShaderPath(m_lut_desc, "scatter", "frag"));
 		sky_pipeline_create_info.descriptor_layouts = sky_descriptor_set_layout;
+		sky_pipeline_create_info.dynamic_resolution = true;
 
 		std::vector<AttachmentCreateInfo> sky_attachments_create_info{
-			{TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1}
+			{TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM, COLOR_ATTACHMENT | ALIASED_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1}
 		};
 
 		m_sky_pass = _pipeline_manager->CreateGraphicsPipeline(sky_pipeline_create_info, sky_attachments_create_info, _render_context);
 
+		// upsample pass, draws into the sky pass framebuffer
+
+		GraphicsPipelineCreateInfo sky_upsample_pipeline_create_info;
+		sky_upsample_pipeline_create_info.name = "sky_upsample";
+		sky_upsample_pipeline_create_info.vs = sky_pipeline_create_info.vs;
+		sky_upsample_pipeline_create_info.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/sky_upsample.frag.spv"));
+		sky_upsample_pipeline_create_info.descriptor_layouts = sky_descriptor_set_layout;
+		sky_upsample_pipeline_create_info.dynamic_resolution = true;
+		sky_upsample_pipeline_create_info.framebuffer = std::static_pointer_cast<GraphicsPipeline>(m_sky_pass)->GetFramebuffer();
+
+		m_sky_upsample_pass = _pipeline_manager->CreateGraphicsPipeline(sky_upsample_pipeline_create_info, sky_attachments_create_info, _render_context);
 
 		m_sky_ub = std::make_shared<UniformBuffer>(_device);
-		m_sky_ubdata.resolution = Math::vec2(_render_context.width, _render_context.height);
 
 	}
 
@@ -128,76 +164,129 @@ namespace Horizon
 	{
 		m_sky_ubdata.inv_view_projection_matrix = inv_view_projection;
 		m_sky_ubdata.camera_pos = camera_pos;
+		// the sky is drawn into the render area, the depth and lighting inputs are sampled there too
+		u32 downsample = GetSkyDownsample(m_sky_quality);
+		Math::vec2 resolution = Math::vec2(m_render_context.GetRenderExtent((m_render_context.width + downsample - 1) / downsample), m_render_context.GetRenderExtent((m_render_context.height + downsample - 1) / downsample));
+		// a resized render area moves the pixels of the history
+		if (resolution != m_sky_ubdata.resolution) {
+			m_history_valid = false;
+		}
+		m_sky_ubdata.resolution = resolution;
+		m_sky_ubdata.uv_scale = m_render_context.GetRenderUvScale();
+		m_sky_ubdata.downsample = static_cast<f32>(downsample);
+
+		// the history written last frame becomes the one reprojected from
+		m_frame_index++;
+		m_sky_ubdata.prev_view_projection_matrix = m_prev_view_projection;
+		const u32* jitter = k_jitter_sequence[m_frame_index % 4];
+		m_sky_ubdata.jitter = Math::vec2(jitter[0], jitter[1]);
+		m_sky_ubdata.history_valid = m_temporal && m_history_valid ? 1.0f : 0.0f;
+		m_prev_view_projection = Math::inverse(inv_view_projection);
+		m_history_valid = m_temporal;
 		m_sky_ub->update(&m_sky_ubdata, sizeof(ScatteringUb));
 
 	}
 
 	void Atmosphere::UpdateDescriptorSets() noexcept
 	{
-		if (!precomputed)
-		{
-			// tramsmittance lut   
-			m_transmittance_lut_descriptor_set_update_desc.BindResource(0, transmittance_lut);
-			m_transmittance_lut_descriptor_set->UpdateDescriptorSet(m_transmittance_lut_descriptor_set_update_desc);
+		if (!precomputed || m_lut_update) {
+			UpdateLutDescriptorSets();
+		}
 
+		// per frame luts, from the luts the sky samples
 
-			// direct irradiance lut
-			m_direct_irradiance_lut_descriptor_set_update_desc.BindResource(0, transmittance_lut);
-			m_direct_irradiance_lut_descriptor_set_update_desc.BindResource(1, direct_irradiance_lut);
-			m_direct_irradiance_lut_descriptor_set_update_desc.BindResource(2, _irradiance_tex);
-			m_direct_irradiance_lut_descriptor_set->UpdateDescriptorSet(m_direct_irradiance_lut_descriptor_set_update_desc);
+		m_sky_view_lut_descriptor_set_update_desc.BindResource(0, m_sky_ub);
+		m_sky_view_lut_descriptor_set_update_desc.BindResource(1, transmittance_lut);
+		m_sky_view_lut_descriptor_set_update_desc.BindResource(2, _scattering_tex);
+		m_sky_view_lut_descriptor_set_update_desc.BindResource(3, sky_view_lut);
+		m_sky_view_lut_descriptor_set->UpdateDescriptorSet(m_sky_view_lut_descriptor_set_update_desc);
 
-			// single scattering lut 
+		m_camera_volume_descriptor_set_update_desc.BindResource(0, m_sky_ub);
+		m_camera_volume_descriptor_set_update_desc.BindResource(1, transmittance_lut);
+		m_camera_volume_descriptor_set_update_desc.BindResource(2, _scattering_tex);
+		m_camera_volume_descriptor_set_update_desc.BindResource(3, camera_volume);
+		m_camera_volume_descriptor_set->UpdateDescriptorSet(m_camera_volume_descriptor_set_update_desc);
 
-			//m_single_scattering_lut_ubdata.luminance_from_radiance = Math::mat3(1.0);
-			//m_single_scattering_lut_ubdata.layer = 0;
-			//m_single_scattering_lut_ub->update(&m_single_scattering_lut_ubdata,sizeof(m_single_scattering_lut_ubdata));
+		// render sky
 
-			m_single_scattering_lut_descriptor_set_update_desc.BindResource(0, transmittance_lut);
-			//m_single_scattering_lut_descriptor_set_update_desc.BindResource(1, m_single_scattering_lut_ub);
-			m_single_scattering_lut_descriptor_set_update_desc.BindResource(1, single_rayleigh_scattering_lut);
-			m_single_scattering_lut_descriptor_set_update_desc.BindResource(2, single_mie_scattering_lut);
-			m_single_scattering_lut_descriptor_set_update_desc.BindResource(3, _scattering_tex);
+		m_sky_descriptor_set_update_desc.BindResource(0, m_sky_ub);
+		m_sky_descriptor_set_update_desc.BindResource(1, transmittance_lut);
+		m_sky_descriptor_set_update_desc.BindResource(2, _scattering_tex);
+		m_sky_descriptor_set_update_desc.BindResource(7, sky_view_lut);
+		m_sky_descriptor_set_update_desc.BindResource(8, camera_volume);
+		if (NeedsUpsample()) {
+			m_sky_descriptor_set_update_desc.BindResource(5, std::static_pointer_cast<GraphicsPipeline>(GetScatteringPass())->GetFrameBufferAttachment(0));
+		}
+		if (m_temporal) {
+			// the history is not sampled before it is written, any texture in a readable layout stands in for it
+			if (m_sky_ubdata.history_valid != 0.0f) {
+				m_sky_descriptor_set_update_desc.BindResource(6, std::static_pointer_cast<GraphicsPipeline>(GetHistoryPass())->GetFrameBufferAttachment(0));
+			}
+			else {
+				m_sky_descriptor_set_update_desc.BindResource(6, transmittance_lut);
+			}
+		}
+		m_sky_descriptor_set->UpdateDescriptorSet(m_sky_descriptor_set_update_desc);
+	}
 
-			m_single_scattering_lut_descriptor_set->UpdateDescriptorSet(m_single_scattering_lut_descriptor_set_update_desc);
+	void Atmosphere::UpdateLutDescriptorSets() noexcept
+	{
+		auto luts = m_lut_update ? m_updated_luts : GetCachedLuts();
 
-			// SCATTERING DENSITY LUT
+		// tramsmittance lut   
+		m_transmittance_lut_descriptor_set_update_desc.BindResource(0, luts[0]);
+		m_transmittance_lut_descriptor_set->UpdateDescriptorSet(m_transmittance_lut_descriptor_set_update_desc);
 
-			m_scattering_density_lut_descriptor_set_update_desc.BindResource(0, transmittance_lut);
-			m_scattering_density_lut_descriptor_set_update_desc.BindResource(1, single_rayleigh_scattering_lut);
-			m_scattering_density_lut_descriptor_set_update_desc.BindResource(2, single_mie_scattering_lut);
-			m_scattering_density_lut_descriptor_set_update_desc.BindResource(3, multi_scattering_lut);
-			m_scattering_density_lut_descriptor_set_update_desc.BindResource(4, direct_irradiance_lut);
-			m_scattering_density_lut_descriptor_set_update_desc.BindResource(5, scattering_density_lut);
 
-			m_scattering_density_lut_descriptor_set->UpdateDescriptorSet(m_scattering_density_lut_descriptor_set_update_desc);
+		// direct irradiance lut
+		m_direct_irradiance_lut_descriptor_set_update_desc.BindResource(0, luts[0]);
+		m_direct_irradiance_lut_descriptor_set_update_desc.BindResource(1, direct_irradiance_lut);
+		m_direct_irradiance_lut_descriptor_set_update_desc.BindResource(2, luts[1]);
+		m_direct_irradiance_lut_descriptor_set->UpdateDescriptorSet(m_direct_irradiance_lut_descriptor_set_update_desc);
 
-			// indirect irradiance
+		// single scattering lut 
 
-			m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(0, single_rayleigh_scattering_lut);
-			m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(1, single_mie_scattering_lut);
-			m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(2, multi_scattering_lut);
-			m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(3, direct_irradiance_lut);
-			m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(4, _irradiance_tex);
+		//m_single_scattering_lut_ubdata.luminance_from_radiance = Math::mat3(1.0);
+		//m_single_scattering_lut_ubdata.layer = 0;
+		//m_single_scattering_lut_ub->update(&m_single_scattering_lut_ubdata,sizeof(m_single_scattering_lut_ubdata));
 
-			m_indirect_irradiance_lut_descriptor_set->UpdateDescriptorSet(m_indirect_irradiance_lut_descriptor_set_update_desc);
+		m_single_scattering_lut_descriptor_set_update_desc.BindResource(0, luts[0]);
+		//m_single_scattering_lut_descriptor_set_update_desc.BindResource(1, m_single_scattering_lut_ub);
+		m_single_scattering_lut_descriptor_set_update_desc.BindResource(1, single_rayleigh_scattering_lut);
+		m_single_scattering_lut_descriptor_set_update_desc.BindResource(2, single_mie_scattering_lut);
+		m_single_scattering_lut_descriptor_set_update_desc.BindResource(3, luts[2]);
 
-			// multi-scattering
+		m_single_scattering_lut_descriptor_set->UpdateDescriptorSet(m_single_scattering_lut_descriptor_set_update_desc);
 
-			m_multi_scattering_lut_descriptor_set_update_desc.BindResource(0, transmittance_lut);
-			m_multi_scattering_lut_descriptor_set_update_desc.BindResource(1, scattering_density_lut);
-			m_multi_scattering_lut_descriptor_set_update_desc.BindResource(2, single_rayleigh_scattering_lut);
-			m_multi_scattering_lut_descriptor_set_update_desc.BindResource(3, _scattering_tex);
+		// SCATTERING DENSITY LUT
 
-			m_multi_scattering_lut_descriptor_set->UpdateDescriptorSet(m_multi_scattering_lut_descriptor_set_update_desc);
+		m_scattering_density_lut_descriptor_set_update_desc.BindResource(0, luts[0]);
+		m_scattering_density_lut_descriptor_set_update_desc.BindResource(1, single_rayleigh_scattering_lut);
+		m_scattering_density_lut_descriptor_set_update_desc.BindResource(2, single_mie_scattering_lut);
+		m_scattering_density_lut_descriptor_set_update_desc.BindResource(3, multi_scattering_lut);
+		m_scattering_density_lut_descriptor_set_update_desc.BindResource(4, direct_irradiance_lut);
+		m_scattering_density_lut_descriptor_set_update_desc.BindResource(5, scattering_density_lut);
 
-		}
-		// render sky
+		m_scattering_density_lut_descriptor_set->UpdateDescriptorSet(m_scattering_density_lut_descriptor_set_update_desc);
 
-		m_sky_descriptor_set_update_desc.BindResource(0, m_sky_ub);
-		m_sky_descriptor_set_update_desc.BindResource(1, transmittance_lut);
-		m_sky_descriptor_set_update_desc.BindResource(2, _scattering_tex);
-		m_sky_descriptor_set->UpdateDescriptorSet(m_sky_descriptor_set_update_desc);
+		// indirect irradiance
+
+		m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(0, single_rayleigh_scattering_lut);
+		m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(1, single_mie_scattering_lut);
+		m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(2, multi_scattering_lut);
+		m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(3, direct_irradiance_lut);
+		m_indirect_irradiance_lut_descriptor_set_update_desc.BindResource(4, luts[1]);
+
+		m_indirect_irradiance_lut_descriptor_set->UpdateDescriptorSet(m_indirect_irradiance_lut_descriptor_set_update_desc);
+
+		// multi-scattering
+
+		m_multi_scattering_lut_descriptor_set_update_desc.BindResource(0, luts[0]);
+		m_multi_scattering_lut_descriptor_set_update_desc.BindResource(1, scattering_density_lut);
+		m_multi_scattering_lut_descriptor_set_update_desc.BindResource(2, single_rayleigh_scattering_lut);
+		m_multi_scattering_lut_descriptor_set_update_desc.BindResource(3, luts[2]);
+
+		m_multi_scattering_lut_descriptor_set->UpdateDescriptorSet(m_multi_scattering_lut_descriptor_set_update_desc);
 	}
 
 	void Atmosphere::BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept
@@ -211,6 +300,442 @@ namespace Horizon
 		return std::static_pointer_cast<GraphicsPipeline>(m_sky_pass)->GetFrameBufferAttachment(_index);
 	}
 
+	void Atmosphere::SetSkyQuality(SkyQuality quality) noexcept
+	{
+		if (quality != m_sky_quality) {
+			m_history_valid = false;
+		}
+		m_sky_quality = quality;
+		CreateScatteringPasses();
+	}
+
+	SkyQuality Atmosphere::GetSkyQuality() const noexcept
+	{
+		return m_sky_quality;
+	}
+
+	void Atmosphere::SetTemporal(bool enable) noexcept
+	{
+		if (enable != m_temporal) {
+			m_history_valid = false;
+		}
+		m_temporal = enable;
+		CreateScatteringPasses();
+	}
+
+	bool Atmosphere::IsTemporal() const noexcept
+	{
+		return m_temporal;
+	}
+
+	bool Atmosphere::NeedsUpsample() const noexcept
+	{
+		return m_temporal || m_sky_quality != SkyQuality::FULL;
+	}
+
+	std::shared_ptr<Pipeline> Atmosphere::GetScatteringPass() const noexcept
+	{
+		u32 quality = static_cast<u32>(m_sky_quality);
+		if (m_temporal) {
+			return m_sky_history_passes[quality][m_frame_index % 2];
+		}
+		return m_sky_quality == SkyQuality::FULL ? m_sky_pass : m_low_resolution_sky_passes[quality];
+	}
+
+	std::shared_ptr<Pipeline> Atmosphere::GetHistoryPass() const noexcept
+	{
+		return m_sky_history_passes[static_cast<u32>(m_sky_quality)][(m_frame_index + 1) % 2];
+	}
+
+	u32 Atmosphere::GetSkyDownsample(SkyQuality quality) noexcept
+	{
+		switch (quality)
+		{
+		case SkyQuality::HALF:
+			return 2;
+		case SkyQuality::QUARTER:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	void Atmosphere::CreateScatteringPasses() noexcept
+	{
+		const char* names[] = { "full", "half", "quarter" };
+		u32 quality = static_cast<u32>(m_sky_quality);
+		if (m_temporal) {
+			for (u32 i = 0; i < 2; i++) {
+				if (!m_sky_history_passes[quality][i]) {
+					m_sky_history_passes[quality][i] = CreateScatteringPass(std::string("scatter_temporal_") + names[quality] + "_" + std::to_string(i), "scatter_temporal", m_sky_quality);
+				}
+			}
+		}
+		else if (m_sky_quality != SkyQuality::FULL && !m_low_resolution_sky_passes[quality]) {
+			m_low_resolution_sky_passes[quality] = CreateScatteringPass(std::string("scatter_") + names[quality], "scatter_low", m_sky_quality);
+		}
+	}
+
+	std::shared_ptr<Pipeline> Atmosphere::CreateScatteringPass(const std::string& name, const std::string& shader, SkyQuality quality) noexcept
+	{
+		// the viewport of a pipeline comes from its render context, shrink it to the target
+		u32 downsample = GetSkyDownsample(quality);
+		RenderContext low_resolution_context = m_render_context;
+		low_resolution_context.width = (m_render_context.width + downsample - 1) / downsample;
+		low_resolution_context.height = (m_render_context.height + downsample - 1) / downsample;
+
+		GraphicsPipelineCreateInfo low_resolution_pipeline_create_info;
+		low_resolution_pipeline_create_info.name = name;
+		low_resolution_pipeline_create_info.vs = std::make_shared<Shader>(m_device->Get(), Path::GetInstance().GetShaderPath("atmosphere/scatter.vert.spv"));
+		low_resolution_pipeline_create_info.ps = std::make_shared<Shader>(m_device->Get(), GetLutShaderPath(m_lut_desc, shader, "frag"));
+		low_resolution_pipeline_create_info.descriptor_layouts = sky_descriptor_set_layout;
+		low_resolution_pipeline_create_info.dynamic_resolution = true;
+
+		// in scattered luminance only, the upsample adds it to the lighting
+		std::vector<AttachmentCreateInfo> low_resolution_attachments_create_info{
+			{TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, low_resolution_context.width, low_resolution_context.height, 1}
+		};
+
+		return m_pipeline_manager->CreateGraphicsPipeline(low_resolution_pipeline_create_info, low_resolution_attachments_create_info, low_resolution_context);
+	}
+
+	void Atmosphere::PrecomputeLuts(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		m_lut_push_constants.haze = m_haze;
+		RecordLutSlices(_i, _command_buffer, 0, GetLutSliceCount());
+		precomputed = true;
+		m_lut_cache_pending = true;
+		m_precompute_image = _i;
+	}
+
+	void Atmosphere::ComputeSkyLuts(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		_command_buffer->Dispatch(_i, m_sky_view_lut_pass, { m_sky_view_lut_descriptor_set });
+		_command_buffer->Dispatch(_i, m_camera_volume_pass, { m_camera_volume_descriptor_set });
+	}
+
+	void Atmosphere::SetHaze(f32 haze) noexcept
+	{
+		// the first precompute uses it
+		if (!precomputed) {
+			m_haze = haze;
+			return;
+		}
+		if (haze == (m_lut_update ? m_update_haze : m_haze)) {
+			return;
+		}
+		// a change during an update starts it over, a change back to the sampled luts drops it
+		m_lut_update = haze != m_haze;
+		m_update_haze = haze;
+		m_lut_update_slice = 0;
+		m_lut_update_slices_recorded = 0;
+		if (m_lut_update && !m_updated_luts[0]) {
+			auto luts = GetCachedLuts();
+			for (u32 i = 0; i < luts.size(); i++) {
+				VkExtent3D extent = luts[i]->GetExtent();
+				TextureType type = extent.depth > 1 ? TextureType::TEXTURE_TYPE_3D : TextureType::TEXTURE_TYPE_2D;
+				TextureFormat format = i == 0 ? TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT : GetLutFormat();
+				m_updated_luts[i] = std::make_shared<Texture>(m_device, m_command_buffer, TextureCreateInfo{ type, format, TextureUsage::TEXTURE_USAGE_RW, extent.width, extent.height, extent.depth, 1, true });
+			}
+		}
+	}
+
+	f32 Atmosphere::GetHaze() const noexcept
+	{
+		return m_haze;
+	}
+
+	void Atmosphere::SetLutUpdateBudget(u32 slices_per_frame) noexcept
+	{
+		m_lut_update_budget = std::max(slices_per_frame, 1u);
+	}
+
+	u32 Atmosphere::GetLutUpdateBudget() const noexcept
+	{
+		return m_lut_update_budget;
+	}
+
+	bool Atmosphere::IsUpdatingLuts() const noexcept
+	{
+		return m_lut_update;
+	}
+
+	std::array<std::shared_ptr<Texture>, 3> Atmosphere::GetUpdatedLuts() const noexcept
+	{
+		return m_updated_luts;
+	}
+
+	void Atmosphere::UpdateLuts(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		if (!m_lut_update) {
+			return;
+		}
+		m_lut_update_slices_recorded = std::min(m_lut_update_budget, GetLutSliceCount() - m_lut_update_slice);
+		m_lut_push_constants.haze = m_update_haze;
+		RecordLutSlices(_i, _command_buffer, m_lut_update_slice, m_lut_update_slices_recorded);
+	}
+
+	u32 Atmosphere::AdvanceLutUpdate() noexcept
+	{
+		u32 slices = m_lut_update_slices_recorded;
+		m_lut_update_slices_recorded = 0;
+		if (!m_lut_update || slices == 0) {
+			return 0;
+		}
+		m_lut_update_slice += slices;
+		if (m_lut_update_slice == GetLutSliceCount()) {
+			// the sky samples the new set from the next frame on, the previous one takes the next update
+			std::swap(transmittance_lut, m_updated_luts[0]);
+			std::swap(_irradiance_tex, m_updated_luts[1]);
+			std::swap(_scattering_tex, m_updated_luts[2]);
+			m_haze = m_update_haze;
+			m_lut_update = false;
+			LOG_INFO("updated the atmosphere luts for haze " + std::to_string(m_haze));
+		}
+		return slices;
+	}
+
+	std::vector<Atmosphere::LutStep> Atmosphere::GetLutSteps() const noexcept
+	{
+		u32 depth = _scattering_tex->GetExtent().depth;
+		std::vector<LutStep> steps{
+			{ m_transmittance_lut_pass, m_transmittance_lut_descriptor_set, 0, 1 },
+			{ m_direct_irradiance_lut_pass, m_direct_irradiance_lut_descriptor_set, 0, 1 },
+			{ m_single_scattering_lut_pass, m_single_scattering_lut_descriptor_set, 0, depth }
+		};
+		// the density of order j + 2 and the irradiance of order j + 1 both come from the scattering of order j + 1
+		for (u32 j = 0; j < m_multi_scattering_order; j++) {
+			steps.push_back({ m_scattering_density_lut, m_scattering_density_lut_descriptor_set, static_cast<i32>(j + 2), depth });
+			steps.push_back({ m_indirect_irradiance_lut, m_indirect_irradiance_lut_descriptor_set, static_cast<i32>(j + 1), 1 });
+			steps.push_back({ m_multi_scattering_lut, m_multi_scattering_lut_descriptor_set, static_cast<i32>(j + 2), depth });
+		}
+		return steps;
+	}
+
+	u32 Atmosphere::GetLutSliceCount() const noexcept
+	{
+		u32 count = 0;
+		for (auto& step : GetLutSteps()) {
+			count += (step.depth + k_lut_slice_layers - 1) / k_lut_slice_layers;
+		}
+		return count;
+	}
+
+	void Atmosphere::RecordLutSlices(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, u32 first_slice, u32 slice_count) noexcept
+	{
+		// every lut stays in the general layout, a memory barrier orders the dispatches and covers the sky sampling them.
+		// on the compute queue the semaphore the frame waits on covers the sky
+		BarrierDesc barrier;
+		barrier.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		barrier.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		if (_command_buffer->GetQueue() == CommandQueue::GRAPHICS) {
+			barrier.dst_stage |= PipelineStageFlags::PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		}
+		barrier.memory_barriers.push_back(MemoryBarrierDesc{ MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT, static_cast<MemoryAccessFlags>(MemoryAccessFlags::ACCESS_SHADER_READ_BIT | MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT) });
+
+		// after the slices of the last frame
+		InsertBarrier(_i, _command_buffer, barrier);
+
+		u32 last_slice = first_slice + slice_count;
+		u32 slice = 0;
+		for (auto& step : GetLutSteps()) {
+			if (slice >= last_slice) {
+				break;
+			}
+			std::shared_ptr<ComputePipeline> pipeline = std::static_pointer_cast<ComputePipeline>(step.pipeline);
+			u32 layers = std::min(step.depth, k_lut_slice_layers);
+			u32 group_count_z = pipeline->GroupCountZ() * layers / step.depth;
+			bool recorded = false;
+			for (u32 layer = 0; layer < step.depth; layer += layers, slice++) {
+				if (slice < first_slice || slice >= last_slice) {
+					continue;
+				}
+				m_lut_push_constants.scattering_order = step.scattering_order;
+				m_lut_push_constants.layer_offset = static_cast<i32>(layer);
+				_command_buffer->Dispatch(_i, step.pipeline, { step.descriptor_set }, pipeline->GroupCountX(), pipeline->GroupCountY(), group_count_z);
+				recorded = true;
+			}
+			// the next step reads the whole lut
+			if (recorded && slice <= last_slice) {
+				InsertBarrier(_i, _command_buffer, barrier);
+			}
+		}
+	}
+
+	std::array<std::shared_ptr<Texture>, 3> Atmosphere::GetCachedLuts() const noexcept
+	{
+		return { transmittance_lut, _irradiance_tex, _scattering_tex };
+	}
+
+	u64 Atmosphere::GetLutCacheKey(const AtmosphereLutDesc& desc, u32 multi_scattering_order, f32 haze) noexcept
+	{
+		// fnv-1a over everything the luts depend on, the atmosphere parameters are constants of the compute shaders
+		u64 hash = 14695981039346656037ull;
+		auto combine = [&hash](const void* data, size_t size) {
+			const u8* bytes = static_cast<const u8*>(data);
+			for (size_t i = 0; i < size; i++) {
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+		};
+
+		u32 sizes[] = {
+			desc.transmittance_width, desc.transmittance_height, desc.irradiance_width, desc.irradiance_height,
+			desc.scattering_r_size, desc.scattering_mu_size, desc.scattering_mu_s_size, desc.scattering_nu_size, desc.half_precision
+		};
+		combine(sizes, sizeof(sizes));
+		combine(&multi_scattering_order, sizeof(multi_scattering_order));
+		combine(&haze, sizeof(haze));
+
+		const char* shaders[] = {
+			"transmittance_lut",
+			"direct_irradiance_lut",
+			"single_scattering_lut",
+			"scattering_density",
+			"indirect_irradiance_lut",
+			"multi_scattering_lut"
+		};
+		for (const char* shader : shaders) {
+			std::ifstream file(GetLutShaderPath(desc, shader, "comp"), std::ios::binary);
+			std::vector<char> code((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			combine(code.data(), code.size());
+		}
+		return hash;
+	}
+
+	bool Atmosphere::LoadLutCache() noexcept
+	{
+		std::ifstream file(Path::GetInstance().GetCachePath("atmosphere_luts.bin"), std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		u32 magic = 0, version = 0;
+		u64 key = 0;
+		file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		file.read(reinterpret_cast<char*>(&key), sizeof(key));
+		if (!file || magic != k_lut_cache_magic || version != k_lut_cache_version || key != GetLutCacheKey(m_lut_desc, m_multi_scattering_order, m_haze)) {
+			LOG_INFO("atmosphere lut cache is out of date, precomputing");
+			return false;
+		}
+
+		// read everything before uploading, a truncated file leaves the luts untouched
+		std::array<std::vector<u8>, 3> data;
+		auto luts = GetCachedLuts();
+		for (u32 i = 0; i < luts.size(); i++) {
+			data[i].resize(luts[i]->GetDataSize());
+			file.read(reinterpret_cast<char*>(data[i].data()), data[i].size());
+		}
+		if (!file) {
+			LOG_WARN("atmosphere lut cache is truncated, precomputing");
+			return false;
+		}
+		for (u32 i = 0; i < luts.size(); i++) {
+			luts[i]->Upload(data[i]);
+		}
+		precomputed = true;
+		LOG_INFO("loaded atmosphere luts from the cache");
+		return true;
+	}
+
+	void Atmosphere::SaveLutCache(u32 _submitted_image) noexcept
+	{
+		if (!m_lut_cache_pending || _submitted_image != m_precompute_image) {
+			return;
+		}
+		m_lut_cache_pending = false;
+
+		std::array<std::vector<u8>, 3> data;
+		auto luts = GetCachedLuts();
+		for (u32 i = 0; i < luts.size(); i++) {
+			luts[i]->ReadBack(data[i]);
+		}
+		WriteLutCache(GetLutCacheKey(m_lut_desc, m_multi_scattering_order, m_haze), data);
+	}
+
+	bool Atmosphere::WriteLutCache(u64 key, const std::array<std::vector<u8>, 3>& data) noexcept
+	{
+		std::ofstream file(Path::GetInstance().GetCachePath("atmosphere_luts.bin"), std::ios::binary | std::ios::trunc);
+		if (!file) {
+			LOG_WARN("failed to open the atmosphere lut cache for writing");
+			return false;
+		}
+		u32 magic = k_lut_cache_magic, version = k_lut_cache_version;
+		file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+		file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+		for (auto& lut_data : data) {
+			file.write(reinterpret_cast<const char*>(lut_data.data()), lut_data.size());
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool Atmosphere::BakeLutCache(u32 multi_scattering_order, u32 thread_count, AtmosphereLutQuality quality) noexcept
+	{
+		AtmosphereCpuPrecompute precompute(thread_count);
+		precompute.Precompute(multi_scattering_order, 1.0f, quality);
+		LOG_INFO("baked the atmosphere luts on " + std::to_string(precompute.GetThreadCount()) + " threads in " + std::to_string(precompute.GetTime()) + " ms");
+
+		const AtmosphereCpuPrecompute::Lut* luts[] = { &precompute.GetTransmittanceLut(), &precompute.GetIrradianceLut(), &precompute.GetScatteringLut() };
+		std::array<std::vector<u8>, 3> data;
+		for (u32 i = 0; i < 3; i++) {
+			data[i] = luts[i]->GetData();
+		}
+		return WriteLutCache(GetLutCacheKey(AtmosphereLutDesc::Get(quality), multi_scattering_order, 1.0f), data);
+	}
+
+	void Atmosphere::MeasureLutQualities(u32 multi_scattering_order, u32 thread_count) noexcept
+	{
+		const char* names[] = { "high", "medium", "low" };
+		const char* lut_names[] = { "transmittance", "irradiance", "scattering" };
+		AtmosphereCpuPrecompute reference(thread_count);
+		reference.Precompute(multi_scattering_order);
+		LOG_INFO("high atmosphere luts: " + std::to_string(AtmosphereLutDesc::Get(AtmosphereLutQuality::HIGH).GetMemorySize() >> 10) + " KiB");
+
+		for (auto quality : { AtmosphereLutQuality::MEDIUM, AtmosphereLutQuality::LOW }) {
+			AtmosphereCpuPrecompute precompute(thread_count);
+			precompute.Precompute(multi_scattering_order, 1.0f, quality);
+			std::string message = std::string(names[static_cast<u32>(quality)]) + " atmosphere luts: " + std::to_string(AtmosphereLutDesc::Get(quality).GetMemorySize() >> 10) + " KiB";
+			auto errors = AtmosphereCpuPrecompute::CompareQuality(reference, precompute);
+			for (u32 i = 0; i < errors.size(); i++) {
+				message += ", " + std::string(lut_names[i]) + " error " + std::to_string(errors[i].max_error * 100.0f) + "% max " + std::to_string(errors[i].mean_error * 100.0f) + "% mean";
+			}
+			LOG_INFO(message);
+		}
+	}
+
+	AtmosphereLutQuality Atmosphere::GetLutQuality() const noexcept
+	{
+		return m_lut_quality;
+	}
+
+	TextureFormat Atmosphere::GetLutFormat() const noexcept
+	{
+		return m_lut_desc.half_precision ? TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT : TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT;
+	}
+
+	std::string Atmosphere::GetLutShaderPath(const AtmosphereLutDesc& desc, const std::string& shader, const std::string& stage) noexcept
+	{
+		return Path::GetInstance().GetShaderPath("atmosphere/" + shader + desc.shader_suffix + "." + stage + ".spv");
+	}
+
+	void Atmosphere::ValidateLuts(const AtmosphereCpuPrecompute& reference) noexcept
+	{
+		if (!precomputed) {
+			LOG_WARN("the atmosphere luts are not precomputed yet");
+			return;
+		}
+		const char* names[] = { "transmittance", "irradiance", "scattering" };
+		const AtmosphereCpuPrecompute::Lut* reference_luts[] = { &reference.GetTransmittanceLut(), &reference.GetIrradianceLut(), &reference.GetScatteringLut() };
+		auto luts = GetCachedLuts();
+		std::vector<u8> data;
+		for (u32 i = 0; i < luts.size(); i++) {
+			luts[i]->ReadBack(data);
+			f32 error = AtmosphereCpuPrecompute::Compare(*reference_luts[i], data);
+			LOG_INFO(std::string(names[i]) + " lut differs from the cpu reference by up to " + std::to_string(error * 100.0f) + "% of its largest value");
+		}
+	}
+
 	void Atmosphere::CreateResources(std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> command_buffer) noexcept
 	{
 
@@ -294,19 +819,31 @@ namespace Horizon
 		multi_scattering_lut_descriptor_set_layouts = std::make_shared<DescriptorSetLayouts>();
 		multi_scattering_lut_descriptor_set_layouts->layouts.push_back(m_multi_scattering_lut_descriptor_set->GetLayout());
 
-		//// camera volume
+		// sky view lut
+
+		std::shared_ptr<DescriptorSetInfo> sky_view_lut_descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		sky_view_lut_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // camera pos, inv vp
+		sky_view_lut_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // transmittance
+		sky_view_lut_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // scattering
+		sky_view_lut_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // sky view
+
+		m_sky_view_lut_descriptor_set = std::make_shared<DescriptorSet>(_device, sky_view_lut_descriptor_set_create_info);
+
+		sky_view_lut_descriptor_set_layouts = std::make_shared<DescriptorSetLayouts>();
+		sky_view_lut_descriptor_set_layouts->layouts.push_back(m_sky_view_lut_descriptor_set->GetLayout());
+
+		// camera volume
 
-		//std::shared_ptr<DescriptorSetInfo> camera_volume_descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
-		//camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // camera pos, inv vp, resolution
-		//camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // transmittion
-		//camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // scattering
-		//camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // scatter
-		//camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // t
+		std::shared_ptr<DescriptorSetInfo> camera_volume_descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // camera pos, inv vp
+		camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // transmittance
+		camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // scattering
+		camera_volume_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // in-scattering and transmittance
 
-		//m_camera_volume_descriptor_set = std::make_shared<DescriptorSet>(_device, camera_volume_descriptor_set_create_info);
+		m_camera_volume_descriptor_set = std::make_shared<DescriptorSet>(_device, camera_volume_descriptor_set_create_info);
 
-		//camera_volume_descriptor_set_layouts = std::make_shared<DescriptorSetLayouts>();
-		//camera_volume_descriptor_set_layouts->layouts.push_back(m_camera_volume_descriptor_set->GetLayout());
+		camera_volume_descriptor_set_layouts = std::make_shared<DescriptorSetLayouts>();
+		camera_volume_descriptor_set_layouts->layouts.push_back(m_camera_volume_descriptor_set->GetLayout());
 
 		// sky pass
 
@@ -316,6 +853,10 @@ namespace Horizon
 		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // scattering
 		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // geometry
 		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // depth
+		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // reduced resolution scattering
+		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // scattering history
+		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // sky view
+		scatter_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER); // camera volume
 
 		m_sky_descriptor_set = std::make_shared<DescriptorSet>(_device, scatter_descriptor_set_create_info);
 
@@ -325,20 +866,23 @@ namespace Horizon
 
 		// textures and uniform buffers
 
-		transmittance_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 256, 64, 1 });
-		direct_irradiance_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 64, 16, 1 });
-		_irradiance_tex = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 64, 16, 1 });
-		single_rayleigh_scattering_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 256, 128, 32 });
-		single_mie_scattering_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 256, 128, 32 });
-		_scattering_tex = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 256, 128, 32 });
-		scattering_density_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 256, 128, 32 });
+		TextureFormat lut_format = GetLutFormat();
+		u32 scattering_width = m_lut_desc.GetScatteringWidth(), scattering_height = m_lut_desc.scattering_mu_size, scattering_depth = m_lut_desc.scattering_r_size;
+		transmittance_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, m_lut_desc.transmittance_width, m_lut_desc.transmittance_height, 1, 1, true });
+		direct_irradiance_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,lut_format,TextureUsage::TEXTURE_USAGE_RW, m_lut_desc.irradiance_width, m_lut_desc.irradiance_height, 1, 1, true });
+		_irradiance_tex = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,lut_format,TextureUsage::TEXTURE_USAGE_RW, m_lut_desc.irradiance_width, m_lut_desc.irradiance_height, 1, 1, true });
+		single_rayleigh_scattering_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,lut_format,TextureUsage::TEXTURE_USAGE_RW, scattering_width, scattering_height, scattering_depth, 1, true });
+		single_mie_scattering_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,lut_format,TextureUsage::TEXTURE_USAGE_RW, scattering_width, scattering_height, scattering_depth, 1, true });
+		_scattering_tex = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,lut_format,TextureUsage::TEXTURE_USAGE_RW, scattering_width, scattering_height, scattering_depth, 1, true });
+		scattering_density_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,lut_format,TextureUsage::TEXTURE_USAGE_RW, scattering_width, scattering_height, scattering_depth, 1, true });
 		multi_scattering_lut = single_rayleigh_scattering_lut;
 
-		//scatter_transfer_t = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 32, 32, 32 });
-		//out_transmittance = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, 32, 32, 32 });
+		sky_view_lut = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_2D,TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, k_sky_view_lut_width, k_sky_view_lut_height, 1, 1, true });
+		camera_volume = std::make_shared<Texture>(_device, command_buffer, TextureCreateInfo{ TextureType::TEXTURE_TYPE_3D,TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT,TextureUsage::TEXTURE_USAGE_RW, k_camera_volume_size, k_camera_volume_size, k_camera_volume_size, 1, true });
 
-		scattering_order_push_constants = std::make_shared<PushConstants>();
-		scattering_order_push_constants->ranges = { {SHADER_STAGE_COMPUTE_SHADER, 0, 2 * sizeof(Math::mat4)} }; // Push constants have a minimum size of 128 bytes
+		// shared by every pass of the chain, the values are copied when a dispatch is recorded
+		lut_push_constants = std::make_shared<PushConstants>();
+		lut_push_constants->ranges = { {SHADER_STAGE_COMPUTE_SHADER, 0, sizeof(LutPushConstants), &m_lut_push_constants} };
 
 
 	}
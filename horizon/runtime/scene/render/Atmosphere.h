@@ -5,10 +5,21 @@
 #include <runtime/function/rhi/vulkan/UniformBuffer.h>
 #include <runtime/function/rhi/vulkan/Texture.h>
 #include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/scene/render/AtmosphereCpuPrecompute.h>
+#include <array>
 #include <memory>
+#include <vector>
 
 namespace Horizon
 {
+	// resolution the scattering is evaluated at, reduced levels are composited by a depth aware upsample
+	enum class SkyQuality
+	{
+		FULL,
+		HALF,
+		QUARTER
+	};
+
 	class Atmosphere
 	{
 	public:
@@ -16,22 +27,155 @@ namespace Horizon
 			std::shared_ptr<PipelineManager> _pipeline_manager,
 			std::shared_ptr<Device> _device,
 			std::shared_ptr<CommandBuffer> command_buffer,
-			RenderContext& _render_context) noexcept;
+			RenderContext& _render_context,
+			AtmosphereLutQuality lut_quality = AtmosphereLutQuality::HIGH) noexcept;
 		~Atmosphere() noexcept;
 		void SetCameraParams(Math::mat4 inv_view_projection, Math::vec3 camera_pos) noexcept;
 		void UpdateDescriptorSets() noexcept;
 		void BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept;
 		std::shared_ptr<AttachmentDescriptor> GetFrameBufferAttachment(u32 _index) const noexcept;
+		// creates the reduced resolution target on first use, takes effect on the next UpdateDescriptorSets
+		void SetSkyQuality(SkyQuality quality) noexcept;
+		SkyQuality GetSkyQuality() const noexcept;
+		// evaluate a quarter of the scattering pixels each frame and reproject the others from the last frame
+		void SetTemporal(bool enable) noexcept;
+		bool IsTemporal() const noexcept;
+		// the scattering pass writes the scattered luminance only and m_sky_upsample_pass adds it to the lighting
+		bool NeedsUpsample() const noexcept;
+		// pipeline of the scattering pass, m_sky_pass itself at full quality without temporal reprojection
+		std::shared_ptr<Pipeline> GetScatteringPass() const noexcept;
+		// history target the temporal scattering pass reprojects from, written by the last frame
+		std::shared_ptr<Pipeline> GetHistoryPass() const noexcept;
+		// record the lut dispatches with the barriers between scattering orders, sets precomputed
+		void PrecomputeLuts(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+		// per frame sky view lut and aerial perspective volume around the camera, the scattering pass samples them
+		// instead of the 4d scattering lut
+		void ComputeSkyLuts(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+		// scale of the mie scattering. once precomputed a change rebuilds the luts into a second set a few slices per
+		// frame, the sky samples the previous luts until the new set is complete
+		void SetHaze(f32 haze) noexcept;
+		// haze of the luts the sky samples, trails SetHaze until an update completes
+		f32 GetHaze() const noexcept;
+		// slices of the lut chain an update records per frame
+		void SetLutUpdateBudget(u32 slices_per_frame) noexcept;
+		u32 GetLutUpdateBudget() const noexcept;
+		bool IsUpdatingLuts() const noexcept;
+		// luts an update writes, imported into the render graph while updating
+		std::array<std::shared_ptr<Texture>, 3> GetUpdatedLuts() const noexcept;
+		// records the next slices of the update, the same ones into every command buffer of the frame
+		void UpdateLuts(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+		// moves the update past the slices of the submitted frame and swaps in the new luts once they are all done,
+		// returns the number of slices the frame computed
+		u32 AdvanceLutUpdate() noexcept;
+		// writes the precomputed luts to the cache once the command buffer that computed them has finished
+		void SaveLutCache(u32 _submitted_image) noexcept;
+		// computes the luts on the cpu and writes the cache the next launch loads, needs no gpu
+		static bool BakeLutCache(u32 multi_scattering_order, u32 thread_count = 0, AtmosphereLutQuality quality = AtmosphereLutQuality::HIGH) noexcept;
+		// computes every preset on the cpu and logs its memory and its error against HIGH, needs no gpu
+		static void MeasureLutQualities(u32 multi_scattering_order, u32 thread_count = 0) noexcept;
+		// fixed at construction, the shaders and the lut sizes follow it
+		AtmosphereLutQuality GetLutQuality() const noexcept;
+		// reads back the luts once precomputed and logs how far they are from the cpu reference
+		void ValidateLuts(const AtmosphereCpuPrecompute& reference) noexcept;
 
 	private:
 		void CreateResources(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer) noexcept;
+		static u32 GetSkyDownsample(SkyQuality quality) noexcept;
+		// creates the scattering targets the current quality and temporal setting need
+		void CreateScatteringPasses() noexcept;
+		std::shared_ptr<Pipeline> CreateScatteringPass(const std::string& name, const std::string& shader, SkyQuality quality) noexcept;
+		// luts the sky samples, the only ones kept in the cache
+		std::array<std::shared_ptr<Texture>, 3> GetCachedLuts() const noexcept;
+		static u64 GetLutCacheKey(const AtmosphereLutDesc& desc, u32 multi_scattering_order, f32 haze) noexcept;
+		// of the irradiance and scattering luts
+		TextureFormat GetLutFormat() const noexcept;
+		// "atmosphere/<shader><preset suffix>.<stage>.spv", the variant compileshaders.py builds for the preset
+		static std::string GetLutShaderPath(const AtmosphereLutDesc& desc, const std::string& shader, const std::string& stage) noexcept;
+		// lut data in the order of GetCachedLuts
+		static bool WriteLutCache(u64 key, const std::array<std::vector<u8>, 3>& data) noexcept;
+		// uploads the cached luts and sets precomputed, false if there is no cache for the current key
+		bool LoadLutCache() noexcept;
+		// binds the luts the chain writes, the sampled ones before the first precompute and the second set during an update
+		void UpdateLutDescriptorSets() noexcept;
+		// the chain in slices, a 2d lut is one slice and a 3d lut k_lut_slice_layers layers per slice
+		u32 GetLutSliceCount() const noexcept;
+		// records slices [first_slice, first_slice + slice_count), with a barrier before them and after every finished dispatch
+		void RecordLutSlices(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, u32 first_slice, u32 slice_count) noexcept;
+
+		static constexpr u32 k_lut_cache_magic = 0x54554c48; // "HLUT"
+		static constexpr u32 k_lut_cache_version = 1;
+
+		// layers of a 3d lut dispatched per slice, a multiple of the local size of the 3d lut shaders
+		static constexpr u32 k_lut_slice_layers = 4;
+		static constexpr u32 k_default_lut_update_budget = 4;
+
+		// sizes of the per frame luts, the depth of the volume covers k_camera_volume_distance of sky_view.glsl
+		static constexpr u32 k_sky_view_lut_width = 192;
+		static constexpr u32 k_sky_view_lut_height = 108;
+		static constexpr u32 k_camera_volume_size = 32;
+
+		// PerDispatch of precompute.glsl
+		struct LutPushConstants
+		{
+			i32 scattering_order;
+			i32 layer_offset;
+			f32 haze;
+		};
+
+		// one dispatch of the chain
+		struct LutStep
+		{
+			std::shared_ptr<Pipeline> pipeline;
+			std::shared_ptr<DescriptorSet> descriptor_set;
+			i32 scattering_order;
+			// 1 for the 2d luts
+			u32 depth;
+		};
+		std::vector<LutStep> GetLutSteps() const noexcept;
+
+		// pixel of each 2x2 block evaluated in a frame, every pixel is evaluated once in four frames
+		static constexpr u32 k_jitter_sequence[4][2] = { { 0, 0 }, { 1, 1 }, { 1, 0 }, { 0, 1 } };
+
+		RenderContext& m_render_context;
+		std::shared_ptr<PipelineManager> m_pipeline_manager;
+		std::shared_ptr<Device> m_device;
+		SkyQuality m_sky_quality = SkyQuality::FULL;
+		AtmosphereLutQuality m_lut_quality;
+		AtmosphereLutDesc m_lut_desc;
+		// reduced resolution scattering targets by quality, nullptr until first used
+		std::array<std::shared_ptr<Pipeline>, 3> m_low_resolution_sky_passes{};
+		// ping pong history targets by quality, written on alternate frames
+		std::array<std::array<std::shared_ptr<Pipeline>, 2>, 3> m_sky_history_passes{};
+		bool m_temporal = false;
+		// the history holds the last frame at the current quality and render area
+		bool m_history_valid = false;
+		u32 m_frame_index = 0;
+		Math::mat4 m_prev_view_projection = Math::mat4(1.0f);
+		// the luts were computed on the gpu and are not in the cache yet
+		bool m_lut_cache_pending = false;
+		u32 m_precompute_image = 0;
+		std::shared_ptr<CommandBuffer> m_command_buffer;
+		LutPushConstants m_lut_push_constants{};
+		f32 m_haze = 1.0f;
+		// haze of the update in flight
+		f32 m_update_haze = 1.0f;
+		bool m_lut_update = false;
+		u32 m_lut_update_slice = 0;
+		// slices recorded in the frame being submitted
+		u32 m_lut_update_slices_recorded = 0;
+		u32 m_lut_update_budget = k_default_lut_update_budget;
+		// the second set of the luts in GetCachedLuts, created by the first update
+		std::array<std::shared_ptr<Texture>, 3> m_updated_luts{};
 	public:
+		// adds the reduced resolution scattering to the lighting, writes the m_sky_pass framebuffer
+		std::shared_ptr<Pipeline> m_sky_upsample_pass;
 		std::shared_ptr<Pipeline> m_sky_pass, m_transmittance_lut_pass,
 			m_direct_irradiance_lut_pass,
 			m_single_scattering_lut_pass,
 			m_scattering_density_lut,
 			m_indirect_irradiance_lut,
 			m_multi_scattering_lut,
+			m_sky_view_lut_pass,
 			m_camera_volume_pass;
 		std::shared_ptr<DescriptorSet> m_sky_descriptor_set,
 			m_transmittance_lut_descriptor_set,
@@ -40,12 +184,12 @@ namespace Horizon
 			m_scattering_density_lut_descriptor_set,
 			m_indirect_irradiance_lut_descriptor_set,
 			m_multi_scattering_lut_descriptor_set,
+			m_sky_view_lut_descriptor_set,
 			m_camera_volume_descriptor_set;
-		u32 m_multi_scattering_order = 3;
-
-		std::shared_ptr<PushConstants> scattering_order_push_constants;
+		static constexpr u32 k_multi_scattering_order = 3;
+		u32 m_multi_scattering_order = k_multi_scattering_order;
 
-		std::array<i32, 4> layers = {1, 2, 3, 4 };
+		std::shared_ptr<PushConstants> lut_push_constants;
 	private:
 		std::shared_ptr<DescriptorSetLayouts> transmittance_lut_descriptor_set_layouts;
 		std::shared_ptr<DescriptorSetLayouts> direct_irradiance_lut_descriptor_set_layouts;
@@ -53,6 +197,7 @@ namespace Horizon
 		std::shared_ptr<DescriptorSetLayouts> scattering_density_lut_descriptor_set_layouts;
 		std::shared_ptr<DescriptorSetLayouts> indirect_irradiance_lut_descriptor_set_layouts;
 		std::shared_ptr<DescriptorSetLayouts> multi_scattering_lut_descriptor_set_layouts;
+		std::shared_ptr<DescriptorSetLayouts> sky_view_lut_descriptor_set_layouts;
 		std::shared_ptr<DescriptorSetLayouts> camera_volume_descriptor_set_layouts;
 		std::shared_ptr<DescriptorSetLayouts> sky_descriptor_set_layout;
 
@@ -63,6 +208,7 @@ namespace Horizon
 		DescriptorSetUpdateDesc m_scattering_density_lut_descriptor_set_update_desc;
 		DescriptorSetUpdateDesc m_indirect_irradiance_lut_descriptor_set_update_desc;
 		DescriptorSetUpdateDesc m_multi_scattering_lut_descriptor_set_update_desc;
+		DescriptorSetUpdateDesc m_sky_view_lut_descriptor_set_update_desc;
 		DescriptorSetUpdateDesc m_camera_volume_descriptor_set_update_desc;
 
 	public:
@@ -76,8 +222,10 @@ namespace Horizon
 		std::shared_ptr<Texture> scattering_density_lut;
 		std::shared_ptr<Texture> multi_scattering_lut;
 
-		std::shared_ptr<Texture> scatter_transfer_t;
-		std::shared_ptr<Texture> out_transmittance;
+		// per frame luts of ComputeSkyLuts
+		std::shared_ptr<Texture> sky_view_lut;
+		// in-scattering in rgb and transmittance in a
+		std::shared_ptr<Texture> camera_volume;
 
 	private:
 
@@ -93,11 +241,18 @@ namespace Horizon
 		struct ScatteringUb
 		{
 			Math::mat4 inv_view_projection_matrix;
+			// render area of the scattering pass
 			Math::vec2 resolution;
-			Math::vec2 pad0;
+			Math::vec2 uv_scale;
 			Math::vec3 camera_pos;
-			f32 pad1;
-		} m_sky_ubdata;
+			// full resolution pixels per scattering pixel along each axis
+			f32 downsample;
+			Math::mat4 prev_view_projection_matrix;
+			// pixel of each 2x2 block evaluated this frame
+			Math::vec2 jitter;
+			f32 history_valid;
+			f32 pad0;
+		} m_sky_ubdata{};
 
 		bool precomputed = false;
 
@@ -0,0 +1,839 @@
+#include "AtmosphereCpuPrecompute.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HORIZON_ATMOSPHERE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Horizon
+{
+	// definations.glsl
+
+	static constexpr f32 k_pi = 3.14159265359f;
+
+	AtmosphereLutDesc AtmosphereLutDesc::Get(AtmosphereLutQuality quality) noexcept
+	{
+		switch (quality) {
+		case AtmosphereLutQuality::MEDIUM:
+			return { 256, 64, 64, 16, 32, 128, 32, 8, true, "_medium" };
+		case AtmosphereLutQuality::LOW:
+			return { 128, 32, 32, 8, 16, 64, 16, 8, true, "_low" };
+		default:
+			return { 256, 64, 64, 16, 32, 128, 32, 8, false, "" };
+		}
+	}
+
+	u32 AtmosphereLutDesc::GetScatteringWidth() const noexcept
+	{
+		return scattering_nu_size * scattering_mu_s_size;
+	}
+
+	u64 AtmosphereLutDesc::GetMemorySize() const noexcept
+	{
+		u64 texel_size = half_precision ? 8 : 16;
+		u64 transmittance = static_cast<u64>(transmittance_width) * transmittance_height * 16;
+		// delta and accumulated irradiance
+		u64 irradiance = 2ull * irradiance_width * irradiance_height * texel_size;
+		// single rayleigh, single mie, scattering density and scattering
+		u64 scattering = 4ull * GetScatteringWidth() * scattering_mu_size * scattering_r_size * texel_size;
+		return transmittance + irradiance + scattering;
+	}
+
+	struct DensityProfileLayer
+	{
+		f32 width, exp_term, exp_scale, linear_term, constant_term;
+	};
+
+	struct DensityProfile
+	{
+		DensityProfileLayer layers[2];
+	};
+
+	struct AtmosphereParameters
+	{
+		f32 bottom_radius;
+		f32 top_radius;
+		f32 mie_g;
+		f32 sun_angular_radius;
+		Math::vec3 solar_irradiance;
+		Math::vec3 rayleigh_scattering, mie_scattering, mie_extinction, absorption_extinction;
+		DensityProfile rayleigh_density, mie_density, absorption_density;
+		f32 mu_s_min;
+		Math::vec3 ground_albedo;
+		// the size macros of definations.glsl
+		AtmosphereLutDesc lut;
+	};
+
+	// GetAtmosphereParameters of functions.glsl, keep both in sync
+	static AtmosphereParameters GetAtmosphereParameters(f32 haze, AtmosphereLutQuality quality) noexcept
+	{
+		AtmosphereParameters atmosphere;
+		atmosphere.lut = AtmosphereLutDesc::Get(quality);
+		atmosphere.bottom_radius = 6360.0f;
+		atmosphere.top_radius = 6460.0f;
+		atmosphere.solar_irradiance = Math::vec3(1.0f);
+		atmosphere.sun_angular_radius = 0.004675f;
+		f32 rayleigh_scale_height = 8.0f;
+		f32 mie_scale_height = 1.2f;
+		atmosphere.rayleigh_density.layers[0] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		atmosphere.rayleigh_density.layers[1] = { 0.0f, 1.0f, -1.0f / rayleigh_scale_height, 0.0f, 0.0f };
+		atmosphere.rayleigh_scattering = Math::vec3(0.005802f, 0.013558f, 0.033100f);
+		atmosphere.mie_density.layers[0] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		atmosphere.mie_density.layers[1] = { 0.0f, 1.0f, -1.0f / mie_scale_height, 0.0f, 0.0f };
+		atmosphere.mie_scattering = Math::vec3(0.003996f) * haze;
+		atmosphere.mie_extinction = Math::vec3(0.004440f) * haze;
+		atmosphere.mie_g = 0.8f;
+		atmosphere.absorption_density.layers[0] = { 25.0f, 0.0f, 0.0f, 1.0f / 15.0f, -2.0f / 3.0f };
+		atmosphere.absorption_density.layers[1] = { 0.0f, 0.0f, 0.0f, -1.0f / 15.0f, 8.0f / 3.0f };
+		atmosphere.absorption_extinction = Math::vec3(0.000650f, 0.001881f, 0.000085f);
+		atmosphere.ground_albedo = Math::vec3(0.0f);
+		atmosphere.mu_s_min = std::cos(120.0f / 180.0f * k_pi);
+		return atmosphere;
+	}
+
+	// functions.glsl, one function per glsl function
+
+	static f32 ClampCosine(f32 mu)
+	{
+		return std::clamp(mu, -1.0f, 1.0f);
+	}
+
+	static f32 ClampDistance(f32 d)
+	{
+		return (std::max)(d, 0.0f);
+	}
+
+	static f32 ClampRadius(const AtmosphereParameters& atmosphere, f32 r)
+	{
+		return std::clamp(r, atmosphere.bottom_radius, atmosphere.top_radius);
+	}
+
+	static f32 SafeSqrt(f32 a)
+	{
+		return std::sqrt((std::max)(a, 0.0f));
+	}
+
+	static f32 SmoothStep(f32 edge0, f32 edge1, f32 x)
+	{
+		f32 t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+		return t * t * (3.0f - 2.0f * t);
+	}
+
+	static f32 DistanceToTopAtmosphereBoundary(const AtmosphereParameters& atmosphere, f32 r, f32 mu)
+	{
+		f32 discriminant = r * r * (mu * mu - 1.0f) + atmosphere.top_radius * atmosphere.top_radius;
+		return ClampDistance(-r * mu + SafeSqrt(discriminant));
+	}
+
+	static f32 DistanceToBottomAtmosphereBoundary(const AtmosphereParameters& atmosphere, f32 r, f32 mu)
+	{
+		f32 discriminant = r * r * (mu * mu - 1.0f) + atmosphere.bottom_radius * atmosphere.bottom_radius;
+		return ClampDistance(-r * mu - SafeSqrt(discriminant));
+	}
+
+	static bool RayIntersectsGround(const AtmosphereParameters& atmosphere, f32 r, f32 mu)
+	{
+		return mu < 0.0f && r * r * (mu * mu - 1.0f) + atmosphere.bottom_radius * atmosphere.bottom_radius >= 0.0f;
+	}
+
+	static f32 GetLayerDensity(const DensityProfileLayer& layer, f32 altitude)
+	{
+		f32 density = layer.exp_term * std::exp(layer.exp_scale * altitude) + layer.linear_term * altitude + layer.constant_term;
+		return std::clamp(density, 0.0f, 1.0f);
+	}
+
+	static f32 GetProfileDensity(const DensityProfile& profile, f32 altitude)
+	{
+		return altitude < profile.layers[0].width ? GetLayerDensity(profile.layers[0], altitude) : GetLayerDensity(profile.layers[1], altitude);
+	}
+
+	static f32 ComputeOpticalLengthToTopAtmosphereBoundary(const AtmosphereParameters& atmosphere, const DensityProfile& profile, f32 r, f32 mu)
+	{
+		const i32 sample_count = 500;
+		f32 dx = DistanceToTopAtmosphereBoundary(atmosphere, r, mu) / static_cast<f32>(sample_count);
+		f32 result = 0.0f;
+		for (i32 i = 0; i <= sample_count; i++) {
+			f32 d_i = static_cast<f32>(i) * dx;
+			f32 r_i = std::sqrt(d_i * d_i + 2.0f * r * mu * d_i + r * r);
+			f32 y_i = GetProfileDensity(profile, r_i - atmosphere.bottom_radius);
+			f32 weight_i = i == 0 || i == sample_count ? 0.5f : 1.0f;
+			result += y_i * weight_i * dx;
+		}
+		return result;
+	}
+
+	static Math::vec3 ComputeTransmittanceToTopAtmosphereBoundary(const AtmosphereParameters& atmosphere, f32 r, f32 mu)
+	{
+		Math::vec3 optical_depth = atmosphere.rayleigh_scattering * ComputeOpticalLengthToTopAtmosphereBoundary(atmosphere, atmosphere.rayleigh_density, r, mu) +
+			atmosphere.mie_extinction * ComputeOpticalLengthToTopAtmosphereBoundary(atmosphere, atmosphere.mie_density, r, mu) +
+			atmosphere.absorption_extinction * ComputeOpticalLengthToTopAtmosphereBoundary(atmosphere, atmosphere.absorption_density, r, mu);
+		return Math::exp(-optical_depth);
+	}
+
+	static f32 GetTextureCoordFromUnitRange(f32 x, f32 texture_size)
+	{
+		return 0.5f / texture_size + x * (1.0f - 1.0f / texture_size);
+	}
+
+	static f32 GetUnitRangeFromTextureCoord(f32 u, f32 texture_size)
+	{
+		return (u - 0.5f / texture_size) / (1.0f - 1.0f / texture_size);
+	}
+
+	static Math::vec2 GetTransmittanceTextureUvFromRMu(const AtmosphereParameters& atmosphere, f32 r, f32 mu)
+	{
+		f32 H = std::sqrt(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 rho = SafeSqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 d = DistanceToTopAtmosphereBoundary(atmosphere, r, mu);
+		f32 d_min = atmosphere.top_radius - r;
+		f32 d_max = rho + H;
+		f32 x_mu = (d - d_min) / (d_max - d_min);
+		f32 x_r = rho / H;
+		return Math::vec2(GetTextureCoordFromUnitRange(x_mu, atmosphere.lut.transmittance_width), GetTextureCoordFromUnitRange(x_r, atmosphere.lut.transmittance_height));
+	}
+
+	static void GetRMuFromTransmittanceTextureUv(const AtmosphereParameters& atmosphere, Math::vec2 uv, f32& r, f32& mu)
+	{
+		f32 x_mu = GetUnitRangeFromTextureCoord(uv.x, atmosphere.lut.transmittance_width);
+		f32 x_r = GetUnitRangeFromTextureCoord(uv.y, atmosphere.lut.transmittance_height);
+		f32 H = std::sqrt(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 rho = H * x_r;
+		r = std::sqrt(rho * rho + atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 d_min = atmosphere.top_radius - r;
+		f32 d_max = rho + H;
+		f32 d = d_min + x_mu * (d_max - d_min);
+		mu = d == 0.0f ? 1.0f : (H * H - rho * rho - d * d) / (2.0f * r * d);
+		mu = ClampCosine(mu);
+	}
+
+	static Math::vec3 GetTransmittanceToTopAtmosphereBoundary(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& transmittance_texture, f32 r, f32 mu)
+	{
+		return Math::vec3(transmittance_texture.Sample(GetTransmittanceTextureUvFromRMu(atmosphere, r, mu)));
+	}
+
+	static Math::vec3 GetTransmittance(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& transmittance_texture, f32 r, f32 mu, f32 d, bool ray_r_mu_intersects_ground)
+	{
+		f32 r_d = ClampRadius(atmosphere, std::sqrt(d * d + 2.0f * r * mu * d + r * r));
+		f32 mu_d = ClampCosine((r * mu + d) / r_d);
+		if (ray_r_mu_intersects_ground) {
+			return Math::min(GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_texture, r_d, -mu_d) /
+				GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_texture, r, -mu), Math::vec3(1.0f));
+		}
+		else {
+			return Math::min(GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_texture, r, mu) /
+				GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_texture, r_d, mu_d), Math::vec3(1.0f));
+		}
+	}
+
+	static Math::vec3 GetTransmittanceToSun(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& transmittance_texture, f32 r, f32 mu_s)
+	{
+		f32 sin_theta_h = atmosphere.bottom_radius / r;
+		f32 cos_theta_h = -std::sqrt((std::max)(1.0f - sin_theta_h * sin_theta_h, 0.0f));
+		return GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_texture, r, mu_s) *
+			SmoothStep(-sin_theta_h * atmosphere.sun_angular_radius, sin_theta_h * atmosphere.sun_angular_radius, mu_s - cos_theta_h);
+	}
+
+	static void ComputeSingleScatteringIntegrand(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& transmittance_texture,
+		f32 r, f32 mu, f32 mu_s, f32 nu, f32 d, bool ray_r_mu_intersects_ground, Math::vec3& rayleigh, Math::vec3& mie)
+	{
+		f32 r_d = ClampRadius(atmosphere, std::sqrt(d * d + 2.0f * r * mu * d + r * r));
+		f32 mu_s_d = ClampCosine((r * mu_s + d * nu) / r_d);
+		Math::vec3 transmittance = GetTransmittance(atmosphere, transmittance_texture, r, mu, d, ray_r_mu_intersects_ground) *
+			GetTransmittanceToSun(atmosphere, transmittance_texture, r_d, mu_s_d);
+		rayleigh = transmittance * GetProfileDensity(atmosphere.rayleigh_density, r_d - atmosphere.bottom_radius);
+		mie = transmittance * GetProfileDensity(atmosphere.mie_density, r_d - atmosphere.bottom_radius);
+	}
+
+	static f32 DistanceToNearestAtmosphereBoundary(const AtmosphereParameters& atmosphere, f32 r, f32 mu, bool ray_r_mu_intersects_ground)
+	{
+		return ray_r_mu_intersects_ground ? DistanceToBottomAtmosphereBoundary(atmosphere, r, mu) : DistanceToTopAtmosphereBoundary(atmosphere, r, mu);
+	}
+
+	static void ComputeSingleScattering(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& transmittance_texture,
+		f32 r, f32 mu, f32 mu_s, f32 nu, bool ray_r_mu_intersects_ground, Math::vec3& rayleigh, Math::vec3& mie)
+	{
+		const i32 sample_count = 50;
+		f32 dx = DistanceToNearestAtmosphereBoundary(atmosphere, r, mu, ray_r_mu_intersects_ground) / static_cast<f32>(sample_count);
+		Math::vec3 rayleigh_sum(0.0f);
+		Math::vec3 mie_sum(0.0f);
+		for (i32 i = 0; i <= sample_count; i++) {
+			f32 d_i = static_cast<f32>(i) * dx;
+			Math::vec3 rayleigh_i, mie_i;
+			ComputeSingleScatteringIntegrand(atmosphere, transmittance_texture, r, mu, mu_s, nu, d_i, ray_r_mu_intersects_ground, rayleigh_i, mie_i);
+			f32 weight_i = (i == 0 || i == sample_count) ? 0.5f : 1.0f;
+			rayleigh_sum += rayleigh_i * weight_i;
+			mie_sum += mie_i * weight_i;
+		}
+		rayleigh = rayleigh_sum * dx * atmosphere.solar_irradiance * atmosphere.rayleigh_scattering;
+		mie = mie_sum * dx * atmosphere.solar_irradiance * atmosphere.mie_scattering;
+	}
+
+	static f32 RayleighPhaseFunction(f32 nu)
+	{
+		f32 k = 3.0f / (16.0f * k_pi);
+		return k * (1.0f + nu * nu);
+	}
+
+	static f32 MiePhaseFunction(f32 g, f32 nu)
+	{
+		f32 k = 3.0f / (8.0f * k_pi) * (1.0f - g * g) / (2.0f + g * g);
+		return k * (1.0f + nu * nu) / std::pow(1.0f + g * g - 2.0f * g * nu, 1.5f);
+	}
+
+	static Math::vec4 GetScatteringTextureUvwzFromRMuMuSNu(const AtmosphereParameters& atmosphere, f32 r, f32 mu, f32 mu_s, f32 nu, bool ray_r_mu_intersects_ground)
+	{
+		f32 H = std::sqrt(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 rho = SafeSqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 u_r = GetTextureCoordFromUnitRange(rho / H, atmosphere.lut.scattering_r_size);
+
+		f32 r_mu = r * mu;
+		f32 discriminant = r_mu * r_mu - r * r + atmosphere.bottom_radius * atmosphere.bottom_radius;
+		f32 u_mu;
+		if (ray_r_mu_intersects_ground) {
+			f32 d = -r_mu - SafeSqrt(discriminant);
+			f32 d_min = r - atmosphere.bottom_radius;
+			f32 d_max = rho;
+			u_mu = 0.5f - 0.5f * GetTextureCoordFromUnitRange(d_max == d_min ? 0.0f : (d - d_min) / (d_max - d_min), atmosphere.lut.scattering_mu_size * 0.5f);
+		}
+		else {
+			f32 d = -r_mu + SafeSqrt(discriminant + H * H);
+			f32 d_min = atmosphere.top_radius - r;
+			f32 d_max = rho + H;
+			u_mu = 0.5f + 0.5f * GetTextureCoordFromUnitRange((d - d_min) / (d_max - d_min), atmosphere.lut.scattering_mu_size * 0.5f);
+		}
+
+		f32 d = DistanceToTopAtmosphereBoundary(atmosphere, atmosphere.bottom_radius, mu_s);
+		f32 d_min = atmosphere.top_radius - atmosphere.bottom_radius;
+		f32 d_max = H;
+		f32 a = (d - d_min) / (d_max - d_min);
+		f32 D = DistanceToTopAtmosphereBoundary(atmosphere, atmosphere.bottom_radius, atmosphere.mu_s_min);
+		f32 A = (D - d_min) / (d_max - d_min);
+		f32 u_mu_s = GetTextureCoordFromUnitRange((std::max)(1.0f - a / A, 0.0f) / (1.0f + a), atmosphere.lut.scattering_mu_s_size);
+
+		f32 u_nu = (nu + 1.0f) / 2.0f;
+		return Math::vec4(u_nu, u_mu_s, u_mu, u_r);
+	}
+
+	static void GetRMuMuSNuFromScatteringTextureUvwz(const AtmosphereParameters& atmosphere, Math::vec4 uvwz,
+		f32& r, f32& mu, f32& mu_s, f32& nu, bool& ray_r_mu_intersects_ground)
+	{
+		f32 H = std::sqrt(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		f32 rho = H * GetUnitRangeFromTextureCoord(uvwz.w, atmosphere.lut.scattering_r_size);
+		r = std::sqrt(rho * rho + atmosphere.bottom_radius * atmosphere.bottom_radius);
+
+		if (uvwz.z < 0.5f) {
+			f32 d_min = r - atmosphere.bottom_radius;
+			f32 d_max = rho;
+			f32 d = d_min + (d_max - d_min) * GetUnitRangeFromTextureCoord(1.0f - 2.0f * uvwz.z, atmosphere.lut.scattering_mu_size / 2);
+			mu = d == 0.0f ? -1.0f : ClampCosine(-(rho * rho + d * d) / (2.0f * r * d));
+			ray_r_mu_intersects_ground = true;
+		}
+		else {
+			f32 d_min = atmosphere.top_radius - r;
+			f32 d_max = rho + H;
+			f32 d = d_min + (d_max - d_min) * GetUnitRangeFromTextureCoord(2.0f * uvwz.z - 1.0f, atmosphere.lut.scattering_mu_size / 2);
+			mu = d == 0.0f ? 1.0f : ClampCosine((H * H - rho * rho - d * d) / (2.0f * r * d));
+			ray_r_mu_intersects_ground = false;
+		}
+
+		f32 x_mu_s = GetUnitRangeFromTextureCoord(uvwz.y, atmosphere.lut.scattering_mu_s_size);
+		f32 d_min = atmosphere.top_radius - atmosphere.bottom_radius;
+		f32 d_max = H;
+		f32 D = DistanceToTopAtmosphereBoundary(atmosphere, atmosphere.bottom_radius, atmosphere.mu_s_min);
+		f32 A = (D - d_min) / (d_max - d_min);
+		f32 a = (A - x_mu_s * A) / (1.0f + x_mu_s * A);
+		f32 d = d_min + (std::min)(a, A) * (d_max - d_min);
+		mu_s = d == 0.0f ? 1.0f : ClampCosine((H * H - d * d) / (2.0f * atmosphere.bottom_radius * d));
+
+		nu = ClampCosine(uvwz.x * 2.0f - 1.0f);
+	}
+
+	static void GetRMuMuSNuFromScatteringTextureFragCoord(const AtmosphereParameters& atmosphere, Math::vec3 frag_coord,
+		f32& r, f32& mu, f32& mu_s, f32& nu, bool& ray_r_mu_intersects_ground)
+	{
+		f32 frag_coord_nu = std::floor(frag_coord.x / static_cast<f32>(atmosphere.lut.scattering_mu_s_size));
+		f32 frag_coord_mu_s = std::fmod(frag_coord.x, static_cast<f32>(atmosphere.lut.scattering_mu_s_size));
+		Math::vec4 uvwz(frag_coord_nu / (atmosphere.lut.scattering_nu_size - 1), frag_coord_mu_s / atmosphere.lut.scattering_mu_s_size,
+			frag_coord.y / atmosphere.lut.scattering_mu_size, frag_coord.z / atmosphere.lut.scattering_r_size);
+		GetRMuMuSNuFromScatteringTextureUvwz(atmosphere, uvwz, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+		nu = std::clamp(nu, mu * mu_s - std::sqrt((1.0f - mu * mu) * (1.0f - mu_s * mu_s)), mu * mu_s + std::sqrt((1.0f - mu * mu) * (1.0f - mu_s * mu_s)));
+	}
+
+	static Math::vec3 GetScattering(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& scattering_texture,
+		f32 r, f32 mu, f32 mu_s, f32 nu, bool ray_r_mu_intersects_ground)
+	{
+		Math::vec4 uvwz = GetScatteringTextureUvwzFromRMuMuSNu(atmosphere, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+		f32 tex_coord_x = uvwz.x * static_cast<f32>(atmosphere.lut.scattering_nu_size - 1);
+		f32 tex_x = std::floor(tex_coord_x);
+		f32 lerp = tex_coord_x - tex_x;
+		Math::vec3 uvw0((tex_x + uvwz.y) / static_cast<f32>(atmosphere.lut.scattering_nu_size), uvwz.z, uvwz.w);
+		Math::vec3 uvw1((tex_x + 1.0f + uvwz.y) / static_cast<f32>(atmosphere.lut.scattering_nu_size), uvwz.z, uvwz.w);
+		return Math::vec3(scattering_texture.Sample(uvw0) * (1.0f - lerp) + scattering_texture.Sample(uvw1) * lerp);
+	}
+
+	static Math::vec3 GetScattering(const AtmosphereParameters& atmosphere,
+		const AtmosphereCpuPrecompute::Lut& single_rayleigh_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& single_mie_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& multiple_scattering_texture,
+		f32 r, f32 mu, f32 mu_s, f32 nu, bool ray_r_mu_intersects_ground, i32 scattering_order)
+	{
+		if (scattering_order == 1) {
+			Math::vec3 rayleigh = GetScattering(atmosphere, single_rayleigh_scattering_texture, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			Math::vec3 mie = GetScattering(atmosphere, single_mie_scattering_texture, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			return rayleigh * RayleighPhaseFunction(nu) + mie * MiePhaseFunction(atmosphere.mie_g, nu);
+		}
+		else {
+			return GetScattering(atmosphere, multiple_scattering_texture, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+		}
+	}
+
+	static Math::vec2 GetIrradianceTextureUvFromRMuS(const AtmosphereParameters& atmosphere, f32 r, f32 mu_s)
+	{
+		f32 x_r = (r - atmosphere.bottom_radius) / (atmosphere.top_radius - atmosphere.bottom_radius);
+		f32 x_mu_s = mu_s * 0.5f + 0.5f;
+		return Math::vec2(GetTextureCoordFromUnitRange(x_mu_s, atmosphere.lut.irradiance_width), GetTextureCoordFromUnitRange(x_r, atmosphere.lut.irradiance_height));
+	}
+
+	static void GetRMuSFromIrradianceTextureUv(const AtmosphereParameters& atmosphere, Math::vec2 uv, f32& r, f32& mu_s)
+	{
+		f32 x_mu_s = GetUnitRangeFromTextureCoord(uv.x, atmosphere.lut.irradiance_width);
+		f32 x_r = GetUnitRangeFromTextureCoord(uv.y, atmosphere.lut.irradiance_height);
+		r = atmosphere.bottom_radius + x_r * (atmosphere.top_radius - atmosphere.bottom_radius);
+		mu_s = ClampCosine(2.0f * x_mu_s - 1.0f);
+	}
+
+	static Math::vec3 GetIrradiance(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& irradiance_texture, f32 r, f32 mu_s)
+	{
+		return Math::vec3(irradiance_texture.Sample(GetIrradianceTextureUvFromRMuS(atmosphere, r, mu_s)));
+	}
+
+	static Math::vec3 ComputeScatteringDensity(const AtmosphereParameters& atmosphere,
+		const AtmosphereCpuPrecompute::Lut& transmittance_texture,
+		const AtmosphereCpuPrecompute::Lut& single_rayleigh_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& single_mie_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& multiple_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& irradiance_texture,
+		f32 r, f32 mu, f32 mu_s, f32 nu, i32 scattering_order)
+	{
+		Math::vec3 zenith_direction(0.0f, 0.0f, 1.0f);
+		Math::vec3 omega(std::sqrt(1.0f - mu * mu), 0.0f, mu);
+		f32 sun_dir_x = omega.x == 0.0f ? 0.0f : (nu - mu * mu_s) / omega.x;
+		f32 sun_dir_y = std::sqrt((std::max)(1.0f - sun_dir_x * sun_dir_x - mu_s * mu_s, 0.0f));
+		Math::vec3 omega_s(sun_dir_x, sun_dir_y, mu_s);
+
+		const i32 sample_count = 16;
+		const f32 dphi = k_pi / static_cast<f32>(sample_count);
+		const f32 dtheta = k_pi / static_cast<f32>(sample_count);
+
+		// constant over the integral, hoisted out of the loops
+		f32 rayleigh_density = GetProfileDensity(atmosphere.rayleigh_density, r - atmosphere.bottom_radius);
+		f32 mie_density = GetProfileDensity(atmosphere.mie_density, r - atmosphere.bottom_radius);
+
+		Math::vec3 rayleigh_mie(0.0f);
+		for (i32 l = 0; l < sample_count; l++) {
+			f32 theta = (static_cast<f32>(l) + 0.5f) * dtheta;
+			f32 cos_theta = std::cos(theta);
+			f32 sin_theta = std::sin(theta);
+			bool ray_r_theta_intersects_ground = RayIntersectsGround(atmosphere, r, cos_theta);
+
+			f32 distance_to_ground = 0.0f;
+			Math::vec3 transmittance_to_ground(0.0f);
+			Math::vec3 ground_albedo(0.0f);
+			if (ray_r_theta_intersects_ground) {
+				distance_to_ground = DistanceToBottomAtmosphereBoundary(atmosphere, r, cos_theta);
+				transmittance_to_ground = GetTransmittance(atmosphere, transmittance_texture, r, cos_theta, distance_to_ground, true);
+				ground_albedo = atmosphere.ground_albedo;
+			}
+
+			for (i32 m = 0; m < 2 * sample_count; m++) {
+				f32 phi = (static_cast<f32>(m) + 0.5f) * dphi;
+				Math::vec3 omega_i(std::cos(phi) * sin_theta, std::sin(phi) * sin_theta, cos_theta);
+				f32 domega_i = dtheta * dphi * std::sin(theta);
+
+				f32 nu1 = Math::dot(omega_s, omega_i);
+				Math::vec3 incident_radiance = GetScattering(atmosphere, single_rayleigh_scattering_texture, single_mie_scattering_texture,
+					multiple_scattering_texture, r, omega_i.z, mu_s, nu1, ray_r_theta_intersects_ground, scattering_order - 1);
+
+				Math::vec3 ground_normal = Math::normalize(zenith_direction * r + omega_i * distance_to_ground);
+				Math::vec3 ground_irradiance = GetIrradiance(atmosphere, irradiance_texture, atmosphere.bottom_radius, Math::dot(ground_normal, omega_s));
+				incident_radiance += transmittance_to_ground * ground_albedo * (1.0f / k_pi) * ground_irradiance;
+
+				f32 nu2 = Math::dot(omega, omega_i);
+				rayleigh_mie += incident_radiance * (atmosphere.rayleigh_scattering * rayleigh_density * RayleighPhaseFunction(nu2) +
+					atmosphere.mie_scattering * mie_density * MiePhaseFunction(atmosphere.mie_g, nu2)) * domega_i;
+			}
+		}
+		return rayleigh_mie;
+	}
+
+	static Math::vec3 ComputeMultipleScattering(const AtmosphereParameters& atmosphere,
+		const AtmosphereCpuPrecompute::Lut& transmittance_texture,
+		const AtmosphereCpuPrecompute::Lut& scattering_density_texture,
+		f32 r, f32 mu, f32 mu_s, f32 nu, bool ray_r_mu_intersects_ground)
+	{
+		const i32 sample_count = 50;
+		f32 dx = DistanceToNearestAtmosphereBoundary(atmosphere, r, mu, ray_r_mu_intersects_ground) / static_cast<f32>(sample_count);
+		Math::vec3 rayleigh_mie_sum(0.0f);
+		for (i32 i = 0; i <= sample_count; i++) {
+			f32 d_i = static_cast<f32>(i) * dx;
+			f32 r_i = ClampRadius(atmosphere, std::sqrt(d_i * d_i + 2.0f * r * mu * d_i + r * r));
+			f32 mu_i = ClampCosine((r * mu + d_i) / r_i);
+			f32 mu_s_i = ClampCosine((r * mu_s + d_i * nu) / r_i);
+			Math::vec3 rayleigh_mie_i = GetScattering(atmosphere, scattering_density_texture, r_i, mu_i, mu_s_i, nu, ray_r_mu_intersects_ground) *
+				GetTransmittance(atmosphere, transmittance_texture, r, mu, d_i, ray_r_mu_intersects_ground) * dx;
+			f32 weight_i = (i == 0 || i == sample_count) ? 0.5f : 1.0f;
+			rayleigh_mie_sum += rayleigh_mie_i * weight_i;
+		}
+		return rayleigh_mie_sum;
+	}
+
+	static Math::vec3 ComputeDirectIrradiance(const AtmosphereParameters& atmosphere, const AtmosphereCpuPrecompute::Lut& transmittance_texture, f32 r, f32 mu_s)
+	{
+		f32 alpha_s = atmosphere.sun_angular_radius;
+		f32 average_cosine_factor = mu_s < -alpha_s ? 0.0f : (mu_s > alpha_s ? mu_s : (mu_s + alpha_s) * (mu_s + alpha_s) / (4.0f * alpha_s));
+		return atmosphere.solar_irradiance * GetTransmittanceToTopAtmosphereBoundary(atmosphere, transmittance_texture, r, mu_s) * average_cosine_factor;
+	}
+
+	static Math::vec3 ComputeIndirectIrradiance(const AtmosphereParameters& atmosphere,
+		const AtmosphereCpuPrecompute::Lut& single_rayleigh_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& single_mie_scattering_texture,
+		const AtmosphereCpuPrecompute::Lut& multiple_scattering_texture,
+		f32 r, f32 mu_s, i32 scattering_order)
+	{
+		const i32 sample_count = 32;
+		const f32 dphi = k_pi / static_cast<f32>(sample_count);
+		const f32 dtheta = k_pi / static_cast<f32>(sample_count);
+
+		Math::vec3 result(0.0f);
+		Math::vec3 omega_s(std::sqrt(1.0f - mu_s * mu_s), 0.0f, mu_s);
+		for (i32 j = 0; j < sample_count / 2; j++) {
+			f32 theta = (static_cast<f32>(j) + 0.5f) * dtheta;
+			for (i32 i = 0; i < 2 * sample_count; i++) {
+				f32 phi = (static_cast<f32>(i) + 0.5f) * dphi;
+				Math::vec3 omega(std::cos(phi) * std::sin(theta), std::sin(phi) * std::sin(theta), std::cos(theta));
+				f32 domega = dtheta * dphi * std::sin(theta);
+				f32 nu = Math::dot(omega, omega_s);
+				result += GetScattering(atmosphere, single_rayleigh_scattering_texture, single_mie_scattering_texture, multiple_scattering_texture,
+					r, omega.z, mu_s, nu, false, scattering_order) * omega.z * domega;
+			}
+		}
+		return result;
+	}
+
+	// lut
+
+#ifdef HORIZON_ATMOSPHERE_SSE
+	// the operations of Math::mix, so both paths filter to the same values
+	static __m128 Lerp(__m128 a, __m128 b, f32 t) noexcept
+	{
+		return _mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(1.0f - t)), _mm_mul_ps(b, _mm_set1_ps(t)));
+	}
+#endif
+
+	AtmosphereCpuPrecompute::Lut::Lut(u32 _width, u32 _height, u32 _depth, bool _half_precision) noexcept : width(_width), height(_height), depth(_depth), half_precision(_half_precision)
+	{
+		texels.resize(static_cast<size_t>(width) * height * depth, Math::vec4(0.0f));
+	}
+
+	Math::vec4 AtmosphereCpuPrecompute::Lut::Sample(Math::vec2 uv) const noexcept
+	{
+		f32 x = uv.x * width - 0.5f, y = uv.y * height - 0.5f;
+		f32 x0 = std::floor(x), y0 = std::floor(y);
+		f32 fx = x - x0, fy = y - y0;
+		auto clamp = [](f32 v, u32 size) {
+			return static_cast<size_t>(std::clamp(v, 0.0f, static_cast<f32>(size - 1)));
+		};
+		size_t ix0 = clamp(x0, width), ix1 = clamp(x0 + 1.0f, width);
+		size_t row0 = clamp(y0, height) * width, row1 = clamp(y0 + 1.0f, height) * width;
+#ifdef HORIZON_ATMOSPHERE_SSE
+		auto texel = [this](size_t index) {
+			return _mm_loadu_ps(Math::value_ptr(texels[index]));
+		};
+		Math::vec4 result;
+		_mm_storeu_ps(Math::value_ptr(result), Lerp(Lerp(texel(row0 + ix0), texel(row0 + ix1), fx), Lerp(texel(row1 + ix0), texel(row1 + ix1), fx), fy));
+		return result;
+#else
+		return Math::mix(Math::mix(texels[row0 + ix0], texels[row0 + ix1], fx), Math::mix(texels[row1 + ix0], texels[row1 + ix1], fx), fy);
+#endif
+	}
+
+	Math::vec4 AtmosphereCpuPrecompute::Lut::Sample(Math::vec3 uvw) const noexcept
+	{
+		f32 x = uvw.x * width - 0.5f, y = uvw.y * height - 0.5f, z = uvw.z * depth - 0.5f;
+		f32 x0 = std::floor(x), y0 = std::floor(y), z0 = std::floor(z);
+		f32 fx = x - x0, fy = y - y0, fz = z - z0;
+		auto clamp = [](f32 v, u32 size) {
+			return static_cast<size_t>(std::clamp(v, 0.0f, static_cast<f32>(size - 1)));
+		};
+		size_t ix0 = clamp(x0, width), ix1 = clamp(x0 + 1.0f, width);
+		size_t iy0 = clamp(y0, height), iy1 = clamp(y0 + 1.0f, height);
+		size_t slice0 = clamp(z0, depth) * height, slice1 = clamp(z0 + 1.0f, depth) * height;
+		size_t row00 = (slice0 + iy0) * width, row01 = (slice0 + iy1) * width;
+		size_t row10 = (slice1 + iy0) * width, row11 = (slice1 + iy1) * width;
+#ifdef HORIZON_ATMOSPHERE_SSE
+		auto texel = [this](size_t index) {
+			return _mm_loadu_ps(Math::value_ptr(texels[index]));
+		};
+		__m128 c0 = Lerp(Lerp(texel(row00 + ix0), texel(row00 + ix1), fx), Lerp(texel(row01 + ix0), texel(row01 + ix1), fx), fy);
+		__m128 c1 = Lerp(Lerp(texel(row10 + ix0), texel(row10 + ix1), fx), Lerp(texel(row11 + ix0), texel(row11 + ix1), fx), fy);
+		Math::vec4 result;
+		_mm_storeu_ps(Math::value_ptr(result), Lerp(c0, c1, fz));
+		return result;
+#else
+		Math::vec4 c0 = Math::mix(Math::mix(texels[row00 + ix0], texels[row00 + ix1], fx), Math::mix(texels[row01 + ix0], texels[row01 + ix1], fx), fy);
+		Math::vec4 c1 = Math::mix(Math::mix(texels[row10 + ix0], texels[row10 + ix1], fx), Math::mix(texels[row11 + ix0], texels[row11 + ix1], fx), fy);
+		return Math::mix(c0, c1, fz);
+#endif
+	}
+
+	Math::vec4 AtmosphereCpuPrecompute::Lut::Round(Math::vec4 value) const noexcept
+	{
+		if (!half_precision) {
+			return value;
+		}
+		for (u32 c = 0; c < 4; c++) {
+			value[c] = Math::unpackHalf1x16(Math::packHalf1x16(value[c]));
+		}
+		return value;
+	}
+
+	std::vector<u8> AtmosphereCpuPrecompute::Lut::GetData() const noexcept
+	{
+		if (!half_precision) {
+			std::vector<u8> data(texels.size() * sizeof(Math::vec4));
+			memcpy(data.data(), texels.data(), data.size());
+			return data;
+		}
+		std::vector<u8> data(texels.size() * 4 * sizeof(u16));
+		u16* values = reinterpret_cast<u16*>(data.data());
+		for (size_t i = 0; i < texels.size(); i++) {
+			for (u32 c = 0; c < 4; c++) {
+				values[i * 4 + c] = Math::packHalf1x16(texels[i][c]);
+			}
+		}
+		return data;
+	}
+
+	// precompute
+
+	AtmosphereCpuPrecompute::AtmosphereCpuPrecompute(u32 thread_count) noexcept : m_thread_count(thread_count)
+	{
+		if (m_thread_count == 0) {
+			m_thread_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+		}
+	}
+
+	AtmosphereCpuPrecompute::~AtmosphereCpuPrecompute() noexcept
+	{
+	}
+
+	template <typename TexelFunc>
+	void AtmosphereCpuPrecompute::ForEachTexel(Lut& lut, const TexelFunc& texel) const noexcept
+	{
+		std::atomic<u32> next_row{ 0 };
+		u32 row_count = lut.height * lut.depth;
+		auto worker = [&]() {
+			for (u32 row = next_row++; row < row_count; row = next_row++) {
+				u32 y = row % lut.height, z = row / lut.height;
+				Math::vec4* texels = &lut.texels[static_cast<size_t>(row) * lut.width];
+				for (u32 x = 0; x < lut.width; x++) {
+					texels[x] = lut.Round(texel(x, y, z));
+				}
+			}
+		};
+		std::vector<std::thread> threads;
+		for (u32 i = 1; i < m_thread_count; i++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	void AtmosphereCpuPrecompute::Precompute(u32 multi_scattering_order, f32 haze, AtmosphereLutQuality quality) noexcept
+	{
+		auto start = std::chrono::steady_clock::now();
+		const AtmosphereParameters atmosphere = GetAtmosphereParameters(haze, quality);
+		const AtmosphereLutDesc& desc = atmosphere.lut;
+		m_haze = haze;
+		m_quality = quality;
+
+		const u32 scattering_width = desc.GetScatteringWidth();
+		m_transmittance_lut = Lut(desc.transmittance_width, desc.transmittance_height, 1);
+		m_irradiance_lut = Lut(desc.irradiance_width, desc.irradiance_height, 1, desc.half_precision);
+		m_scattering_lut = Lut(scattering_width, desc.scattering_mu_size, desc.scattering_r_size, desc.half_precision);
+		Lut delta_irradiance(desc.irradiance_width, desc.irradiance_height, 1, desc.half_precision);
+		Lut delta_rayleigh(scattering_width, desc.scattering_mu_size, desc.scattering_r_size, desc.half_precision);
+		Lut delta_mie(scattering_width, desc.scattering_mu_size, desc.scattering_r_size, desc.half_precision);
+		Lut scattering_density(scattering_width, desc.scattering_mu_size, desc.scattering_r_size, desc.half_precision);
+		// the gpu chain keeps the multiple scattering of the last order in the single rayleigh texture
+		Lut& delta_multiple_scattering = delta_rayleigh;
+
+		// transmittance_lut.comp
+		ForEachTexel(m_transmittance_lut, [&](u32 x, u32 y, u32) {
+			f32 r, mu;
+			Math::vec2 frag_coord(x + 0.5f, y + 0.5f);
+			GetRMuFromTransmittanceTextureUv(atmosphere, Math::vec2(frag_coord.x / desc.transmittance_width, frag_coord.y / desc.transmittance_height), r, mu);
+			return Math::vec4(ComputeTransmittanceToTopAtmosphereBoundary(atmosphere, r, mu), 1.0f);
+		});
+
+		// direct_irradiance_lut.comp, the irradiance lut only holds the indirect part
+		ForEachTexel(delta_irradiance, [&](u32 x, u32 y, u32) {
+			f32 r, mu_s;
+			GetRMuSFromIrradianceTextureUv(atmosphere, Math::vec2((x + 0.5f) / desc.irradiance_width, (y + 0.5f) / desc.irradiance_height), r, mu_s);
+			return Math::vec4(ComputeDirectIrradiance(atmosphere, m_transmittance_lut, r, mu_s), 0.0f);
+		});
+
+		// single_scattering_lut.comp, one pass for the three outputs
+		ForEachTexel(m_scattering_lut, [&](u32 x, u32 y, u32 z) {
+			f32 r, mu, mu_s, nu;
+			bool ray_r_mu_intersects_ground;
+			GetRMuMuSNuFromScatteringTextureFragCoord(atmosphere, Math::vec3(x + 0.5f, y + 0.5f, z + 0.5f), r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			Math::vec3 rayleigh, mie;
+			ComputeSingleScattering(atmosphere, m_transmittance_lut, r, mu, mu_s, nu, ray_r_mu_intersects_ground, rayleigh, mie);
+			size_t index = (static_cast<size_t>(z) * delta_rayleigh.height + y) * delta_rayleigh.width + x;
+			delta_rayleigh.texels[index] = delta_rayleigh.Round(Math::vec4(rayleigh, 0.0f));
+			delta_mie.texels[index] = delta_mie.Round(Math::vec4(mie, 0.0f));
+			return Math::vec4(rayleigh, mie.x);
+		});
+
+		for (u32 j = 0; j < multi_scattering_order; j++) {
+			i32 scattering_order = static_cast<i32>(j) + 2;
+
+			// scattering_density.comp
+			ForEachTexel(scattering_density, [&](u32 x, u32 y, u32 z) {
+				f32 r, mu, mu_s, nu;
+				bool ray_r_mu_intersects_ground;
+				GetRMuMuSNuFromScatteringTextureFragCoord(atmosphere, Math::vec3(x + 0.5f, y + 0.5f, z + 0.5f), r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+				return Math::vec4(ComputeScatteringDensity(atmosphere, m_transmittance_lut, delta_rayleigh, delta_mie, delta_multiple_scattering, delta_irradiance,
+					r, mu, mu_s, nu, scattering_order), 0.0f);
+			});
+
+			// indirect_irradiance_lut.comp
+			ForEachTexel(delta_irradiance, [&](u32 x, u32 y, u32) {
+				f32 r, mu_s;
+				GetRMuSFromIrradianceTextureUv(atmosphere, Math::vec2((x + 0.5f) / desc.irradiance_width, (y + 0.5f) / desc.irradiance_height), r, mu_s);
+				Math::vec4 result(ComputeIndirectIrradiance(atmosphere, delta_rayleigh, delta_mie, delta_multiple_scattering, r, mu_s, scattering_order - 1), 0.0f);
+				Math::vec4& irradiance = m_irradiance_lut.texels[static_cast<size_t>(y) * m_irradiance_lut.width + x];
+				irradiance = m_irradiance_lut.Round(irradiance + result);
+				return result;
+			});
+
+			// multi_scattering_lut.comp
+			ForEachTexel(delta_multiple_scattering, [&](u32 x, u32 y, u32 z) {
+				f32 r, mu, mu_s, nu;
+				bool ray_r_mu_intersects_ground;
+				GetRMuMuSNuFromScatteringTextureFragCoord(atmosphere, Math::vec3(x + 0.5f, y + 0.5f, z + 0.5f), r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+				Math::vec3 multiple_scattering = ComputeMultipleScattering(atmosphere, m_transmittance_lut, scattering_density, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+				Math::vec4& scattering = m_scattering_lut.texels[(static_cast<size_t>(z) * m_scattering_lut.height + y) * m_scattering_lut.width + x];
+				scattering = m_scattering_lut.Round(scattering + Math::vec4(multiple_scattering / RayleighPhaseFunction(nu), 0.0f));
+				return Math::vec4(multiple_scattering, 0.0f);
+			});
+		}
+
+		m_time = std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	const AtmosphereCpuPrecompute::Lut& AtmosphereCpuPrecompute::GetTransmittanceLut() const noexcept
+	{
+		return m_transmittance_lut;
+	}
+
+	const AtmosphereCpuPrecompute::Lut& AtmosphereCpuPrecompute::GetIrradianceLut() const noexcept
+	{
+		return m_irradiance_lut;
+	}
+
+	const AtmosphereCpuPrecompute::Lut& AtmosphereCpuPrecompute::GetScatteringLut() const noexcept
+	{
+		return m_scattering_lut;
+	}
+
+	f32 AtmosphereCpuPrecompute::GetTime() const noexcept
+	{
+		return m_time;
+	}
+
+	u32 AtmosphereCpuPrecompute::GetThreadCount() const noexcept
+	{
+		return m_thread_count;
+	}
+
+	f32 AtmosphereCpuPrecompute::Compare(const Lut& reference, const std::vector<u8>& data) noexcept
+	{
+		size_t component_size = reference.half_precision ? sizeof(u16) : sizeof(f32);
+		if (data.size() != reference.texels.size() * 4 * component_size) {
+			return std::numeric_limits<f32>::infinity();
+		}
+		auto value = [&](size_t i) {
+			return reference.half_precision ? Math::unpackHalf1x16(reinterpret_cast<const u16*>(data.data())[i]) : reinterpret_cast<const f32*>(data.data())[i];
+		};
+		f32 max_difference = 0.0f, max_value = 0.0f;
+		for (size_t i = 0; i < reference.texels.size(); i++) {
+			for (u32 c = 0; c < 4; c++) {
+				max_difference = (std::max)(max_difference, std::abs(value(i * 4 + c) - reference.texels[i][c]));
+				max_value = (std::max)(max_value, std::abs(reference.texels[i][c]));
+			}
+		}
+		return max_value > 0.0f ? max_difference / max_value : max_difference;
+	}
+
+	std::array<AtmosphereCpuPrecompute::LutError, 3> AtmosphereCpuPrecompute::CompareQuality(const AtmosphereCpuPrecompute& reference, const AtmosphereCpuPrecompute& other) noexcept
+	{
+		const AtmosphereParameters reference_atmosphere = GetAtmosphereParameters(reference.m_haze, reference.m_quality);
+		const AtmosphereParameters atmosphere = GetAtmosphereParameters(other.m_haze, other.m_quality);
+
+		// the rgb the sky reads from each lut, at the parameters of every reference texel
+		std::array<LutError, 3> errors;
+		auto compare = [](const Lut& lut, LutError& error, const auto& sample) {
+			f32 max_value = 0.0f;
+			f64 sum = 0.0;
+			for (u32 z = 0; z < lut.depth; z++) {
+				for (u32 y = 0; y < lut.height; y++) {
+					for (u32 x = 0; x < lut.width; x++) {
+						Math::vec3 expected(lut.texels[(static_cast<size_t>(z) * lut.height + y) * lut.width + x]);
+						Math::vec3 difference = Math::abs(sample(x, y, z) - expected);
+						f32 max_difference = (std::max)((std::max)(difference.x, difference.y), difference.z);
+						error.max_error = (std::max)(error.max_error, max_difference);
+						sum += max_difference;
+						max_value = (std::max)(max_value, (std::max)((std::max)(expected.x, expected.y), expected.z));
+					}
+				}
+			}
+			if (max_value > 0.0f) {
+				error.max_error /= max_value;
+				error.mean_error = static_cast<f32>(sum / lut.texels.size()) / max_value;
+			}
+		};
+
+		compare(reference.m_transmittance_lut, errors[0], [&](u32 x, u32 y, u32) {
+			f32 r, mu;
+			GetRMuFromTransmittanceTextureUv(reference_atmosphere, Math::vec2((x + 0.5f) / reference_atmosphere.lut.transmittance_width,
+				(y + 0.5f) / reference_atmosphere.lut.transmittance_height), r, mu);
+			return GetTransmittanceToTopAtmosphereBoundary(atmosphere, other.m_transmittance_lut, r, mu);
+		});
+		compare(reference.m_irradiance_lut, errors[1], [&](u32 x, u32 y, u32) {
+			f32 r, mu_s;
+			GetRMuSFromIrradianceTextureUv(reference_atmosphere, Math::vec2((x + 0.5f) / reference_atmosphere.lut.irradiance_width,
+				(y + 0.5f) / reference_atmosphere.lut.irradiance_height), r, mu_s);
+			return GetIrradiance(atmosphere, other.m_irradiance_lut, r, mu_s);
+		});
+		compare(reference.m_scattering_lut, errors[2], [&](u32 x, u32 y, u32 z) {
+			f32 r, mu, mu_s, nu;
+			bool ray_r_mu_intersects_ground;
+			GetRMuMuSNuFromScatteringTextureFragCoord(reference_atmosphere, Math::vec3(x + 0.5f, y + 0.5f, z + 0.5f), r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			return GetScattering(atmosphere, other.m_scattering_lut, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+		});
+		return errors;
+	}
+
+}
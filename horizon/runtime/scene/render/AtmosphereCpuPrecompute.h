@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <runtime/core/math/Math.h>
+
+namespace Horizon
+{
+	// presets of the lut resolutions and texel formats, LUT_QUALITY_* of definations.glsl. the errors against HIGH
+	// are from Atmosphere::MeasureLutQualities, relative to the largest lut value
+	enum class AtmosphereLutQuality
+	{
+		// 64 MiB
+		HIGH,
+		// HIGH in half precision, 32 MiB. scattering within 1.6% of HIGH, 0.05% on average
+		MEDIUM,
+		// half the resolution of HIGH along every axis but nu, in half precision, 4 MiB. scattering within 18% of
+		// HIGH where it changes fastest at the horizon, 0.3% on average
+		LOW
+	};
+
+	// lut sizes of definations.glsl for a preset
+	struct AtmosphereLutDesc
+	{
+		u32 transmittance_width, transmittance_height;
+		u32 irradiance_width, irradiance_height;
+		u32 scattering_r_size, scattering_mu_size, scattering_mu_s_size, scattering_nu_size;
+		// rgba16f irradiance and scattering luts. the transmittance lut stays rgba32f, the transmittance between two
+		// points is the ratio of two of its texels
+		bool half_precision;
+		// appended to the names of the shaders compileshaders.py builds for the preset
+		const char* shader_suffix;
+
+		static AtmosphereLutDesc Get(AtmosphereLutQuality quality) noexcept;
+		u32 GetScatteringWidth() const noexcept;
+		// bytes of every lut of the precompute chain, without the second set of an update
+		u64 GetMemorySize() const noexcept;
+	};
+
+	// cpu port of the lut precompute in assets/shaders/atmosphere, with the parameters, sample counts and texel
+	// layouts of the compute shaders. bakes the lut cache on machines without a gpu and validates the gpu luts.
+	// rows of texels are spread over threads and the lut filtering loads each rgba texel into one sse register. the
+	// integrals per texel stay scalar, glm is built without intrinsics
+	class AtmosphereCpuPrecompute
+	{
+	public:
+		// rgba32f texels, x fastest then y then z, the layout Texture::Upload expects
+		struct Lut
+		{
+			u32 width = 0, height = 0, depth = 1;
+			// texels are rounded to half precision when stored, like the writes to an rgba16f image
+			bool half_precision = false;
+			std::vector<Math::vec4> texels;
+
+			Lut() noexcept = default;
+			Lut(u32 _width, u32 _height, u32 _depth, bool _half_precision = false) noexcept;
+			// linear filtering with clamp to edge, like the lut samplers
+			Math::vec4 Sample(Math::vec2 uv) const noexcept;
+			Math::vec4 Sample(Math::vec3 uvw) const noexcept;
+			// the value a texel holds once stored
+			Math::vec4 Round(Math::vec4 value) const noexcept;
+			// rgba16f data for half precision luts
+			std::vector<u8> GetData() const noexcept;
+		};
+
+		// differences of the luts of a preset from the reference ones, relative to the largest reference value
+		struct LutError
+		{
+			f32 max_error = 0.0f;
+			f32 mean_error = 0.0f;
+		};
+
+		// a thread_count of 0 uses every hardware thread
+		explicit AtmosphereCpuPrecompute(u32 thread_count = 0) noexcept;
+		~AtmosphereCpuPrecompute() noexcept;
+
+		// the whole chain, scattering orders 2 to multi_scattering_order + 1 like Atmosphere::PrecomputeLuts
+		void Precompute(u32 multi_scattering_order, f32 haze = 1.0f, AtmosphereLutQuality quality = AtmosphereLutQuality::HIGH) noexcept;
+
+		const Lut& GetTransmittanceLut() const noexcept;
+		const Lut& GetIrradianceLut() const noexcept;
+		const Lut& GetScatteringLut() const noexcept;
+		// milliseconds the last Precompute took
+		f32 GetTime() const noexcept;
+		u32 GetThreadCount() const noexcept;
+
+		// largest difference of the texels read back from the gpu, relative to the largest reference value
+		static f32 Compare(const Lut& reference, const std::vector<u8>& data) noexcept;
+		// samples the luts of a precompute at another quality where the reference texels are, in the order
+		// transmittance, irradiance, scattering. both need the same haze
+		static std::array<LutError, 3> CompareQuality(const AtmosphereCpuPrecompute& reference, const AtmosphereCpuPrecompute& other) noexcept;
+
+	private:
+		// calls texel(x, y, z) for every texel, rows of the lut are handed out to the threads
+		template <typename TexelFunc>
+		void ForEachTexel(Lut& lut, const TexelFunc& texel) const noexcept;
+
+		u32 m_thread_count;
+		f32 m_time = 0.0f;
+		f32 m_haze = 1.0f;
+		AtmosphereLutQuality m_quality = AtmosphereLutQuality::HIGH;
+		Lut m_transmittance_lut, m_irradiance_lut, m_scattering_lut;
+	};
+
+}
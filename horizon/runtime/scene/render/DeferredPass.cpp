@@ -0,0 +1,116 @@
+#include "DeferredPass.h"
+
+#include <runtime/function/rhi/RenderContext.h>
+#include <runtime/core/path/Path.h>
+
+namespace Horizon
+{
+	DeferredPass::DeferredPass(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context) noexcept : m_scene(_scene)
+	{
+		// same formats as the geometry pass, see gbuffer.glsl
+		constexpr AttachmentUsage gbuffer_usage = COLOR_ATTACHMENT | INPUT_ATTACHMENT;
+		std::vector<AttachmentCreateInfo> attachments_create_info{
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RG16_SNORM, gbuffer_usage, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB, gbuffer_usage, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RG8_UNORM, gbuffer_usage, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_D32_SFLOAT, DEPTH_STENCIL_ATTACHMENT | INPUT_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1}
+		};
+
+		SubpassCreateInfo geometry_subpass;
+		geometry_subpass.color_attachments = { ATTACHMENT_NORMAL, ATTACHMENT_ALBEDO, ATTACHMENT_ROUGHNESS_METALLIC };
+		geometry_subpass.depth_attachment = true;
+
+		// input attachment indices of shading.frag
+		SubpassCreateInfo lighting_subpass;
+		lighting_subpass.color_attachments = { ATTACHMENT_LIGHTING };
+		lighting_subpass.input_attachments = { ATTACHMENT_DEPTH, ATTACHMENT_NORMAL, ATTACHMENT_ALBEDO, ATTACHMENT_ROUGHNESS_METALLIC };
+
+		// the sky samples the lighting and the depth, the rest of the g buffer stays in tile memory
+		std::vector<u32> read_after{ ATTACHMENT_LIGHTING, ATTACHMENT_DEPTH };
+
+		m_framebuffer = std::make_shared<Framebuffer>(_device, attachments_create_info, std::vector<SubpassCreateInfo>{ geometry_subpass, lighting_subpass }, read_after, _render_context);
+
+		GraphicsPipelineCreateInfo geometry_pipeline_create_info;
+		geometry_pipeline_create_info.name = "geometry_subpass";
+		geometry_pipeline_create_info.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("geometry.vert.spv"));
+		geometry_pipeline_create_info.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("geometry.frag.spv"));
+		geometry_pipeline_create_info.descriptor_layouts = _scene->GetGeometryPassDescriptorLayouts();
+		geometry_pipeline_create_info.framebuffer = m_framebuffer;
+		geometry_pipeline_create_info.subpass = 0;
+		geometry_pipeline_create_info.dynamic_resolution = true;
+		m_geometry_pipeline = _pipeline_manager->CreateGraphicsPipeline(geometry_pipeline_create_info, {}, _render_context);
+
+		std::shared_ptr<DescriptorSetInfo> descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		// g buffer: depth, normal, albedo, roughness metallic
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_INPUT_ATTACHMENT, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_INPUT_ATTACHMENT, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_INPUT_ATTACHMENT, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_INPUT_ATTACHMENT, SHADER_STAGE_PIXEL_SHADER);
+		// clustered light lists
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		m_descriptor_set = std::make_shared<DescriptorSet>(_device, descriptor_set_create_info);
+
+		std::shared_ptr<DescriptorSetLayouts> layouts = std::make_shared<DescriptorSetLayouts>();
+		layouts->layouts.push_back(m_descriptor_set->GetLayout());
+
+		GraphicsPipelineCreateInfo lighting_pipeline_create_info;
+		lighting_pipeline_create_info.name = "lighting_subpass";
+		lighting_pipeline_create_info.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("simplevs.vert.spv"));
+		lighting_pipeline_create_info.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("shading_subpass.frag.spv"));
+		lighting_pipeline_create_info.descriptor_layouts = layouts;
+		lighting_pipeline_create_info.framebuffer = m_framebuffer;
+		lighting_pipeline_create_info.subpass = 1;
+		lighting_pipeline_create_info.dynamic_resolution = true;
+		m_lighting_pipeline = _pipeline_manager->CreateGraphicsPipeline(lighting_pipeline_create_info, {}, _render_context);
+
+		m_descriptor_set_update_desc.BindResource(3, m_framebuffer->getDescriptorImageInfo(ATTACHMENT_DEPTH));
+		m_descriptor_set_update_desc.BindResource(4, m_framebuffer->getDescriptorImageInfo(ATTACHMENT_NORMAL));
+		m_descriptor_set_update_desc.BindResource(5, m_framebuffer->getDescriptorImageInfo(ATTACHMENT_ALBEDO));
+		m_descriptor_set_update_desc.BindResource(6, m_framebuffer->getDescriptorImageInfo(ATTACHMENT_ROUGHNESS_METALLIC));
+	}
+
+	DeferredPass::~DeferredPass() noexcept
+	{
+	}
+
+	void DeferredPass::BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept
+	{
+		m_descriptor_set_update_desc.BindResource(binding, buffer);
+	}
+
+	void DeferredPass::UpdateDescriptorSets() noexcept
+	{
+		m_descriptor_set->UpdateDescriptorSet(m_descriptor_set_update_desc);
+	}
+
+	void DeferredPass::Render(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<FullscreenTriangle> _fullscreen_triangle) noexcept
+	{
+		_command_buffer->beginRenderPass(_i, m_geometry_pipeline);
+		m_scene->RecordDraws(_i, _command_buffer, m_geometry_pipeline);
+		_command_buffer->nextSubpass(_i);
+		_fullscreen_triangle->Record(_i, _command_buffer, m_lighting_pipeline, { m_descriptor_set });
+		_command_buffer->endRenderPass(_i);
+	}
+
+	std::shared_ptr<Pipeline> DeferredPass::GetGeometryPipeline() const noexcept
+	{
+		return m_geometry_pipeline;
+	}
+
+	std::shared_ptr<AttachmentDescriptor> DeferredPass::GetLightingOutput() const noexcept
+	{
+		return m_framebuffer->getDescriptorImageInfo(ATTACHMENT_LIGHTING);
+	}
+
+	std::shared_ptr<AttachmentDescriptor> DeferredPass::GetDepth() const noexcept
+	{
+		return m_framebuffer->getDescriptorImageInfo(ATTACHMENT_DEPTH);
+	}
+
+}
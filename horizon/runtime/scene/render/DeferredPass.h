@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/function/rhi/vulkan/Descriptors.h>
+#include <runtime/function/rhi/vulkan/Framebuffer.h>
+#include <runtime/function/rhi/vulkan/Pipeline.h>
+#include <runtime/scene/scene/Scene.h>
+
+namespace Horizon
+{
+
+    // geometry and lighting as two subpasses of one render pass. the lighting subpass reads the g buffer as
+    // input attachments, so normal, albedo and roughness metallic never leave tile memory and are transient.
+    // only the lighting result and depth, which are sampled by the sky pass, are stored.
+    // bindings match LightPass, with 3 - 6 as input attachments bound by the pass itself
+    class DeferredPass
+    {
+    public:
+        DeferredPass(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context) noexcept;
+        ~DeferredPass() noexcept;
+
+        void UpdateDescriptorSets() noexcept;
+        void BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept;
+        // record both subpasses, light lists must be ready before the render pass begins
+        void Render(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<FullscreenTriangle> _fullscreen_triangle) noexcept;
+
+        std::shared_ptr<Pipeline> GetGeometryPipeline() const noexcept;
+        std::shared_ptr<AttachmentDescriptor> GetLightingOutput() const noexcept;
+        std::shared_ptr<AttachmentDescriptor> GetDepth() const noexcept;
+
+    private:
+        enum Attachments : u32 {
+            ATTACHMENT_NORMAL = 0,
+            ATTACHMENT_ALBEDO,
+            ATTACHMENT_ROUGHNESS_METALLIC,
+            ATTACHMENT_LIGHTING,
+            // depth stays last, render passes expect it there
+            ATTACHMENT_DEPTH
+        };
+
+        std::shared_ptr<Scene> m_scene;
+        std::shared_ptr<Framebuffer> m_framebuffer;
+        std::shared_ptr<Pipeline> m_geometry_pipeline;
+        std::shared_ptr<Pipeline> m_lighting_pipeline;
+        std::shared_ptr<DescriptorSet> m_descriptor_set;
+        DescriptorSetUpdateDesc m_descriptor_set_update_desc;
+    };
+
+}
@@ -0,0 +1,124 @@
+#include "DepthPyramid.h"
+
+#include <algorithm>
+
+#include <runtime/function/rhi/vulkan/ResourceBarrier.h>
+#include <runtime/function/rhi/RenderContext.h>
+#include <runtime/core/path/Path.h>
+
+namespace Horizon
+{
+	namespace {
+		u32 PreviousPowerOfTwo(u32 v) noexcept
+		{
+			u32 result = 1;
+			while (result * 2 <= v) {
+				result *= 2;
+			}
+			return result;
+		}
+	}
+
+	DepthPyramid::DepthPyramid(std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<DescriptorBase> _depth, RenderContext &_render_context) noexcept : m_render_context(_render_context)
+	{
+		m_width = PreviousPowerOfTwo(_render_context.width);
+		m_height = PreviousPowerOfTwo(_render_context.height);
+		m_mip_levels = 1;
+		while ((std::max)(m_width, m_height) >> m_mip_levels) {
+			m_mip_levels++;
+		}
+
+		TextureCreateInfo pyramid_create_info{ TextureType::TEXTURE_TYPE_2D, TextureFormat::TEXTURE_FORMAT_R32_SFLOAT, TextureUsage::TEXTURE_USAGE_RW, m_width, m_height, 1, m_mip_levels };
+		m_pyramid = std::make_shared<Texture>(_device, _command_buffer, pyramid_create_info);
+
+		std::shared_ptr<DescriptorSetInfo> descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE, SHADER_STAGE_COMPUTE_SHADER);
+
+		// one descriptor set per level, level n reads level n - 1
+		m_descriptor_sets.resize(m_mip_levels);
+		m_levels.resize(m_mip_levels);
+		for (u32 mip = 0; mip < m_mip_levels; mip++) {
+			m_descriptor_sets[mip] = std::make_shared<DescriptorSet>(_device, descriptor_set_create_info);
+
+			DescriptorSetUpdateDesc desc;
+			desc.BindResource(0, mip == 0 ? _depth : m_pyramid->GetMipDescriptor(mip - 1));
+			desc.BindResource(1, m_pyramid->GetMipDescriptor(mip));
+			m_descriptor_sets[mip]->UpdateDescriptorSet(desc);
+
+			m_levels[mip].src_size = mip == 0 ? Math::ivec2(_render_context.width, _render_context.height) : m_levels[mip - 1].dst_size;
+			m_levels[mip].dst_size = Math::ivec2((std::max)(m_width >> mip, 1u), (std::max)(m_height >> mip, 1u));
+		}
+
+		std::shared_ptr<DescriptorSetLayouts> layouts = std::make_shared<DescriptorSetLayouts>();
+		layouts->layouts.push_back(m_descriptor_sets[0]->GetLayout());
+
+		m_push_constants = std::make_shared<PushConstants>();
+		m_push_constants->ranges = { {SHADER_STAGE_COMPUTE_SHADER, 0, sizeof(PyramidLevel)} };
+
+		ComputePipelineCreateInfo pipeline_create_info;
+		pipeline_create_info.name = "depth_pyramid";
+		pipeline_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("depth_pyramid.comp.spv"));
+		pipeline_create_info.descriptor_layouts = layouts;
+		pipeline_create_info.push_constants = m_push_constants;
+		m_pipeline = _pipeline_manager->CreateComputePipeline(pipeline_create_info);
+	}
+
+	DepthPyramid::~DepthPyramid() noexcept
+	{
+	}
+
+	void DepthPyramid::Build(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		// depth writes of the geometry pass
+		{
+			BarrierDesc desc;
+			MemoryBarrierDesc depth_barrier;
+			depth_barrier.src_access_mask = MemoryAccessFlags::ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			depth_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
+			desc.memory_barriers.push_back(depth_barrier);
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+
+		// the first level covers the render area only, so the pyramid uv matches the full screen uv
+		m_levels[0].src_size = Math::ivec2(m_render_context.GetRenderWidth(), m_render_context.GetRenderHeight());
+
+		for (u32 mip = 0; mip < m_mip_levels; mip++) {
+			m_pipeline->m_push_constants->ranges[0].value = &m_levels[mip];
+			u32 group_count_x = (static_cast<u32>(m_levels[mip].dst_size.x) + k_group_size - 1) / k_group_size;
+			u32 group_count_y = (static_cast<u32>(m_levels[mip].dst_size.y) + k_group_size - 1) / k_group_size;
+			_command_buffer->Dispatch(_i, m_pipeline, { m_descriptor_sets[mip] }, group_count_x, group_count_y, 1);
+
+			// the next level, or the culling pass after the last one, reads this level
+			BarrierDesc desc;
+			ImageMemoryBarrierDesc pyramid_barrier;
+			pyramid_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
+			pyramid_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
+			pyramid_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
+			pyramid_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
+			pyramid_barrier.texture = m_pyramid;
+			desc.image_memory_barriers.push_back(pyramid_barrier);
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+	}
+
+	std::shared_ptr<Texture> DepthPyramid::GetTexture() const noexcept
+	{
+		return m_pyramid;
+	}
+
+	Math::vec2 DepthPyramid::GetSize() const noexcept
+	{
+		return Math::vec2(static_cast<f32>(m_width), static_cast<f32>(m_height));
+	}
+
+	u32 DepthPyramid::GetMipLevels() const noexcept
+	{
+		return m_mip_levels;
+	}
+
+}
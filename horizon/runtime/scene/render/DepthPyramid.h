@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/function/rhi/vulkan/Descriptors.h>
+#include <runtime/function/rhi/vulkan/Pipeline.h>
+#include <runtime/function/rhi/vulkan/Texture.h>
+
+namespace Horizon
+{
+
+    // hierarchical z buffer, each texel holds the farthest (reverse z: smallest) depth of its footprint.
+    // the first level is the depth buffer size rounded down to a power of two so every level halves exactly,
+    // it is built from the render area of the depth buffer when the render scale is below one
+    class DepthPyramid
+    {
+    public:
+        DepthPyramid(std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<DescriptorBase> _depth, RenderContext &_render_context) noexcept;
+        ~DepthPyramid() noexcept;
+
+        // record the downsample chain, depth must have been written by a finished render pass
+        void Build(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+
+        std::shared_ptr<Texture> GetTexture() const noexcept;
+        Math::vec2 GetSize() const noexcept;
+        u32 GetMipLevels() const noexcept;
+
+    private:
+        struct PyramidLevel {
+            Math::ivec2 src_size;
+            Math::ivec2 dst_size;
+        };
+
+        static constexpr u32 k_group_size = 8;
+
+        RenderContext &m_render_context;
+        u32 m_width, m_height, m_mip_levels;
+        std::shared_ptr<Texture> m_pyramid;
+        std::shared_ptr<Pipeline> m_pipeline;
+        std::shared_ptr<PushConstants> m_push_constants;
+        std::vector<std::shared_ptr<DescriptorSet>> m_descriptor_sets;
+        std::vector<PyramidLevel> m_levels;
+    };
+
+}
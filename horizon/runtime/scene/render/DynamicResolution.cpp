@@ -0,0 +1,64 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Horizon
+{
+	DynamicResolution::DynamicResolution(RenderContext &_render_context) noexcept : m_render_context(_render_context)
+	{
+	}
+
+	DynamicResolution::~DynamicResolution() noexcept
+	{
+	}
+
+	void DynamicResolution::SetEnabled(bool enable) noexcept
+	{
+		m_enabled = enable;
+		if (!m_enabled) {
+			m_render_context.render_scale = 1.0f;
+		}
+	}
+
+	void DynamicResolution::SetTargetFrameTime(f32 milliseconds) noexcept
+	{
+		m_target_frame_time = milliseconds;
+	}
+
+	void DynamicResolution::SetScaleRange(f32 min_scale, f32 max_scale) noexcept
+	{
+		m_min_scale = std::clamp(min_scale, 0.1f, 1.0f);
+		m_max_scale = std::clamp(max_scale, m_min_scale, 1.0f);
+	}
+
+	void DynamicResolution::Update(f32 _gpu_time) noexcept
+	{
+		if (_gpu_time <= 0.0f) {
+			return;
+		}
+		m_smoothed_gpu_time = m_smoothed_gpu_time == 0.0f ? _gpu_time : m_smoothed_gpu_time + (_gpu_time - m_smoothed_gpu_time) * k_smoothing;
+
+		if (!m_enabled) {
+			return;
+		}
+
+		// the cost of the scene passes grows with the pixel count, the square of the scale
+		f32 scale = m_render_context.render_scale;
+		if (_gpu_time > m_target_frame_time * k_over_budget) {
+			// react to a spike within the next frame
+			scale *= std::sqrt(m_target_frame_time / _gpu_time);
+			m_smoothed_gpu_time = _gpu_time;
+		}
+		else if (m_smoothed_gpu_time < m_target_frame_time * k_headroom) {
+			scale = (std::min)(scale * std::sqrt(m_target_frame_time / m_smoothed_gpu_time), scale + k_max_increase);
+		}
+		m_render_context.render_scale = std::clamp(scale, m_min_scale, m_max_scale);
+	}
+
+	f32 DynamicResolution::GetSmoothedGpuTime() const noexcept
+	{
+		return m_smoothed_gpu_time;
+	}
+
+}
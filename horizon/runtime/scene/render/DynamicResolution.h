@@ -0,0 +1,41 @@
+#pragma once
+#include <runtime/function/rhi/RenderContext.h>
+
+namespace Horizon
+{
+
+    // picks RenderContext::render_scale so the gpu time of a frame, measured with a GpuTimer, stays at a target.
+    // the scale drops at once when a frame goes over budget and grows back slowly while there is headroom.
+    // attachments keep their full size, the scene passes only shrink their render area
+    class DynamicResolution
+    {
+    public:
+        DynamicResolution(RenderContext &_render_context) noexcept;
+        ~DynamicResolution() noexcept;
+
+        void SetEnabled(bool enable) noexcept;
+        void SetTargetFrameTime(f32 milliseconds) noexcept;
+        void SetScaleRange(f32 min_scale, f32 max_scale) noexcept;
+
+        // gpu time of the last finished frame in milliseconds, picks the scale of the next frame
+        void Update(f32 _gpu_time) noexcept;
+
+        f32 GetSmoothedGpuTime() const noexcept;
+
+    private:
+        // drop the scale when a frame takes longer than target * k_over_budget
+        static constexpr f32 k_over_budget = 1.05f;
+        // raise it when the smoothed time is below target * k_headroom
+        static constexpr f32 k_headroom = 0.85f;
+        static constexpr f32 k_max_increase = 0.02f;
+        static constexpr f32 k_smoothing = 0.1f;
+
+        RenderContext &m_render_context;
+
+        bool m_enabled = false;
+        f32 m_target_frame_time = 16.6f;
+        f32 m_min_scale = 0.5f, m_max_scale = 1.0f;
+        f32 m_smoothed_gpu_time = 0.0f;
+    };
+
+}
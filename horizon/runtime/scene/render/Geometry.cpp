@@ -12,25 +12,44 @@ namespace Horizon
 		geometryPipelineCreateInfo.name = "geometry";
 		geometryPipelineCreateInfo.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("geometry.vert.spv"));
 		geometryPipelineCreateInfo.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("geometry.frag.spv"));
+		// model matrices are read from the scene instance transforms, indexed by gl_InstanceIndex
 		geometryPipelineCreateInfo.descriptor_layouts = _scene->GetGeometryPassDescriptorLayouts();
+		geometryPipelineCreateInfo.dynamic_resolution = true;
 
-		std::shared_ptr<PushConstants> geometryPipelinePushConstants = std::make_shared<PushConstants>();
-
-		geometryPipelinePushConstants->ranges = {{SHADER_STAGE_VERTEX_SHADER, 0, 2 * sizeof(Math::mat4)}}; // Push constants have a minimum size of 128 bytes
-		geometryPipelineCreateInfo.push_constants = geometryPipelinePushConstants;
-		// position + depth
-		// normal
-		// albedo
-		// depth
+		// packed layout, 14 bytes per pixel, must match gbuffer.glsl
+		// 0: octahedral normal
+		// 1: albedo
+		// 2: roughness, metallic
+		// 3: depth, world position is reconstructed from it
+		// colors share memory with later targets, depth is dedicated because the depth pyramid binds its view at startup
 
 		std::vector<AttachmentCreateInfo> geometryAttachmentsCreateInfo{
-			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
-			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
-			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA32_SFLOAT, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RG16_SNORM, COLOR_ATTACHMENT | ALIASED_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB, COLOR_ATTACHMENT | ALIASED_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RG8_UNORM, COLOR_ATTACHMENT | ALIASED_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1},
 			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_D32_SFLOAT, DEPTH_STENCIL_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1}
 		};
 
 		m_pipeline = _pipeline_manager->CreateGraphicsPipeline(geometryPipelineCreateInfo, geometryAttachmentsCreateInfo, _render_context);
+
+		// depth pre-pass and the equal tested g buffer pass draw into the same framebuffer
+
+		GraphicsPipelineCreateInfo depth_prepass_create_info;
+		depth_prepass_create_info.name = "depth_prepass";
+		depth_prepass_create_info.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("depth_prepass.vert.spv"));
+		depth_prepass_create_info.descriptor_layouts = _scene->GetGeometryPassDescriptorLayouts();
+		depth_prepass_create_info.dynamic_resolution = true;
+		depth_prepass_create_info.position_only = true;
+		depth_prepass_create_info.framebuffer = std::static_pointer_cast<GraphicsPipeline>(m_pipeline)->GetFramebuffer();
+
+		m_depth_prepass_pipeline = _pipeline_manager->CreateGraphicsPipeline(depth_prepass_create_info, geometryAttachmentsCreateInfo, _render_context);
+
+		GraphicsPipelineCreateInfo depth_equal_create_info = geometryPipelineCreateInfo;
+		depth_equal_create_info.name = "geometry_depth_equal";
+		depth_equal_create_info.depth_equal = true;
+		depth_equal_create_info.framebuffer = depth_prepass_create_info.framebuffer;
+
+		m_depth_equal_pipeline = _pipeline_manager->CreateGraphicsPipeline(depth_equal_create_info, geometryAttachmentsCreateInfo, _render_context);
 	}
 
 	Geometry::~Geometry() noexcept
@@ -52,4 +71,14 @@ namespace Horizon
 		return m_pipeline;
 	}
 
+	std::shared_ptr<Pipeline> Geometry::GetDepthPrepassPipeline() const noexcept
+	{
+		return m_depth_prepass_pipeline;
+	}
+
+	std::shared_ptr<Pipeline> Geometry::GetDepthEqualPipeline() const noexcept
+	{
+		return m_depth_equal_pipeline;
+	}
+
 }
\ No newline at end of file
@@ -16,9 +16,15 @@ namespace Horizon
         void BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept;
         std::shared_ptr<AttachmentDescriptor> GetFrameBufferAttachment(u32 _index) const noexcept;
         std::shared_ptr<Pipeline> GetPipeline() const noexcept;
+        // depth only pass from the position stream into the g buffer depth, clears the color targets
+        std::shared_ptr<Pipeline> GetDepthPrepassPipeline() const noexcept;
+        // g buffer pass after the pre-pass, shades only the visible surface and keeps the depth
+        std::shared_ptr<Pipeline> GetDepthEqualPipeline() const noexcept;
 
     private:
         std::shared_ptr<Pipeline> m_pipeline;
+        std::shared_ptr<Pipeline> m_depth_prepass_pipeline;
+        std::shared_ptr<Pipeline> m_depth_equal_pipeline;
     };
 
 }
@@ -0,0 +1,352 @@
+#include "GpuDriven.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+
+#include <runtime/function/rhi/vulkan/VulkanEnums.h>
+#include <runtime/function/rhi/vulkan/ResourceBarrier.h>
+#include <runtime/function/rhi/RenderContext.h>
+#include <runtime/core/path/Path.h>
+#include <runtime/scene/culling/Frustum.h>
+
+namespace Horizon
+{
+	GpuDrivenGeometry::GpuDrivenGeometry(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _geometry_pipeline, RenderContext &_render_context) noexcept : m_scene(_scene), m_device(_device)
+	{
+		m_draw_indexed_indirect_count = m_device->GetDrawIndexedIndirectCountFunction();
+		m_compact_draws = m_draw_indexed_indirect_count != nullptr;
+		m_multi_draw_indirect = m_device->GetEnabledFeatures().multiDrawIndirect == VK_TRUE;
+
+		// culling pass
+
+		std::shared_ptr<DescriptorSetInfo> cull_descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		cull_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // cull params
+		cull_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // instances
+		cull_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // draw commands
+		cull_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // draw counts
+		cull_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // depth pyramid
+		cull_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // visibility
+		m_cull_descriptor_set = std::make_shared<DescriptorSet>(m_device, cull_descriptor_set_create_info);
+
+		std::shared_ptr<DescriptorSetLayouts> cull_layouts = std::make_shared<DescriptorSetLayouts>();
+		cull_layouts->layouts.push_back(m_cull_descriptor_set->GetLayout());
+
+		m_cull_push_constants = std::make_shared<PushConstants>();
+		m_cull_push_constants->ranges = { {SHADER_STAGE_COMPUTE_SHADER, 0, sizeof(u32)} };
+
+		ComputePipelineCreateInfo cull_pipeline_create_info;
+		cull_pipeline_create_info.name = "cull_instances";
+		cull_pipeline_create_info.cs = std::make_shared<Shader>(m_device->Get(), Path::GetInstance().GetShaderPath("cull_instances.comp.spv"));
+		cull_pipeline_create_info.descriptor_layouts = cull_layouts;
+		cull_pipeline_create_info.push_constants = m_cull_push_constants;
+		m_cull_pipeline = _pipeline_manager->CreateComputePipeline(cull_pipeline_create_info);
+
+		// indirect geometry pass, shares attachments with the regular geometry pass
+
+		std::shared_ptr<DescriptorSetInfo> instance_descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		instance_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_VERTEX_SHADER); // instances
+		instance_descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_VERTEX_SHADER); // transforms
+		m_instance_descriptor_set = std::make_shared<DescriptorSet>(m_device, instance_descriptor_set_create_info);
+
+		// scene and material sets, set 2 holds the culled instances instead of the scene instance transforms
+		std::shared_ptr<DescriptorSetLayouts> geometry_layouts = _scene->GetDescriptorLayouts();
+		geometry_layouts->layouts.push_back(m_instance_descriptor_set->GetLayout());
+
+		GraphicsPipelineCreateInfo geometry_pipeline_create_info;
+		geometry_pipeline_create_info.name = "geometry_indirect";
+		geometry_pipeline_create_info.vs = std::make_shared<Shader>(m_device->Get(), Path::GetInstance().GetShaderPath("geometry_indirect.vert.spv"));
+		geometry_pipeline_create_info.ps = std::make_shared<Shader>(m_device->Get(), Path::GetInstance().GetShaderPath("geometry.frag.spv"));
+		geometry_pipeline_create_info.descriptor_layouts = geometry_layouts;
+		geometry_pipeline_create_info.framebuffer = std::static_pointer_cast<GraphicsPipeline>(_geometry_pipeline)->GetFramebuffer();
+		geometry_pipeline_create_info.dynamic_resolution = true;
+		m_pipeline = _pipeline_manager->CreateGraphicsPipeline(geometry_pipeline_create_info, {}, _render_context);
+
+		// occlusion culling reads a pyramid of the geometry pass depth
+		m_depth_pyramid = std::make_shared<DepthPyramid>(_pipeline_manager, m_device, _command_buffer, std::static_pointer_cast<GraphicsPipeline>(_geometry_pipeline)->GetFrameBufferAttachment(3), _render_context);
+
+		// buffers grow when objects are added to the scene
+		m_cull_params_ub = std::make_shared<UniformBuffer>(m_device);
+		m_instance_buffer = std::make_shared<StorageBuffer>(m_device, 0);
+		m_transform_buffer = std::make_shared<StorageBuffer>(m_device, 0);
+		m_draw_command_buffer = std::make_shared<StorageBuffer>(m_device, 0, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, false);
+		m_draw_count_buffer = std::make_shared<StorageBuffer>(m_device, 0, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, false);
+		m_visibility_buffer = std::make_shared<StorageBuffer>(m_device, 0, VK_BUFFER_USAGE_TRANSFER_DST_BIT, false);
+	}
+
+	GpuDrivenGeometry::~GpuDrivenGeometry() noexcept
+	{
+	}
+
+	bool GpuDrivenGeometry::IsSupported(std::shared_ptr<Device> _device) noexcept
+	{
+		return _device->GetEnabledFeatures().drawIndirectFirstInstance == VK_TRUE;
+	}
+
+	void GpuDrivenGeometry::Update() noexcept
+	{
+		bool rebuilt = false;
+		m_reset_visibility = false;
+		if (m_scene->GetObjectsVersion() != m_objects_version) {
+			BuildInstances();
+			m_objects_version = m_scene->GetObjectsVersion();
+			rebuilt = true;
+			m_reset_visibility = true;
+		}
+		if (rebuilt || m_scene->GetBoundsVersion() != m_bounds_version) {
+			UploadInstances();
+			m_bounds_version = m_scene->GetBoundsVersion();
+		}
+
+		std::shared_ptr<Camera> camera = m_scene->GetMainCamera();
+		Math::mat4 view_projection = camera->GetProjectionMatrix() * camera->GetViewMatrix();
+		Frustum frustum(view_projection);
+		for (u32 i = 0; i < 6; i++) {
+			m_cull_params_ubdata.planes[i] = frustum.planes[i];
+		}
+		m_cull_params_ubdata.view_projection = view_projection;
+		m_cull_params_ubdata.pyramid_size = m_depth_pyramid->GetSize();
+		m_cull_params_ubdata.instance_count = static_cast<u32>(m_instances.size());
+		m_cull_params_ubdata.compact_draws = m_compact_draws ? 1 : 0;
+		m_cull_params_ubdata.pyramid_mip_levels = m_depth_pyramid->GetMipLevels();
+		m_cull_params_ubdata.occlusion_culling = m_occlusion_culling ? 1 : 0;
+		m_cull_params_ub->update(&m_cull_params_ubdata, sizeof(CullParamsUb));
+
+		// storage buffers may have been recreated
+		if (rebuilt) {
+			UpdateDescriptorSets();
+		}
+	}
+
+	void GpuDrivenGeometry::Render(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		Cull(_i, _command_buffer, 0);
+		Draw(_i, _command_buffer, false);
+		if (!m_occlusion_culling || m_instances.empty()) {
+			return;
+		}
+
+		m_depth_pyramid->Build(_i, _command_buffer);
+
+		// phase 0 draws must be done reading the commands and counts before they are rewritten
+		{
+			BarrierDesc desc;
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_TRANSFER_BIT | PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+
+		Cull(_i, _command_buffer, 1);
+		Draw(_i, _command_buffer, true);
+	}
+
+	void GpuDrivenGeometry::SetOcclusionCulling(bool _enable) noexcept
+	{
+		// instances culled by occlusion would never come back through phase 0 alone
+		if (_enable && !m_occlusion_culling) {
+			m_objects_version = ~0ull;
+		}
+		m_occlusion_culling = _enable;
+	}
+
+	void GpuDrivenGeometry::Cull(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, u32 _phase) noexcept
+	{
+		if (m_instances.empty()) {
+			return;
+		}
+		VkCommandBuffer command_buffer = _command_buffer->Get(_i);
+
+		if (m_reset_visibility && _phase == 0) {
+			vkCmdFillBuffer(command_buffer, m_visibility_buffer->Get(), 0, VK_WHOLE_SIZE, 1);
+
+			BarrierDesc desc;
+			BufferMemoryBarrierDesc visibility_barrier;
+			visibility_barrier.src_access_mask = MemoryAccessFlags::ACCESS_TRANSFER_WRITE_BIT;
+			visibility_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(MemoryAccessFlags::ACCESS_SHADER_READ_BIT | MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT);
+			visibility_barrier.buffer = m_visibility_buffer->Get();
+			visibility_barrier.offset = 0;
+			visibility_barrier.size = static_cast<u32>(m_visibility_buffer->size());
+			desc.buffer_memory_barriers.push_back(visibility_barrier);
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_TRANSFER_BIT;
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+
+		if (m_compact_draws) {
+			vkCmdFillBuffer(command_buffer, m_draw_count_buffer->Get(), 0, VK_WHOLE_SIZE, 0);
+
+			BarrierDesc desc;
+			BufferMemoryBarrierDesc draw_count_barrier;
+			draw_count_barrier.src_access_mask = MemoryAccessFlags::ACCESS_TRANSFER_WRITE_BIT;
+			draw_count_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(MemoryAccessFlags::ACCESS_SHADER_READ_BIT | MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT);
+			draw_count_barrier.buffer = m_draw_count_buffer->Get();
+			draw_count_barrier.offset = 0;
+			draw_count_barrier.size = static_cast<u32>(m_draw_count_buffer->size());
+			desc.buffer_memory_barriers.push_back(draw_count_barrier);
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_TRANSFER_BIT;
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+
+		m_cull_pipeline->m_push_constants->ranges[0].value = &m_cull_phases[_phase];
+		u32 group_count = (static_cast<u32>(m_instances.size()) + k_cull_group_size - 1) / k_cull_group_size;
+		_command_buffer->Dispatch(_i, m_cull_pipeline, { m_cull_descriptor_set }, group_count, 1, 1);
+
+		// make commands and counts visible to the indirect draws
+		{
+			BarrierDesc desc;
+			BufferMemoryBarrierDesc draw_command_barrier;
+			draw_command_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
+			draw_command_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_INDIRECT_COMMAND_READ_BIT;
+			draw_command_barrier.buffer = m_draw_command_buffer->Get();
+			draw_command_barrier.offset = 0;
+			draw_command_barrier.size = static_cast<u32>(m_draw_command_buffer->size());
+			desc.buffer_memory_barriers.push_back(draw_command_barrier);
+
+			if (m_compact_draws) {
+				BufferMemoryBarrierDesc draw_count_barrier = draw_command_barrier;
+				draw_count_barrier.buffer = m_draw_count_buffer->Get();
+				draw_count_barrier.size = static_cast<u32>(m_draw_count_buffer->size());
+				desc.buffer_memory_barriers.push_back(draw_count_barrier);
+			}
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			// phase 1 also has to wait for the pyramid reads before depth is written again
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_DRAW_INDIRECT_BIT | PipelineStageFlags::PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+	}
+
+	void GpuDrivenGeometry::Draw(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, bool _load_attachments) noexcept
+	{
+		_command_buffer->beginRenderPass(_i, m_pipeline, false, _load_attachments);
+		VkCommandBuffer command_buffer = _command_buffer->Get(_i);
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->Get());
+
+		const u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+		std::shared_ptr<Model> bound_model = nullptr;
+		for (u32 batch_index = 0; batch_index < m_batches.size(); batch_index++) {
+			const DrawBatch& batch = m_batches[batch_index];
+			if (batch.model != bound_model) {
+				batch.model->BindBuffers(command_buffer);
+				bound_model = batch.model;
+			}
+			std::vector<VkDescriptorSet> descriptors{ m_scene->GetSceneDescriptorSet()->Get(), batch.material->m_material_descriptor_set->Get(), m_instance_descriptor_set->Get() };
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline->GetLayout(), 0, descriptors.size(), descriptors.data(), 0, 0);
+
+			VkDeviceSize offset = static_cast<VkDeviceSize>(batch.command_offset) * stride;
+			if (m_compact_draws) {
+				m_draw_indexed_indirect_count(command_buffer, m_draw_command_buffer->Get(), offset, m_draw_count_buffer->Get(), batch_index * sizeof(u32), batch.command_count, stride);
+			}
+			else if (m_multi_draw_indirect) {
+				vkCmdDrawIndexedIndirect(command_buffer, m_draw_command_buffer->Get(), offset, batch.command_count, stride);
+			}
+			else {
+				for (u32 j = 0; j < batch.command_count; j++) {
+					vkCmdDrawIndexedIndirect(command_buffer, m_draw_command_buffer->Get(), offset + j * stride, 1, stride);
+				}
+			}
+		}
+		_command_buffer->endRenderPass(_i);
+	}
+
+	std::shared_ptr<Pipeline> GpuDrivenGeometry::GetPipeline() const noexcept
+	{
+		return m_pipeline;
+	}
+
+	void GpuDrivenGeometry::BuildInstances() noexcept
+	{
+		const std::vector<RenderObject>& objects = m_scene->GetRenderObjects();
+
+		// group by model then material, each group becomes one indirect draw
+		m_instance_objects.resize(objects.size());
+		std::iota(m_instance_objects.begin(), m_instance_objects.end(), 0);
+		std::stable_sort(m_instance_objects.begin(), m_instance_objects.end(), [&objects](u32 a, u32 b) {
+			const RenderObject& lhs = objects[a];
+			const RenderObject& rhs = objects[b];
+			if (lhs.model != rhs.model) {
+				return std::less<Model*>()(lhs.model.get(), rhs.model.get());
+			}
+			return std::less<Material*>()(lhs.primitive->material.get(), rhs.primitive->material.get());
+		});
+
+		// primitives of a node placed by the same model instance share a transform
+		std::unordered_map<u64, u32> transform_indices;
+		std::unordered_map<Material*, u32> material_indices;
+		m_instances.resize(objects.size());
+		m_transform_objects.clear();
+		m_batches.clear();
+
+		for (u32 i = 0; i < m_instance_objects.size(); i++) {
+			const RenderObject& object = objects[m_instance_objects[i]];
+			std::shared_ptr<Material> material = object.primitive->material;
+
+			if (m_batches.empty() || m_batches.back().model != object.model || m_batches.back().material != material) {
+				m_batches.push_back(DrawBatch{ object.model, material, i, 0 });
+			}
+			DrawBatch& batch = m_batches.back();
+			batch.command_count++;
+
+			u64 transform_key = (static_cast<u64>(object.mesh_id) << 32) | object.instance;
+			auto transform = transform_indices.find(transform_key);
+			if (transform == transform_indices.end()) {
+				transform = transform_indices.emplace(transform_key, static_cast<u32>(m_transform_objects.size())).first;
+				m_transform_objects.push_back(m_instance_objects[i]);
+			}
+			auto material_index = material_indices.emplace(material.get(), static_cast<u32>(material_indices.size())).first;
+
+			GpuInstance& instance = m_instances[i];
+			instance.transform_index = transform->second;
+			instance.material_index = material_index->second;
+			instance.batch_index = static_cast<u32>(m_batches.size() - 1);
+			instance.command_base = batch.command_offset;
+			instance.command_slot = i;
+			instance.first_index = object.primitive->firstIndex;
+			instance.index_count = object.primitive->indexCount;
+			instance.pad = 0;
+		}
+		m_transforms.resize(m_transform_objects.size());
+
+		m_instance_buffer->reserve(m_instances.size() * sizeof(GpuInstance));
+		m_transform_buffer->reserve(m_transforms.size() * sizeof(Math::mat4));
+		m_draw_command_buffer->reserve(m_instances.size() * sizeof(VkDrawIndexedIndirectCommand));
+		m_draw_count_buffer->reserve(m_batches.size() * sizeof(u32));
+		m_visibility_buffer->reserve(m_instances.size() * sizeof(u32));
+	}
+
+	void GpuDrivenGeometry::UploadInstances() noexcept
+	{
+		const BoundsSoA& bounds = m_scene->GetWorldBounds();
+		for (u32 i = 0; i < m_instances.size(); i++) {
+			BoundingBox box = bounds.Get(m_instance_objects[i]);
+			m_instances[i].bounds_center = Math::vec4(box.Center(), 0.0f);
+			m_instances[i].bounds_extent = Math::vec4(box.Extent(), 0.0f);
+		}
+		for (u32 i = 0; i < m_transforms.size(); i++) {
+			m_transforms[i] = m_scene->GetObjectTransform(m_transform_objects[i]);
+		}
+		if (!m_instances.empty()) {
+			m_instance_buffer->update(m_instances.data(), m_instances.size() * sizeof(GpuInstance));
+			m_transform_buffer->update(m_transforms.data(), m_transforms.size() * sizeof(Math::mat4));
+		}
+	}
+
+	void GpuDrivenGeometry::UpdateDescriptorSets() noexcept
+	{
+		DescriptorSetUpdateDesc cull_desc;
+		cull_desc.BindResource(0, m_cull_params_ub);
+		cull_desc.BindResource(1, m_instance_buffer);
+		cull_desc.BindResource(2, m_draw_command_buffer);
+		cull_desc.BindResource(3, m_draw_count_buffer);
+		cull_desc.BindResource(4, m_depth_pyramid->GetTexture());
+		cull_desc.BindResource(5, m_visibility_buffer);
+		m_cull_descriptor_set->UpdateDescriptorSet(cull_desc);
+
+		DescriptorSetUpdateDesc instance_desc;
+		instance_desc.BindResource(0, m_instance_buffer);
+		instance_desc.BindResource(1, m_transform_buffer);
+		m_instance_descriptor_set->UpdateDescriptorSet(instance_desc);
+	}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <runtime/function/rhi/vulkan/Descriptors.h>
+#include <runtime/function/rhi/vulkan/Pipeline.h>
+#include <runtime/function/rhi/vulkan/StorageBuffer.h>
+#include <runtime/function/rhi/vulkan/UniformBuffer.h>
+#include <runtime/scene/render/DepthPyramid.h>
+#include <runtime/scene/scene/Scene.h>
+
+namespace Horizon
+{
+
+    // geometry pass driven by the gpu: a compute pass frustum culls every render object and writes
+    // the indirect draw commands, the cpu only records one indirect draw per (model, material) batch.
+    // with occlusion culling the pass runs twice: phase 0 draws what was visible last frame, a depth
+    // pyramid is built from that depth, and phase 1 tests everything against it to draw disoccluded objects
+    class GpuDrivenGeometry
+    {
+    public:
+        GpuDrivenGeometry(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _geometry_pipeline, RenderContext &_render_context) noexcept;
+        ~GpuDrivenGeometry() noexcept;
+
+        // gl_InstanceIndex is used to fetch instances, so first instance must be honored by indirect draws
+        static bool IsSupported(std::shared_ptr<Device> _device) noexcept;
+
+        // upload instances when the scene changed and the frustum of this frame
+        void Update() noexcept;
+        // record culling and drawing of the geometry pass
+        void Render(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+
+        void SetOcclusionCulling(bool _enable) noexcept;
+        std::shared_ptr<Pipeline> GetPipeline() const noexcept;
+
+    private:
+        void Cull(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, u32 _phase) noexcept;
+        void Draw(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, bool _load_attachments) noexcept;
+        void BuildInstances() noexcept;
+        void UploadInstances() noexcept;
+        void UpdateDescriptorSets() noexcept;
+
+    private:
+        // std430 layout, must match cull_instances.comp and geometry_indirect.vert
+        struct GpuInstance {
+            Math::vec4 bounds_center;
+            Math::vec4 bounds_extent;
+            u32 transform_index;
+            u32 material_index;
+            u32 batch_index;
+            u32 command_base;
+            u32 command_slot;
+            u32 first_index;
+            u32 index_count;
+            u32 pad;
+        };
+
+        struct CullParamsUb {
+            Math::vec4 planes[6];
+            Math::mat4 view_projection;
+            Math::vec2 pyramid_size;
+            u32 instance_count;
+            u32 compact_draws;
+            u32 pyramid_mip_levels;
+            u32 occlusion_culling;
+            u32 pad0, pad1;
+        } m_cull_params_ubdata;
+
+        // render objects sharing vertex/index buffers and material, drawn with a single indirect call
+        struct DrawBatch {
+            std::shared_ptr<Model> model;
+            std::shared_ptr<Material> material;
+            u32 command_offset;
+            u32 command_count;
+        };
+
+        static constexpr u32 k_cull_group_size = 64;
+
+        std::shared_ptr<Scene> m_scene;
+        std::shared_ptr<Device> m_device;
+        std::shared_ptr<Pipeline> m_pipeline;
+        std::shared_ptr<Pipeline> m_cull_pipeline;
+
+        std::shared_ptr<DescriptorSet> m_cull_descriptor_set;
+        std::shared_ptr<DescriptorSet> m_instance_descriptor_set;
+
+        std::shared_ptr<UniformBuffer> m_cull_params_ub;
+        std::shared_ptr<StorageBuffer> m_instance_buffer;
+        std::shared_ptr<StorageBuffer> m_transform_buffer;
+        std::shared_ptr<StorageBuffer> m_draw_command_buffer;
+        std::shared_ptr<StorageBuffer> m_draw_count_buffer;
+        std::shared_ptr<StorageBuffer> m_visibility_buffer;
+
+        std::shared_ptr<DepthPyramid> m_depth_pyramid;
+        std::shared_ptr<PushConstants> m_cull_push_constants;
+        u32 m_cull_phases[2] = { 0, 1 };
+        bool m_occlusion_culling = true;
+        // every instance counts as visible after the instance list changed
+        bool m_reset_visibility = false;
+
+        std::vector<GpuInstance> m_instances;
+        std::vector<Math::mat4> m_transforms;
+        // render object index for each instance, instances are sorted by batch
+        std::vector<u32> m_instance_objects;
+        // a render object using each transform slot
+        std::vector<u32> m_transform_objects;
+        std::vector<DrawBatch> m_batches;
+
+        // draw count comes from the gpu with VK_KHR_draw_indirect_count, otherwise culled commands draw zero instances
+        bool m_compact_draws = false;
+        bool m_multi_draw_indirect = false;
+        PFN_vkCmdDrawIndexedIndirectCountKHR m_draw_indexed_indirect_count = nullptr;
+
+        u64 m_objects_version = ~0ull;
+        u64 m_bounds_version = ~0ull;
+    };
+
+}
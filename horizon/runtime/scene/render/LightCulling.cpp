@@ -0,0 +1,123 @@
+#include "LightCulling.h"
+
+#include <cmath>
+
+#include <runtime/function/rhi/vulkan/ResourceBarrier.h>
+#include <runtime/function/rhi/RenderContext.h>
+#include <runtime/core/path/Path.h>
+
+namespace Horizon
+{
+	LightCulling::LightCulling(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context) noexcept : m_scene(_scene), m_render_context(_render_context)
+	{
+		// sized for the full resolution, Update shrinks the grid to the render area
+		u32 tiles_x = (_render_context.width + k_tile_size - 1) / k_tile_size;
+		u32 tiles_y = (_render_context.height + k_tile_size - 1) / k_tile_size;
+		m_cluster_count = tiles_x * tiles_y * k_slice_count;
+		m_cluster_params_ubdata.grid_size = Math::uvec4(tiles_x, tiles_y, k_slice_count, k_tile_size);
+		m_cluster_params_ubdata.index_capacity = m_cluster_count * k_average_lights_per_cluster;
+
+		std::shared_ptr<DescriptorSetInfo> descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // cluster params
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // light count
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // lights
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // light grid
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // light indices
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // light index counter
+		m_descriptor_set = std::make_shared<DescriptorSet>(_device, descriptor_set_create_info);
+
+		std::shared_ptr<DescriptorSetLayouts> layouts = std::make_shared<DescriptorSetLayouts>();
+		layouts->layouts.push_back(m_descriptor_set->GetLayout());
+
+		ComputePipelineCreateInfo pipeline_create_info;
+		pipeline_create_info.name = "light_clustering";
+		pipeline_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("light_clustering.comp.spv"));
+		pipeline_create_info.descriptor_layouts = layouts;
+		m_pipeline = _pipeline_manager->CreateComputePipeline(pipeline_create_info);
+
+		m_cluster_params_ub = std::make_shared<UniformBuffer>(_device);
+		m_light_grid = std::make_shared<StorageBuffer>(_device, m_cluster_count * sizeof(Math::uvec2), 0, false);
+		m_light_indices = std::make_shared<StorageBuffer>(_device, m_cluster_params_ubdata.index_capacity * sizeof(u32), 0, false);
+		m_light_index_counter = std::make_shared<StorageBuffer>(_device, sizeof(u32), VK_BUFFER_USAGE_TRANSFER_DST_BIT, false);
+	}
+
+	LightCulling::~LightCulling() noexcept
+	{
+	}
+
+	void LightCulling::Update() noexcept
+	{
+		std::shared_ptr<Camera> camera = m_scene->GetMainCamera();
+		Math::vec2 near_far = camera->GetNearFarPlane();
+
+		m_cluster_params_ubdata.view = camera->GetViewMatrix();
+		m_cluster_params_ubdata.inverse_projection = Math::inverse(camera->GetProjectionMatrix());
+		u32 render_width = m_render_context.GetRenderWidth();
+		u32 render_height = m_render_context.GetRenderHeight();
+		m_cluster_params_ubdata.grid_size.x = (render_width + k_tile_size - 1) / k_tile_size;
+		m_cluster_params_ubdata.grid_size.y = (render_height + k_tile_size - 1) / k_tile_size;
+		m_cluster_params_ubdata.screen_size_near_far = Math::vec4(static_cast<f32>(render_width), static_cast<f32>(render_height), near_far.x, near_far.y);
+
+		// slice k starts at near * (far / near)^(k / slices)
+		f32 log_far_over_near = std::log(near_far.y / near_far.x);
+		f32 slice_scale = static_cast<f32>(k_slice_count) / log_far_over_near;
+		f32 slice_bias = -static_cast<f32>(k_slice_count) * std::log(near_far.x) / log_far_over_near;
+		m_cluster_params_ubdata.slice_scale_bias = Math::vec4(slice_scale, slice_bias, 0.0f, 0.0f);
+		m_cluster_params_ub->update(&m_cluster_params_ubdata, sizeof(ClusterParamsUb));
+
+		DescriptorSetUpdateDesc desc;
+		desc.BindResource(0, m_cluster_params_ub);
+		desc.BindResource(1, m_scene->m_light_count_ub);
+		desc.BindResource(2, m_scene->m_light_buffer);
+		desc.BindResource(3, m_light_grid);
+		desc.BindResource(4, m_light_indices);
+		desc.BindResource(5, m_light_index_counter);
+		m_descriptor_set->UpdateDescriptorSet(desc);
+	}
+
+	void LightCulling::Dispatch(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		VkCommandBuffer command_buffer = _command_buffer->Get(_i);
+
+		// hazards with the lighting passes are handled by the render graph, only the counter reset is ordered here
+		vkCmdFillBuffer(command_buffer, m_light_index_counter->Get(), 0, VK_WHOLE_SIZE, 0);
+		{
+			BarrierDesc desc;
+			BufferMemoryBarrierDesc counter_barrier;
+			counter_barrier.src_access_mask = MemoryAccessFlags::ACCESS_TRANSFER_WRITE_BIT;
+			counter_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(MemoryAccessFlags::ACCESS_SHADER_READ_BIT | MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT);
+			counter_barrier.buffer = m_light_index_counter->Get();
+			counter_barrier.offset = 0;
+			counter_barrier.size = static_cast<u32>(m_light_index_counter->size());
+			desc.buffer_memory_barriers.push_back(counter_barrier);
+			desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_TRANSFER_BIT;
+			desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			InsertBarrier(_i, _command_buffer, desc);
+		}
+
+		u32 cluster_count = m_cluster_params_ubdata.grid_size.x * m_cluster_params_ubdata.grid_size.y * m_cluster_params_ubdata.grid_size.z;
+		u32 group_count = (cluster_count + k_group_size - 1) / k_group_size;
+		_command_buffer->Dispatch(_i, m_pipeline, { m_descriptor_set }, group_count, 1, 1);
+	}
+
+	std::shared_ptr<UniformBuffer> LightCulling::GetClusterParams() const noexcept
+	{
+		return m_cluster_params_ub;
+	}
+
+	std::shared_ptr<StorageBuffer> LightCulling::GetLightIndexCounter() const noexcept
+	{
+		return m_light_index_counter;
+	}
+
+	std::shared_ptr<StorageBuffer> LightCulling::GetLightGrid() const noexcept
+	{
+		return m_light_grid;
+	}
+
+	std::shared_ptr<StorageBuffer> LightCulling::GetLightIndices() const noexcept
+	{
+		return m_light_indices;
+	}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <memory>
+#include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/function/rhi/vulkan/Descriptors.h>
+#include <runtime/function/rhi/vulkan/Pipeline.h>
+#include <runtime/function/rhi/vulkan/StorageBuffer.h>
+#include <runtime/function/rhi/vulkan/UniformBuffer.h>
+#include <runtime/scene/scene/Scene.h>
+
+namespace Horizon
+{
+
+    // clustered light assignment: the view frustum is split into screen tiles and exponential depth slices,
+    // a compute pass tests every light's range against each cluster and writes a compact index list per cluster.
+    // the lighting pass then only loops over the lights of the cluster a pixel falls in
+    class LightCulling
+    {
+    public:
+        LightCulling(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context) noexcept;
+        ~LightCulling() noexcept;
+
+        // cluster parameters of this frame's camera
+        void Update() noexcept;
+        // record the binning pass, barriers against the lighting passes are inserted by the render graph
+        void Dispatch(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+
+        // read by the lighting pass
+        std::shared_ptr<UniformBuffer> GetClusterParams() const noexcept;
+        std::shared_ptr<StorageBuffer> GetLightGrid() const noexcept;
+        std::shared_ptr<StorageBuffer> GetLightIndices() const noexcept;
+        // cleared and incremented by the binning pass only
+        std::shared_ptr<StorageBuffer> GetLightIndexCounter() const noexcept;
+
+    private:
+        // std140 layout, must match light_clustering.comp and shading.frag
+        struct ClusterParamsUb {
+            Math::mat4 view;
+            Math::mat4 inverse_projection;
+            Math::uvec4 grid_size;
+            Math::vec4 screen_size_near_far;
+            Math::vec4 slice_scale_bias;
+            u32 index_capacity;
+        } m_cluster_params_ubdata;
+
+        static constexpr u32 k_tile_size = 64;
+        static constexpr u32 k_slice_count = 24;
+        static constexpr u32 k_group_size = 64;
+        // average light indices reserved per cluster
+        static constexpr u32 k_average_lights_per_cluster = 32;
+
+        std::shared_ptr<Scene> m_scene;
+        std::shared_ptr<Pipeline> m_pipeline;
+        std::shared_ptr<DescriptorSet> m_descriptor_set;
+
+        std::shared_ptr<UniformBuffer> m_cluster_params_ub;
+        std::shared_ptr<StorageBuffer> m_light_grid;
+        std::shared_ptr<StorageBuffer> m_light_indices;
+        std::shared_ptr<StorageBuffer> m_light_index_counter;
+
+        RenderContext &m_render_context;
+        // clusters at full resolution, the buffers are sized for it
+        u32 m_cluster_count;
+    };
+
+}
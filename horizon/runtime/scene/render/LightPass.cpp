@@ -13,10 +13,11 @@ namespace Horizon
 		LightPassPipelineCreateInfo.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("simplevs.vert.spv"));
 		LightPassPipelineCreateInfo.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("shading.frag.spv"));
 		LightPassPipelineCreateInfo.descriptor_layouts = m_descriptor_set_layout;
+		LightPassPipelineCreateInfo.dynamic_resolution = true;
 
 
 		std::vector<AttachmentCreateInfo> LightPassAttachmentsCreateInfo{
-			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1}
+			AttachmentCreateInfo{TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT, COLOR_ATTACHMENT | ALIASED_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height, 1}
 		};
 
 		m_pipeline = _pipeline_manager->CreateGraphicsPipeline(LightPassPipelineCreateInfo, LightPassAttachmentsCreateInfo, _render_context);
@@ -30,11 +31,17 @@ namespace Horizon
 	{
 		std::shared_ptr<DescriptorSetInfo> descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
 		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_PIXEL_SHADER);
 		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
-		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		// g buffer: depth, normal, albedo, roughness metallic
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER);
 		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER);
 		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER);
 		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_PIXEL_SHADER);
+		// clustered light lists
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_PIXEL_SHADER);
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_PIXEL_SHADER);
 
 		m_descriptorset = std::make_shared<DescriptorSet>(m_device, descriptor_set_create_info);
 
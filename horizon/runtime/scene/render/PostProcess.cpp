@@ -5,7 +5,7 @@
 
 namespace Horizon
 {
-	PostProcess::PostProcess(std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context) noexcept
+	PostProcess::PostProcess(std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context, std::shared_ptr<SwapChain> _swap_chain) noexcept : m_present(_swap_chain != nullptr)
 	{
 		CreateResources();
 
@@ -28,15 +28,29 @@ namespace Horizon
 		pp_descriptor_set_layout->layouts.push_back(m_pp_descriptorset->GetLayout());
 
 		GraphicsPipelineCreateInfo pp_ipeline_create_info;
-		pp_ipeline_create_info.name = "pp";
+		pp_ipeline_create_info.name = m_present ? "pp_present" : "pp";
 		pp_ipeline_create_info.vs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("simplevs.vert.spv"));
 		pp_ipeline_create_info.ps = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("postprocess.frag.spv"));
 		pp_ipeline_create_info.descriptor_layouts = pp_descriptor_set_layout;
-
-		std::vector<AttachmentCreateInfo> pp_attachment_create_info{
-			{TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height},
-		};
-		m_pipeline = _pipeline_manager->CreateGraphicsPipeline(pp_ipeline_create_info, pp_attachment_create_info, _render_context);
+		// upscales the render area of the input to the full target
+		m_push_constants = std::make_shared<PushConstants>();
+		m_push_constants->ranges = { {SHADER_STAGE_PIXEL_SHADER, 0, sizeof(UpscaleParams), &m_upscale_params} };
+		pp_ipeline_create_info.push_constants = m_push_constants;
+
+		if (m_present) {
+			std::vector<AttachmentCreateInfo> pp_attachment_create_info{
+				{TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM, COLOR_ATTACHMENT | PRESENT_SRC, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height},
+			};
+			_pipeline_manager->createPresentPipeline(pp_ipeline_create_info, pp_attachment_create_info, _render_context, _swap_chain);
+			m_pipeline = _pipeline_manager->Get(pp_ipeline_create_info.name);
+		}
+		else {
+			// only created on demand once the aliased attachments are placed, so it is never aliased
+			std::vector<AttachmentCreateInfo> pp_attachment_create_info{
+				{TextureFormat::TEXTURE_FORMAT_RGBA16_UNORM, COLOR_ATTACHMENT, TextureType::TEXTURE_TYPE_2D, _render_context.width, _render_context.height},
+			};
+			m_pipeline = _pipeline_manager->CreateGraphicsPipeline(pp_ipeline_create_info, pp_attachment_create_info, _render_context);
+		}
 	}
 
 	PostProcess::~PostProcess() noexcept
@@ -53,6 +67,11 @@ namespace Horizon
 		m_descriptor_set_update_desc.BindResource(binding, buffer);
 	}
 
+	void PostProcess::SetRenderUvScale(Math::vec2 uv_scale) noexcept
+	{
+		m_upscale_params.uv_scale = uv_scale;
+	}
+
 	std::shared_ptr<AttachmentDescriptor> PostProcess::GetFrameBufferAttachment(u32 _index) const noexcept
 	{
 		return std::static_pointer_cast<GraphicsPipeline>(m_pipeline)->GetFrameBufferAttachment(_index);
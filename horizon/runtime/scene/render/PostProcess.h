@@ -4,20 +4,31 @@
 
 namespace Horizon
 {
+    // tone mapping and gamma encoding. with a swap chain the pass writes the swap chain images directly and
+    // no intermediate target is created, otherwise it writes a full size target the present pass copies out
     class PostProcess
     {
     public:
-        PostProcess(std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context) noexcept;
+        PostProcess(std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, RenderContext &_render_context, std::shared_ptr<SwapChain> _swap_chain = nullptr) noexcept;
         ~PostProcess() noexcept;
         void UpdateDescriptorSets() noexcept;
         void BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept;
+        // render area of the input relative to its size, see RenderContext::GetRenderUvScale
+        void SetRenderUvScale(Math::vec2 uv_scale) noexcept;
         std::shared_ptr<AttachmentDescriptor> GetFrameBufferAttachment(u32 _index) const noexcept;
         std::shared_ptr<DescriptorSet> GetDescriptorSet() const noexcept;
         std::shared_ptr<Pipeline> GetPipeline() const noexcept;
     private:
         void CreateResources() noexcept;
     private:
+        // must match postprocess.frag
+        struct UpscaleParams {
+            Math::vec2 uv_scale = Math::vec2(1.0f);
+        } m_upscale_params;
+
         std::shared_ptr<Pipeline> m_pipeline;
+        std::shared_ptr<PushConstants> m_push_constants;
+        bool m_present = false;
         //std::shared_ptr<Pipeline> m_tone_mapping_pass;
 
         //std::shared_ptr<DescriptorSetLayouts> tone_mapping_descriptor_set_layouts;
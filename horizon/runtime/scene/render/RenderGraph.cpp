@@ -0,0 +1,531 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace Horizon {
+
+	static constexpr u32 k_write_access = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT | MemoryAccessFlags::ACCESS_COLOR_ATTACHMENT_WRITE_BIT | MemoryAccessFlags::ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		MemoryAccessFlags::ACCESS_TRANSFER_WRITE_BIT | MemoryAccessFlags::ACCESS_HOST_WRITE_BIT | MemoryAccessFlags::ACCESS_MEMORY_WRITE_BIT;
+
+	RenderGraphResource RenderGraph::ImportTexture(const std::string& name, std::shared_ptr<Texture> texture, TextureUsage usage) noexcept
+	{
+		Resource resource;
+		resource.name = name;
+		resource.type = ResourceType::TEXTURE;
+		resource.texture = texture;
+		resource.usage = usage;
+		m_resources.push_back(resource);
+		return static_cast<RenderGraphResource>(m_resources.size() - 1);
+	}
+
+	RenderGraphResource RenderGraph::ImportBuffer(const std::string& name, std::shared_ptr<StorageBuffer> buffer) noexcept
+	{
+		Resource resource;
+		resource.name = name;
+		resource.type = ResourceType::BUFFER;
+		resource.buffer = buffer;
+		m_resources.push_back(resource);
+		return static_cast<RenderGraphResource>(m_resources.size() - 1);
+	}
+
+	RenderGraphResource RenderGraph::ImportAttachment(const std::string& name, std::shared_ptr<Framebuffer> framebuffer, std::vector<u32> attachments) noexcept
+	{
+		Resource resource;
+		resource.name = name;
+		resource.type = ResourceType::ATTACHMENT;
+		resource.framebuffer = framebuffer;
+		resource.attachments = std::move(attachments);
+		m_resources.push_back(resource);
+		return static_cast<RenderGraphResource>(m_resources.size() - 1);
+	}
+
+	void RenderGraph::MarkOutput(RenderGraphResource resource) noexcept
+	{
+		m_resources[resource].output = true;
+	}
+
+	u32 RenderGraph::AddPass(const std::string& name, ExecuteFunc execute, RenderGraphQueue queue) noexcept
+	{
+		Pass pass;
+		pass.name = name;
+		pass.execute = execute;
+		pass.queue = queue;
+		m_passes.push_back(pass);
+		return static_cast<u32>(m_passes.size() - 1);
+	}
+
+	void RenderGraph::Read(u32 pass, RenderGraphResource resource, const ResourceAccess& access) noexcept
+	{
+		AddUse(pass, resource, access, true, false);
+	}
+
+	void RenderGraph::Write(u32 pass, RenderGraphResource resource, const ResourceAccess& access) noexcept
+	{
+		AddUse(pass, resource, access, false, true);
+	}
+
+	void RenderGraph::ReadWrite(u32 pass, RenderGraphResource resource, const ResourceAccess& access) noexcept
+	{
+		AddUse(pass, resource, access, true, true);
+	}
+
+	void RenderGraph::AddUse(u32 pass, RenderGraphResource resource, const ResourceAccess& access, bool read, bool write) noexcept
+	{
+		if (pass >= m_passes.size() || resource >= m_resources.size()) {
+			LOG_ERROR("invalid render graph pass or resource");
+			return;
+		}
+
+		// one use per resource and pass, barriers are only placed between passes
+		for (auto& use : m_passes[pass].uses) {
+			if (use.resource == resource) {
+				if (use.access.usage != access.usage) {
+					LOG_ERROR("pass " + m_passes[pass].name + " uses " + m_resources[resource].name + " in two layouts");
+				}
+				use.access.stages |= access.stages;
+				use.access.access |= access.access;
+				use.read |= read;
+				use.write |= write;
+				return;
+			}
+		}
+
+		ResourceUse use;
+		use.resource = resource;
+		use.access = access;
+		use.read = read;
+		use.write = write;
+		m_passes[pass].uses.push_back(use);
+	}
+
+	void RenderGraph::SetTransientAttachmentPool(std::shared_ptr<TransientAttachmentPool> pool) noexcept
+	{
+		m_transient_attachment_pool = pool;
+	}
+
+	void RenderGraph::SetAsyncCompute(bool enable) noexcept
+	{
+		m_async_compute = enable;
+	}
+
+	bool RenderGraph::HasAsyncCompute() const noexcept
+	{
+		return m_has_async_compute;
+	}
+
+	u32 RenderGraph::GetAsyncComputeWaitStages() const noexcept
+	{
+		return m_async_wait_stages;
+	}
+
+	void RenderGraph::Clear() noexcept
+	{
+		m_resources.clear();
+		m_passes.clear();
+		m_levels.clear();
+		m_lifetimes.clear();
+		m_final_barrier = BarrierDesc{};
+		m_final_compute_barrier = BarrierDesc{};
+		m_has_async_compute = false;
+		m_async_wait_level = 0;
+		m_async_wait_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+	}
+
+	void RenderGraph::Compile() noexcept
+	{
+		Cull();
+		Schedule();
+		SplitQueues();
+		AliasAttachments();
+		BuildBarriers();
+	}
+
+	void RenderGraph::Execute(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<CommandBuffer> _compute_command_buffer, std::shared_ptr<CommandBuffer> _overlap_command_buffer) const noexcept
+	{
+		if (m_has_async_compute && !_compute_command_buffer) {
+			LOG_ERROR("the render graph has async compute passes but no compute command buffer");
+			return;
+		}
+
+		for (u32 l = 0; l < m_levels.size(); l++) {
+			const Level& level = m_levels[l];
+			std::shared_ptr<CommandBuffer> graphics_command_buffer = _overlap_command_buffer && l < m_async_wait_level ? _overlap_command_buffer : _command_buffer;
+			if (!IsEmpty(level.barrier)) {
+				InsertBarrier(_i, graphics_command_buffer, level.barrier);
+			}
+			if (!IsEmpty(level.compute_barrier)) {
+				InsertBarrier(_i, _compute_command_buffer, level.compute_barrier);
+			}
+			for (u32 pass : level.passes) {
+				m_passes[pass].execute(_i, m_passes[pass].queue == RenderGraphQueue::ASYNC_COMPUTE ? _compute_command_buffer : graphics_command_buffer);
+			}
+		}
+		if (!IsEmpty(m_final_barrier)) {
+			InsertBarrier(_i, _command_buffer, m_final_barrier);
+		}
+		if (!IsEmpty(m_final_compute_barrier)) {
+			InsertBarrier(_i, _compute_command_buffer, m_final_compute_barrier);
+		}
+	}
+
+	void RenderGraph::Cull() noexcept
+	{
+		// walk backwards from the outputs, a pass is needed if it writes something a later needed pass reads.
+		// partial writes cannot be told apart from full ones, so a write never ends a resource's lifetime
+		std::vector<bool> needed(m_resources.size());
+		for (u32 r = 0; r < m_resources.size(); r++) {
+			needed[r] = m_resources[r].output;
+		}
+
+		for (u32 p = static_cast<u32>(m_passes.size()); p-- > 0;) {
+			Pass& pass = m_passes[p];
+			pass.culled = std::none_of(pass.uses.begin(), pass.uses.end(), [&needed](const ResourceUse& use) { return use.write && needed[use.resource]; });
+			if (pass.culled) {
+				continue;
+			}
+			for (const auto& use : pass.uses) {
+				if (use.read) {
+					needed[use.resource] = true;
+				}
+			}
+		}
+	}
+
+	void RenderGraph::Schedule() noexcept
+	{
+		// a pass goes one level after the passes it depends on, passes of the same level run without barriers in between
+		struct Reader {
+			u32 pass;
+			TextureUsage usage;
+		};
+		std::vector<i32> last_writer(m_resources.size(), -1);
+		std::vector<std::vector<Reader>> readers(m_resources.size());
+
+		u32 level_count = 0;
+		for (u32 p = 0; p < m_passes.size(); p++) {
+			Pass& pass = m_passes[p];
+			if (pass.culled) {
+				continue;
+			}
+
+			pass.level = 0;
+			if (!m_async_compute) {
+				pass.queue = RenderGraphQueue::GRAPHICS;
+			}
+			// the compute queue only waits for the previous frame, not for graphics work of this one
+			bool graphics_dependency = false;
+			for (const auto& use : pass.uses) {
+				// read after write and write after write
+				if (last_writer[use.resource] >= 0) {
+					const Pass& writer = m_passes[last_writer[use.resource]];
+					pass.level = std::max(pass.level, writer.level + 1);
+					graphics_dependency |= writer.queue == RenderGraphQueue::GRAPHICS;
+				}
+				// write after read, and reads that need another layout
+				for (const auto& reader : readers[use.resource]) {
+					if (use.write || (m_resources[use.resource].type == ResourceType::TEXTURE && reader.usage != use.access.usage)) {
+						pass.level = std::max(pass.level, m_passes[reader.pass].level + 1);
+						graphics_dependency |= m_passes[reader.pass].queue == RenderGraphQueue::GRAPHICS;
+					}
+				}
+			}
+			if (graphics_dependency) {
+				pass.queue = RenderGraphQueue::GRAPHICS;
+			}
+
+			for (const auto& use : pass.uses) {
+				if (use.write) {
+					last_writer[use.resource] = static_cast<i32>(p);
+					readers[use.resource].clear();
+				}
+				else {
+					readers[use.resource].push_back(Reader{ p, use.access.usage });
+				}
+			}
+			level_count = std::max(level_count, pass.level + 1);
+		}
+
+		m_levels.assign(level_count, Level{});
+		for (u32 p = 0; p < m_passes.size(); p++) {
+			if (!m_passes[p].culled) {
+				m_levels[m_passes[p].level].passes.push_back(p);
+			}
+		}
+	}
+
+	void RenderGraph::SplitQueues() noexcept
+	{
+		std::vector<bool> async_resources(m_resources.size(), false);
+		for (const auto& pass : m_passes) {
+			if (pass.culled || pass.queue != RenderGraphQueue::ASYNC_COMPUTE) {
+				continue;
+			}
+			m_has_async_compute = true;
+			for (const auto& use : pass.uses) {
+				async_resources[use.resource] = true;
+			}
+		}
+
+		// graphics passes before the first one sharing a resource with the compute passes do not wait for them.
+		// the semaphore makes the compute writes visible to the waiting stages, no barriers are needed between the queues
+		m_async_wait_level = static_cast<u32>(m_levels.size());
+		m_async_wait_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+		for (const auto& pass : m_passes) {
+			if (pass.culled || pass.queue != RenderGraphQueue::GRAPHICS) {
+				continue;
+			}
+			for (const auto& use : pass.uses) {
+				if (async_resources[use.resource]) {
+					m_async_wait_level = std::min(m_async_wait_level, pass.level);
+					m_async_wait_stages |= use.access.stages;
+				}
+			}
+		}
+	}
+
+	void RenderGraph::AliasAttachments() noexcept
+	{
+		m_lifetimes.assign(m_resources.size(), Lifetime{});
+		for (u32 l = 0; l < m_levels.size(); l++) {
+			for (u32 p : m_levels[l].passes) {
+				for (const auto& use : m_passes[p].uses) {
+					Lifetime& lifetime = m_lifetimes[use.resource];
+					if (lifetime.first == ~0u) {
+						lifetime.first = l;
+					}
+					if (lifetime.first == l) {
+						lifetime.first_stages |= use.access.stages;
+						lifetime.first_access |= use.access.access;
+					}
+					lifetime.last = l;
+					lifetime.stages |= use.access.stages;
+					if (use.write) {
+						lifetime.write_access |= use.access.access & k_write_access;
+					}
+				}
+			}
+		}
+
+		if (!m_transient_attachment_pool) {
+			return;
+		}
+
+		if (!m_transient_attachment_pool->IsAllocated()) {
+			// an attachment backing several resources gets the union of their lifetimes
+			for (u32 r = 0; r < m_resources.size(); r++) {
+				if (m_resources[r].framebuffer && m_lifetimes[r].first != ~0u) {
+					m_transient_attachment_pool->SetLifetime(m_resources[r].framebuffer.get(), m_resources[r].attachments, m_lifetimes[r].first, m_lifetimes[r].last);
+				}
+			}
+			m_transient_attachment_pool->Allocate();
+		}
+
+		// memory was placed for the passes of the first compile and the views built on it are already bound,
+		// a configuration keeping attachments that share memory alive together would corrupt them
+		for (u32 a = 0; a < m_resources.size(); a++) {
+			for (u32 b = a + 1; b < m_resources.size(); b++) {
+				const Lifetime& la = m_lifetimes[a];
+				const Lifetime& lb = m_lifetimes[b];
+				if (la.first == ~0u || lb.first == ~0u || !m_resources[a].framebuffer || !m_resources[b].framebuffer) {
+					continue;
+				}
+				if (la.first <= lb.last && lb.first <= la.last && m_transient_attachment_pool->Aliases(m_resources[a].framebuffer.get(), m_resources[a].attachments, m_resources[b].framebuffer.get(), m_resources[b].attachments)) {
+					LOG_ERROR(m_resources[a].name + " and " + m_resources[b].name + " share memory but are alive at the same time");
+					std::abort();
+				}
+			}
+		}
+	}
+
+	void RenderGraph::AliasingBarrier(u32 level, BarrierDesc& desc) const noexcept
+	{
+		if (!m_transient_attachment_pool) {
+			return;
+		}
+
+		// the previous occupant is either used earlier in this frame or later in the previous one,
+		// both were recorded before this level. the render pass discards the contents with an undefined initial layout
+		for (u32 r = 0; r < m_resources.size(); r++) {
+			if (m_lifetimes[r].first != level || !m_resources[r].framebuffer) {
+				continue;
+			}
+			for (u32 q = 0; q < m_resources.size(); q++) {
+				if (m_lifetimes[q].first == ~0u || !m_resources[q].framebuffer || !m_transient_attachment_pool->Aliases(m_resources[r].framebuffer.get(), m_resources[r].attachments, m_resources[q].framebuffer.get(), m_resources[q].attachments)) {
+					continue;
+				}
+				desc.src_stage |= m_lifetimes[q].stages;
+				desc.dst_stage |= m_lifetimes[r].first_stages;
+				if (m_lifetimes[q].write_access) {
+					if (desc.memory_barriers.empty()) {
+						desc.memory_barriers.push_back(MemoryBarrierDesc{ MemoryAccessFlags::ACCESS_NONE, MemoryAccessFlags::ACCESS_NONE });
+					}
+					MemoryBarrierDesc& memory_barrier = desc.memory_barriers.back();
+					memory_barrier.src_access_mask = static_cast<MemoryAccessFlags>(memory_barrier.src_access_mask | m_lifetimes[q].write_access);
+					memory_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(memory_barrier.dst_access_mask | m_lifetimes[r].first_access);
+				}
+			}
+		}
+	}
+
+	void RenderGraph::BuildBarriers() noexcept
+	{
+		std::vector<ResourceState> states(m_resources.size());
+		for (u32 r = 0; r < m_resources.size(); r++) {
+			states[r].usage = m_resources[r].usage;
+		}
+
+		// first walk finds the state at the end of the frame, which is where the next frame starts
+		BarrierDesc discard{};
+		for (const auto& level : m_levels) {
+			for (u32 p : level.passes) {
+				for (const auto& use : m_passes[p].uses) {
+					Transition(m_resources[use.resource], states[use.resource], use, m_passes[p].queue, discard);
+				}
+			}
+		}
+
+		// textures left in another layout are transitioned back before the next frame's first uses,
+		// on the queue of the last use. uses on the other queue are ordered by the wait for the frame
+		m_final_barrier = BarrierDesc{};
+		m_final_compute_barrier = BarrierDesc{};
+		for (u32 r = 0; r < m_resources.size(); r++) {
+			const Resource& resource = m_resources[r];
+			ResourceState& state = states[r];
+			if (resource.type != ResourceType::TEXTURE || state.usage == resource.usage) {
+				continue;
+			}
+
+			u32 dst_stages = PipelineStageFlags::PIPELINE_STAGE_NONE, dst_access = MemoryAccessFlags::ACCESS_NONE;
+			for (const auto& level : m_levels) {
+				for (u32 p : level.passes) {
+					for (const auto& use : m_passes[p].uses) {
+						if (use.resource == r && m_passes[p].queue == state.queue) {
+							dst_stages |= use.access.stages;
+							dst_access |= use.access.access;
+						}
+					}
+				}
+			}
+
+			BarrierDesc& final_barrier = state.queue == RenderGraphQueue::ASYNC_COMPUTE ? m_final_compute_barrier : m_final_barrier;
+			u32 src_stages = state.write_stages | state.read_stages;
+			final_barrier.src_stage |= src_stages ? src_stages : PipelineStageFlags::PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			final_barrier.dst_stage |= dst_stages;
+
+			ImageMemoryBarrierDesc image_barrier;
+			image_barrier.src_access_mask = static_cast<MemoryAccessFlags>(state.visible_stages ? 0 : state.write_access);
+			image_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(dst_access);
+			image_barrier.src_usage = state.usage;
+			image_barrier.dst_usage = resource.usage;
+			image_barrier.texture = resource.texture;
+			final_barrier.image_memory_barriers.push_back(image_barrier);
+
+			// the final barrier orders the transition before every use of the next frame
+			RenderGraphQueue queue = state.queue;
+			state = ResourceState{};
+			state.usage = resource.usage;
+			state.queue = queue;
+		}
+
+		for (u32 l = 0; l < m_levels.size(); l++) {
+			Level& level = m_levels[l];
+			AliasingBarrier(l, level.barrier);
+			for (u32 p : level.passes) {
+				RenderGraphQueue queue = m_passes[p].queue;
+				for (const auto& use : m_passes[p].uses) {
+					Transition(m_resources[use.resource], states[use.resource], use, queue, queue == RenderGraphQueue::ASYNC_COMPUTE ? level.compute_barrier : level.barrier);
+				}
+			}
+		}
+	}
+
+	void RenderGraph::Transition(const Resource& resource, ResourceState& state, const ResourceUse& use, RenderGraphQueue queue, BarrierDesc& desc) const noexcept
+	{
+		// uses on the other queue are ordered by the semaphore within the frame and by the wait for the frame across frames
+		if (state.queue != queue) {
+			TextureUsage usage = state.usage;
+			state = ResourceState{};
+			state.usage = usage;
+			state.queue = queue;
+		}
+
+		bool layout_change = resource.type == ResourceType::TEXTURE && state.usage != use.access.usage;
+
+		u32 src_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+		u32 src_access = MemoryAccessFlags::ACCESS_NONE;
+		if (use.write || layout_change) {
+			// wait for the reads and the last write, a write that was already made visible needs no further flush
+			src_stages = state.read_stages | state.write_stages;
+			src_access = state.visible_stages ? 0 : state.write_access;
+		}
+		else if (state.write_stages && ((state.visible_stages & use.access.stages) != use.access.stages || (state.visible_access & use.access.access) != use.access.access)) {
+			src_stages = state.write_stages;
+			src_access = state.write_access;
+		}
+
+		if (src_stages || layout_change) {
+			desc.src_stage |= src_stages ? src_stages : PipelineStageFlags::PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			desc.dst_stage |= use.access.stages;
+
+			switch (resource.type) {
+			case ResourceType::TEXTURE:
+				if (src_access || layout_change) {
+					ImageMemoryBarrierDesc image_barrier;
+					image_barrier.src_access_mask = static_cast<MemoryAccessFlags>(src_access);
+					image_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(use.access.access);
+					image_barrier.src_usage = state.usage;
+					image_barrier.dst_usage = use.access.usage;
+					image_barrier.texture = resource.texture;
+					desc.image_memory_barriers.push_back(image_barrier);
+				}
+				break;
+			case ResourceType::BUFFER:
+				if (src_access) {
+					BufferMemoryBarrierDesc buffer_barrier;
+					buffer_barrier.src_access_mask = static_cast<MemoryAccessFlags>(src_access);
+					buffer_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(use.access.access);
+					buffer_barrier.buffer = resource.buffer->Get();
+					buffer_barrier.offset = 0;
+					buffer_barrier.size = static_cast<u32>(resource.buffer->size());
+					desc.buffer_memory_barriers.push_back(buffer_barrier);
+				}
+				break;
+			case ResourceType::ATTACHMENT:
+				// no texture object to name, attachments of all passes share one global barrier
+				if (src_access) {
+					if (desc.memory_barriers.empty()) {
+						desc.memory_barriers.push_back(MemoryBarrierDesc{ MemoryAccessFlags::ACCESS_NONE, MemoryAccessFlags::ACCESS_NONE });
+					}
+					MemoryBarrierDesc& memory_barrier = desc.memory_barriers.back();
+					memory_barrier.src_access_mask = static_cast<MemoryAccessFlags>(memory_barrier.src_access_mask | src_access);
+					memory_barrier.dst_access_mask = static_cast<MemoryAccessFlags>(memory_barrier.dst_access_mask | use.access.access);
+				}
+				break;
+			}
+		}
+
+		if (use.write) {
+			state.write_stages = use.access.stages;
+			state.write_access = use.access.access & k_write_access;
+			state.visible_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+			state.visible_access = MemoryAccessFlags::ACCESS_NONE;
+			state.read_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+		}
+		else {
+			state.read_stages |= use.access.stages;
+			if (src_stages || layout_change) {
+				state.visible_stages |= use.access.stages;
+				state.visible_access |= use.access.access;
+			}
+		}
+		state.usage = use.access.usage;
+	}
+
+	bool RenderGraph::IsEmpty(const BarrierDesc& desc) noexcept
+	{
+		return desc.dst_stage == PipelineStageFlags::PIPELINE_STAGE_NONE;
+	}
+
+}
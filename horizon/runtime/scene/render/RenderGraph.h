@@ -0,0 +1,185 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <runtime/function/rhi/RenderContext.h>
+#include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/function/rhi/vulkan/Framebuffer.h>
+#include <runtime/function/rhi/vulkan/ResourceBarrier.h>
+#include <runtime/function/rhi/vulkan/StorageBuffer.h>
+#include <runtime/function/rhi/vulkan/Texture.h>
+#include <runtime/function/rhi/vulkan/TransientAttachmentPool.h>
+
+namespace Horizon
+{
+
+    using RenderGraphResource = u32;
+
+    // stages and accesses of one use of a resource, usage is the layout a texture must be in
+    struct ResourceAccess {
+        u32 stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+        u32 access = MemoryAccessFlags::ACCESS_NONE;
+        TextureUsage usage = TextureUsage::TEXTURE_USAGE_RW;
+    };
+
+    namespace RenderGraphAccess {
+        constexpr ResourceAccess k_compute_read{ PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT, MemoryAccessFlags::ACCESS_SHADER_READ_BIT };
+        constexpr ResourceAccess k_compute_write{ PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT, MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT };
+        constexpr ResourceAccess k_compute_read_write{ PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT, MemoryAccessFlags::ACCESS_SHADER_READ_BIT | MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT };
+        constexpr ResourceAccess k_fragment_read{ PipelineStageFlags::PIPELINE_STAGE_FRAGMENT_SHADER_BIT, MemoryAccessFlags::ACCESS_SHADER_READ_BIT };
+        constexpr ResourceAccess k_color_attachment_write{ PipelineStageFlags::PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, MemoryAccessFlags::ACCESS_COLOR_ATTACHMENT_WRITE_BIT };
+        constexpr ResourceAccess k_depth_attachment_write{ PipelineStageFlags::PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | PipelineStageFlags::PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, MemoryAccessFlags::ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | MemoryAccessFlags::ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+        // cleared with vkCmdFillBuffer, then updated by a compute shader in the same pass
+        constexpr ResourceAccess k_clear_compute_read_write{ PipelineStageFlags::PIPELINE_STAGE_TRANSFER_BIT | PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT, MemoryAccessFlags::ACCESS_TRANSFER_WRITE_BIT | MemoryAccessFlags::ACCESS_SHADER_READ_BIT | MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT };
+    }
+
+    // queue a pass is recorded for
+    enum class RenderGraphQueue {
+        GRAPHICS,
+        // compute passes that overlap the graphics work, they fall back to the graphics queue when async compute
+        // is off or they depend on a graphics pass of the same frame
+        ASYNC_COMPUTE
+    };
+
+    // frame graph: passes declare the resources they read and write, Compile culls passes that do not contribute
+    // to an output, groups independent passes into levels so they can overlap on the gpu and derives one batched
+    // barrier per level. the state at the end of the frame is the state at the start of the next one, so hazards
+    // with the previous frame are covered too.
+    // barriers inside a pass (e.g. between the dispatches of a multi pass precompute) stay in the pass
+    // with a transient attachment pool, the first compile hands the attachment lifetimes to the pool, later
+    // compiles order each aliased attachment's first use after every use of the attachments sharing its memory.
+    // memory is placed once, a later configuration that keeps attachments sharing memory alive together aborts
+    // with async compute, graphics passes before the first one touching a resource of the compute passes are recorded
+    // into an overlap command buffer that runs next to the compute queue, the rest of the frame waits for it with a semaphore
+    class RenderGraph
+    {
+    public:
+        using ExecuteFunc = std::function<void(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer)>;
+
+        RenderGraph() noexcept = default;
+        ~RenderGraph() noexcept = default;
+
+        // textures accessed by shaders, layouts are transitioned as needed and restored to usage at the end of the frame
+        RenderGraphResource ImportTexture(const std::string& name, std::shared_ptr<Texture> texture, TextureUsage usage) noexcept;
+        RenderGraphResource ImportBuffer(const std::string& name, std::shared_ptr<StorageBuffer> buffer) noexcept;
+        // framebuffer attachments, layouts belong to the render pass so only memory dependencies are inserted.
+        // the framebuffer is needed to place and synchronize its aliased attachments, attachments selects the ones
+        // the resource stands for so a framebuffer can be split into resources with different lifetimes, empty is all
+        RenderGraphResource ImportAttachment(const std::string& name, std::shared_ptr<Framebuffer> framebuffer = nullptr, std::vector<u32> attachments = {}) noexcept;
+        // kept alive after the frame, e.g. the swap chain image
+        void MarkOutput(RenderGraphResource resource) noexcept;
+
+        u32 AddPass(const std::string& name, ExecuteFunc execute, RenderGraphQueue queue = RenderGraphQueue::GRAPHICS) noexcept;
+        void Read(u32 pass, RenderGraphResource resource, const ResourceAccess& access) noexcept;
+        void Write(u32 pass, RenderGraphResource resource, const ResourceAccess& access) noexcept;
+        void ReadWrite(u32 pass, RenderGraphResource resource, const ResourceAccess& access) noexcept;
+
+        void SetTransientAttachmentPool(std::shared_ptr<TransientAttachmentPool> pool) noexcept;
+        // needs a separate compute queue family
+        void SetAsyncCompute(bool enable) noexcept;
+        // a pass of the compiled graph runs on the compute queue
+        bool HasAsyncCompute() const noexcept;
+        // stages of the graphics passes reading or writing resources of the compute queue
+        u32 GetAsyncComputeWaitStages() const noexcept;
+
+        void Clear() noexcept;
+        void Compile() noexcept;
+        // with async compute, compute passes go to _compute_command_buffer and the graphics passes before the wait to _overlap_command_buffer
+        void Execute(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<CommandBuffer> _compute_command_buffer = nullptr, std::shared_ptr<CommandBuffer> _overlap_command_buffer = nullptr) const noexcept;
+
+    private:
+        enum class ResourceType {
+            TEXTURE,
+            BUFFER,
+            ATTACHMENT
+        };
+
+        struct Resource {
+            std::string name;
+            ResourceType type;
+            std::shared_ptr<Texture> texture;
+            std::shared_ptr<StorageBuffer> buffer;
+            std::shared_ptr<Framebuffer> framebuffer;
+            std::vector<u32> attachments;
+            TextureUsage usage = TextureUsage::TEXTURE_USAGE_RW;
+            bool output = false;
+        };
+
+        struct ResourceUse {
+            RenderGraphResource resource;
+            ResourceAccess access;
+            bool read = false;
+            bool write = false;
+        };
+
+        struct Pass {
+            std::string name;
+            ExecuteFunc execute;
+            std::vector<ResourceUse> uses;
+            RenderGraphQueue queue = RenderGraphQueue::GRAPHICS;
+            bool culled = false;
+            u32 level = 0;
+        };
+
+        // synchronization state of a resource while walking the schedule
+        struct ResourceState {
+            u32 write_stages = 0;
+            u32 write_access = 0;
+            // stages and accesses the last write was made visible to
+            u32 visible_stages = 0;
+            u32 visible_access = 0;
+            // reads since the last write
+            u32 read_stages = 0;
+            TextureUsage usage = TextureUsage::TEXTURE_USAGE_RW;
+            // queue of the uses above
+            RenderGraphQueue queue = RenderGraphQueue::GRAPHICS;
+        };
+
+        // levels a resource is used in, and the stages of its uses
+        struct Lifetime {
+            u32 first = ~0u;
+            u32 last = 0;
+            u32 stages = 0;
+            u32 write_access = 0;
+            // uses in the first level
+            u32 first_stages = 0;
+            u32 first_access = 0;
+        };
+
+        struct Level {
+            BarrierDesc barrier;
+            // before the compute passes of the level
+            BarrierDesc compute_barrier;
+            std::vector<u32> passes;
+        };
+
+        void AddUse(u32 pass, RenderGraphResource resource, const ResourceAccess& access, bool read, bool write) noexcept;
+        void Cull() noexcept;
+        void Schedule() noexcept;
+        // the level the graphics passes start waiting for the compute queue at, and the stages that wait
+        void SplitQueues() noexcept;
+        // lifetimes of the attachments, allocates the transient attachment pool on the first compile
+        void AliasAttachments() noexcept;
+        void BuildBarriers() noexcept;
+        // wait for the attachments sharing memory with the attachments first used in the level
+        void AliasingBarrier(u32 level, BarrierDesc& desc) const noexcept;
+        // append the barrier needed before the use to desc and advance the state
+        void Transition(const Resource& resource, ResourceState& state, const ResourceUse& use, RenderGraphQueue queue, BarrierDesc& desc) const noexcept;
+        static bool IsEmpty(const BarrierDesc& desc) noexcept;
+
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+        std::vector<Level> m_levels;
+        std::vector<Lifetime> m_lifetimes;
+        std::shared_ptr<TransientAttachmentPool> m_transient_attachment_pool;
+        // restores texture layouts at the end of the frame
+        BarrierDesc m_final_barrier;
+        BarrierDesc m_final_compute_barrier;
+        bool m_async_compute = false;
+        bool m_has_async_compute = false;
+        u32 m_async_wait_level = 0;
+        u32 m_async_wait_stages = PipelineStageFlags::PIPELINE_STAGE_NONE;
+    };
+
+}
@@ -1,17 +1,18 @@
 #include "Renderer.h"
 
+#include <algorithm>
 #include <iostream>
 #include <runtime/core/math/Math.h>
 #include <runtime/core/path/Path.h>
 #include <runtime/function/rhi/vulkan/VulkanEnums.h>
-#include <runtime/function/rhi/vulkan/ResourceBarrier.h>
 
 namespace Horizon
 {
 
 	class Window;
 
-	Renderer::Renderer(u32 width, u32 height, std::shared_ptr<Window> window) noexcept : m_window(window)
+	Renderer::Renderer(u32 width, u32 height, std::shared_ptr<Window> window, AtmosphereLutQuality atmosphere_lut_quality, bool merged_deferred_pass) noexcept :
+		m_window(window), m_merged_deferred_pass(merged_deferred_pass), m_atmosphere_lut_quality(atmosphere_lut_quality)
 	{
 
 		m_instance = std::make_shared<Instance>();
@@ -23,11 +24,23 @@ namespace Horizon
 
 		m_swap_chain = std::make_shared<SwapChain>(m_render_context, m_device, m_surface);
 		m_command_buffer = std::make_shared<CommandBuffer>(m_render_context, m_device);
+		if (m_device->getQueueFamilyIndices().hasAsyncCompute()) {
+			m_compute_command_buffer = std::make_shared<CommandBuffer>(m_render_context, m_device, CommandQueue::COMPUTE);
+			m_overlap_command_buffer = std::make_shared<CommandBuffer>(m_render_context, m_device);
+			m_render_graph.SetAsyncCompute(true);
+		}
 		m_scene = std::make_shared<Scene>(m_render_context, m_device, m_command_buffer);
 		m_fullscreen_triangle = std::make_shared<FullscreenTriangle>(m_device, m_command_buffer);
 		m_pipeline_manager = std::make_shared<PipelineManager>(m_device);
+		m_render_context.transient_attachment_pool = std::make_shared<TransientAttachmentPool>(m_device);
+		m_render_graph.SetTransientAttachmentPool(m_render_context.transient_attachment_pool);
+		m_dynamic_resolution = std::make_shared<DynamicResolution>(m_render_context);
+		m_gpu_timer = std::make_shared<GpuTimer>(m_device, m_render_context.swap_chain_image_count, TIMER_SCOPE_COUNT);
+		m_pipeline_statistics = std::make_shared<PipelineStatistics>(m_device, m_render_context.swap_chain_image_count, STATISTICS_SCOPE_COUNT);
 		PrepareAssests();
 		CreatePipelines();
+		// the first compile places the aliased attachments, their views exist from here on
+		BuildRenderGraph();
 	}
 
 	Renderer::~Renderer() noexcept
@@ -42,40 +55,131 @@ namespace Horizon
 	{
 		m_scene->Prepare();
 
+		if (UseGpuDrivenGeometry()) {
+			m_gpu_driven_geometry_pass->Update();
+		}
+
+		m_light_culling_pass->Update();
 
-		m_light_pass->BindResource(0, m_scene->m_light_count_ub);
-		m_light_pass->BindResource(1, m_scene->m_light_ub);
-		m_light_pass->BindResource(2, m_scene->m_camera_ub);
+		if (!UseMergedDeferredPass()) {
+			m_light_pass->BindResource(0, m_scene->m_light_count_ub);
+			m_light_pass->BindResource(1, m_scene->m_light_buffer);
+			m_light_pass->BindResource(2, m_scene->m_camera_ub);
 
-		m_light_pass->BindResource(3, m_geometry_pass->GetFrameBufferAttachment(0));
-		m_light_pass->BindResource(4, m_geometry_pass->GetFrameBufferAttachment(1));
-		m_light_pass->BindResource(5, m_geometry_pass->GetFrameBufferAttachment(2));
+			m_light_pass->BindResource(3, m_geometry_pass->GetFrameBufferAttachment(3));
+			m_light_pass->BindResource(4, m_geometry_pass->GetFrameBufferAttachment(0));
+			m_light_pass->BindResource(5, m_geometry_pass->GetFrameBufferAttachment(1));
+			m_light_pass->BindResource(6, m_geometry_pass->GetFrameBufferAttachment(2));
 
+			m_light_pass->BindResource(7, m_light_culling_pass->GetClusterParams());
+			m_light_pass->BindResource(8, m_light_culling_pass->GetLightGrid());
+			m_light_pass->BindResource(9, m_light_culling_pass->GetLightIndices());
 
-		m_light_pass->UpdateDescriptorSets();
+			m_light_pass->UpdateDescriptorSets();
+		}
+		else {
+			m_deferred_pass->BindResource(0, m_scene->m_light_count_ub);
+			m_deferred_pass->BindResource(1, m_scene->m_light_buffer);
+			m_deferred_pass->BindResource(2, m_scene->m_camera_ub);
+			m_deferred_pass->BindResource(7, m_light_culling_pass->GetClusterParams());
+			m_deferred_pass->BindResource(8, m_light_culling_pass->GetLightGrid());
+			m_deferred_pass->BindResource(9, m_light_culling_pass->GetLightIndices());
+			m_deferred_pass->UpdateDescriptorSets();
+		}
+
+		if (m_tiled_lighting) {
+			m_tiled_light_pass->BindResource(0, m_scene->m_light_count_ub);
+			m_tiled_light_pass->BindResource(1, m_scene->m_light_buffer);
+			m_tiled_light_pass->BindResource(2, m_scene->m_camera_ub);
+			m_tiled_light_pass->BindResource(3, m_geometry_pass->GetFrameBufferAttachment(3));
+			m_tiled_light_pass->BindResource(4, m_geometry_pass->GetFrameBufferAttachment(0));
+			m_tiled_light_pass->BindResource(5, m_geometry_pass->GetFrameBufferAttachment(1));
+			m_tiled_light_pass->BindResource(6, m_geometry_pass->GetFrameBufferAttachment(2));
+			m_tiled_light_pass->BindResource(7, m_light_culling_pass->GetClusterParams());
+			m_tiled_light_pass->UpdateDescriptorSets();
+		}
 
 		m_atmosphere_pass->SetCameraParams(m_scene->GetMainCamera()->GetInvViewProjectionMatrix(), m_scene->GetMainCamera()->GetPosition());
 
 
 		m_atmosphere_pass->BindResource(0, m_scene->getCameraUbo());
-		m_atmosphere_pass->BindResource(3, m_light_pass->GetFrameBufferAttachment(0));
-		m_atmosphere_pass->BindResource(4, m_geometry_pass->GetFrameBufferAttachment(3));
+		if (UseMergedDeferredPass()) {
+			m_atmosphere_pass->BindResource(3, m_deferred_pass->GetLightingOutput());
+			m_atmosphere_pass->BindResource(4, m_deferred_pass->GetDepth());
+		}
+		else {
+			if (m_tiled_lighting) {
+				m_atmosphere_pass->BindResource(3, m_tiled_light_pass->GetOutput());
+			}
+			else {
+				m_atmosphere_pass->BindResource(3, m_light_pass->GetFrameBufferAttachment(0));
+			}
+			m_atmosphere_pass->BindResource(4, m_geometry_pass->GetFrameBufferAttachment(3));
+		}
 		m_atmosphere_pass->UpdateDescriptorSets();
 
-		m_post_process_pass->BindResource(0, m_atmosphere_pass->GetFrameBufferAttachment(0));
-		m_post_process_pass->UpdateDescriptorSets();
+		std::shared_ptr<PostProcess> post_process = m_fused_post_process ? m_fused_post_process_pass : m_post_process_pass;
+		post_process->BindResource(0, m_atmosphere_pass->GetFrameBufferAttachment(0));
+		post_process->SetRenderUvScale(m_render_context.GetRenderUvScale());
+		post_process->UpdateDescriptorSets();
 
-		m_present_descriptorSet->AllocateDescriptorSet();
-		DescriptorSetUpdateDesc desc;
-		desc.BindResource(0, m_post_process_pass->GetFrameBufferAttachment(0));
-		m_present_descriptorSet->UpdateDescriptorSet(desc);
+		if (!m_fused_post_process) {
+			m_present_descriptorSet->AllocateDescriptorSet();
+			DescriptorSetUpdateDesc desc;
+			desc.BindResource(0, m_post_process_pass->GetFrameBufferAttachment(0));
+			m_present_descriptorSet->UpdateDescriptorSet(desc);
+		}
 	}
 
 	void Renderer::Render() noexcept
 	{
 
 		DrawFrame();
-		m_command_buffer->submit(m_swap_chain);
+		if (m_render_graph.HasAsyncCompute()) {
+			m_command_buffer->submit(m_swap_chain, AsyncComputeSubmit{ m_compute_command_buffer, m_overlap_command_buffer, m_render_graph.GetAsyncComputeWaitStages() });
+		}
+		else {
+			m_command_buffer->submit(m_swap_chain);
+		}
+		// the submit waits for the queue, the timestamps of this frame are ready
+		m_atmosphere_pass->SaveLutCache(m_command_buffer->lastSubmittedImage());
+		u32 atmosphere_update_slices = m_atmosphere_pass->AdvanceLutUpdate();
+		m_gpu_timer->Resolve(m_command_buffer->lastSubmittedImage());
+		if (m_gpu_timer->IsResolved(TIMER_SCOPE_FRAME)) {
+			m_dynamic_resolution->Update(m_gpu_timer->GetTime(TIMER_SCOPE_FRAME));
+		}
+		if (m_gpu_timer->IsResolved(TIMER_SCOPE_SKY)) {
+			f32& sky_time = m_sky_times[static_cast<u32>(m_atmosphere_pass->GetSkyQuality())];
+			f32 time = m_gpu_timer->GetTime(TIMER_SCOPE_SKY);
+			// only recorded when the sky is upsampled
+			if (m_gpu_timer->IsResolved(TIMER_SCOPE_SKY_UPSAMPLE)) {
+				time += m_gpu_timer->GetTime(TIMER_SCOPE_SKY_UPSAMPLE);
+			}
+			sky_time = sky_time == 0.0f ? time : sky_time + (time - sky_time) * 0.1f;
+		}
+		if (m_gpu_timer->IsResolved(TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE)) {
+			m_atmosphere_precompute_time = m_gpu_timer->GetTime(TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE);
+		}
+		if (atmosphere_update_slices != 0 && m_gpu_timer->IsResolved(TIMER_SCOPE_ATMOSPHERE_UPDATE)) {
+			// the slices cost differently, grow by at most twice so cheap slices do not queue a frame of expensive ones
+			f32 slice_time = m_gpu_timer->GetTime(TIMER_SCOPE_ATMOSPHERE_UPDATE) / atmosphere_update_slices;
+			u32 slices = static_cast<u32>(m_atmosphere_update_budget / std::max(slice_time, 0.001f));
+			m_atmosphere_pass->SetLutUpdateBudget(std::min(slices, 2 * atmosphere_update_slices));
+		}
+
+		m_pipeline_statistics->Resolve(m_command_buffer->lastSubmittedImage());
+		if (m_pipeline_statistics->IsResolved(STATISTICS_SCOPE_GEOMETRY)) {
+			u64 invocations = m_pipeline_statistics->GetFragmentInvocations(STATISTICS_SCOPE_GEOMETRY);
+			m_geometry_fragment_invocations[m_depth_prepass_active ? 1 : 0] = invocations;
+			if (!m_depth_prepass_active) {
+				f32 overdraw = static_cast<f32>(invocations) / (m_render_context.GetRenderWidth() * m_render_context.GetRenderHeight());
+				m_auto_depth_prepass = overdraw > k_depth_prepass_overdraw;
+			}
+		}
+		if (m_pipeline_statistics->IsResolved(STATISTICS_SCOPE_DEPTH_PREPASS)) {
+			m_depth_prepass_fragment_invocations = m_pipeline_statistics->GetFragmentInvocations(STATISTICS_SCOPE_DEPTH_PREPASS);
+		}
+		m_frame_index++;
 	}
 
 	void Renderer::Wait() noexcept
@@ -88,168 +192,425 @@ namespace Horizon
 		return m_scene->GetMainCamera();
 	}
 
+	void Renderer::SetTiledLighting(bool enable) noexcept
+	{
+		if (enable) {
+			CreateSeparateDeferredPasses();
+		}
+		m_tiled_lighting = enable;
+	}
+
+	void Renderer::SetGpuDrivenGeometry(bool enable) noexcept
+	{
+		if (enable && !GpuDrivenGeometry::IsSupported(m_device)) {
+			LOG_WARN("gpu driven geometry needs indirect draws with a first instance, the cpu geometry path stays on");
+			enable = false;
+		}
+		if (enable && !m_gpu_driven_geometry_pass) {
+			CreateSeparateDeferredPasses();
+			m_gpu_driven_geometry_pass = std::make_shared<GpuDrivenGeometry>(m_scene, m_pipeline_manager, m_device, m_command_buffer, m_geometry_pass->GetPipeline(), m_render_context);
+		}
+		// visibility is decided on the gpu, turning it off culls on the cpu again
+		m_scene->SetCpuCulling(!enable);
+		m_gpu_driven_geometry = enable;
+	}
+
+	void Renderer::SetMergedDeferredPass(bool enable) noexcept
+	{
+		if (enable && UseGpuDrivenGeometry()) {
+			LOG_WARN("the merged deferred pass needs the cpu geometry path, gpu driven occlusion culling splits the geometry pass");
+		}
+		if (enable && !m_deferred_pass) {
+			m_deferred_pass = std::make_shared<DeferredPass>(m_scene, m_pipeline_manager, m_device, m_render_context);
+		}
+		if (!enable) {
+			CreateSeparateDeferredPasses();
+		}
+		m_merged_deferred_pass = enable;
+	}
+
+	void Renderer::SetDynamicResolution(bool enable, f32 target_frame_time) noexcept
+	{
+		if (enable && !m_gpu_timer->IsSupported()) {
+			LOG_WARN("dynamic resolution needs gpu timestamps, the render scale stays at 1");
+			enable = false;
+		}
+		m_dynamic_resolution->SetTargetFrameTime(target_frame_time);
+		m_dynamic_resolution->SetEnabled(enable);
+	}
+
+	void Renderer::SetFusedPostProcess(bool enable) noexcept
+	{
+		if (!enable && !m_post_process_pass) {
+			m_post_process_pass = std::make_shared<PostProcess>(m_pipeline_manager, m_device, m_render_context);
+			CreatePresentPipeline();
+		}
+		m_fused_post_process = enable;
+	}
+
+	void Renderer::SetDepthPrepass(DepthPrepassMode mode) noexcept
+	{
+		if (mode != DepthPrepassMode::OFF && (UseGpuDrivenGeometry() || m_merged_deferred_pass)) {
+			LOG_WARN("the depth pre-pass needs the cpu geometry path and the separate geometry pass");
+		}
+		if (mode == DepthPrepassMode::AUTO && !m_pipeline_statistics->IsSupported()) {
+			LOG_WARN("automatic depth pre-pass needs pipeline statistics queries, it stays off");
+		}
+		m_depth_prepass_mode = mode;
+
+		if (m_geometry_fragment_invocations[0] != 0) {
+			LOG_INFO("g buffer fragment invocations without depth pre-pass: " + std::to_string(m_geometry_fragment_invocations[0]));
+		}
+		if (m_geometry_fragment_invocations[1] != 0) {
+			LOG_INFO("g buffer fragment invocations with depth pre-pass: " + std::to_string(m_geometry_fragment_invocations[1]));
+			LOG_INFO("depth pre-pass fragment invocations: " + std::to_string(m_depth_prepass_fragment_invocations));
+		}
+	}
+
+	u64 Renderer::GetGeometryFragmentInvocations(bool depth_prepass) const noexcept
+	{
+		return m_geometry_fragment_invocations[depth_prepass ? 1 : 0];
+	}
+
+	void Renderer::SetSkyQuality(SkyQuality quality) noexcept
+	{
+		m_atmosphere_pass->SetSkyQuality(quality);
+
+		const char* names[] = { "full", "half", "quarter" };
+		f32 full_time = m_sky_times[static_cast<u32>(SkyQuality::FULL)];
+		for (u32 i = 0; i < m_sky_times.size(); i++) {
+			if (m_sky_times[i] == 0.0f) {
+				continue;
+			}
+			std::string message = std::string("sky at ") + names[i] + " resolution: " + std::to_string(m_sky_times[i]) + " ms";
+			if (i != static_cast<u32>(SkyQuality::FULL) && full_time != 0.0f) {
+				message += ", saves " + std::to_string(full_time - m_sky_times[i]) + " ms";
+			}
+			LOG_INFO(message);
+		}
+	}
+
+	void Renderer::SetTemporalSky(bool enable) noexcept
+	{
+		m_atmosphere_pass->SetTemporal(enable);
+	}
+
+	f32 Renderer::GetSkyTime(SkyQuality quality) const noexcept
+	{
+		return m_sky_times[static_cast<u32>(quality)];
+	}
+
+	void Renderer::ValidateAtmosphereLuts(u32 thread_count) noexcept
+	{
+		AtmosphereCpuPrecompute reference(thread_count);
+		reference.Precompute(m_atmosphere_pass->m_multi_scattering_order, m_atmosphere_pass->GetHaze(), m_atmosphere_pass->GetLutQuality());
+
+		std::string message = "atmosphere precompute on " + std::to_string(reference.GetThreadCount()) + " cpu threads: " + std::to_string(reference.GetTime()) + " ms";
+		if (m_atmosphere_precompute_time != 0.0f) {
+			message += ", on the gpu: " + std::to_string(m_atmosphere_precompute_time) + " ms";
+		}
+		LOG_INFO(message);
+
+		m_atmosphere_pass->ValidateLuts(reference);
+	}
+
+	void Renderer::SetAtmosphereHaze(f32 haze) noexcept
+	{
+		m_atmosphere_pass->SetHaze(haze);
+	}
+
+	void Renderer::SetAtmosphereUpdateBudget(f32 milliseconds) noexcept
+	{
+		if (!m_gpu_timer->IsSupported()) {
+			LOG_WARN("the atmosphere update budget needs gpu timestamps, updates run " + std::to_string(m_atmosphere_pass->GetLutUpdateBudget()) + " slices per frame");
+		}
+		m_atmosphere_update_budget = milliseconds;
+	}
+
+	void Renderer::SetAsyncCompute(bool enable) noexcept
+	{
+		if (enable && !m_compute_command_buffer) {
+			LOG_WARN("the device has no separate compute queue family, the atmosphere luts stay on the graphics queue");
+			enable = false;
+		}
+		m_render_graph.SetAsyncCompute(enable);
+	}
+
+	bool Renderer::UseGpuDrivenGeometry() const noexcept
+	{
+		return m_gpu_driven_geometry && m_gpu_driven_geometry_pass;
+	}
+
+	bool Renderer::UseMergedDeferredPass() const noexcept
+	{
+		return m_merged_deferred_pass && !UseGpuDrivenGeometry() && !m_tiled_lighting;
+	}
+
+	bool Renderer::UseDepthPrepass() const noexcept
+	{
+		if (UseGpuDrivenGeometry() || UseMergedDeferredPass()) {
+			return false;
+		}
+		switch (m_depth_prepass_mode)
+		{
+		case DepthPrepassMode::ON:
+			return true;
+		case DepthPrepassMode::AUTO:
+			return m_auto_depth_prepass && m_frame_index % k_depth_prepass_probe_interval != 0;
+		default:
+			return false;
+		}
+	}
+
 	void Renderer::DrawFrame() noexcept
 	{
+		BuildRenderGraph();
+
+		// with async compute the frame starts in the overlap command buffer, submitted before the main one
+		bool async_compute = m_render_graph.HasAsyncCompute();
+		std::shared_ptr<CommandBuffer> first_command_buffer = async_compute ? m_overlap_command_buffer : m_command_buffer;
+
 		for (u32 i = 0; i < m_render_context.swap_chain_image_count; i++)
 		{
 			m_command_buffer->beginCommandRecording(i);
+			if (async_compute) {
+				m_overlap_command_buffer->beginCommandRecording(i);
+				m_compute_command_buffer->beginCommandRecording(i);
+				// each queue resets the queries it writes, the queues do not wait for each other before them
+				m_gpu_timer->Reset(i, m_overlap_command_buffer, 0, TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE);
+				m_gpu_timer->Reset(i, m_compute_command_buffer, TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE, TIMER_SCOPE_COUNT - TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE);
+			}
+			else {
+				m_gpu_timer->Reset(i, m_command_buffer);
+			}
+			m_gpu_timer->Begin(i, first_command_buffer, TIMER_SCOPE_FRAME);
+			m_pipeline_statistics->Reset(i, first_command_buffer);
+			if (async_compute) {
+				m_render_graph.Execute(i, m_command_buffer, m_compute_command_buffer, m_overlap_command_buffer);
+			}
+			else {
+				m_render_graph.Execute(i, m_command_buffer);
+			}
+			m_gpu_timer->End(i, m_command_buffer, TIMER_SCOPE_FRAME);
+			if (async_compute) {
+				m_overlap_command_buffer->endCommandRecording(i);
+				m_compute_command_buffer->endCommandRecording(i);
+			}
+			m_command_buffer->endCommandRecording(i);
+		}
+	}
 
-			// geometry pass
-			m_scene->Draw(i, m_command_buffer, m_geometry_pass->GetPipeline());
-
-			m_fullscreen_triangle->Draw(i, m_command_buffer, m_light_pass->GetPipeline(), { m_light_pass->m_descriptorset });
-
-			// scattering pass
-			
-			if (!m_atmosphere_pass->precomputed) {
-				m_command_buffer->Dispatch(i, m_atmosphere_pass->m_transmittance_lut_pass, { m_atmosphere_pass->m_transmittance_lut_descriptor_set });
-				
-				// barrier
-				{
-					BarrierDesc desc1;
-					ImageMemoryBarrierDesc transmittance_lut_barrier;
-					transmittance_lut_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-					transmittance_lut_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-					transmittance_lut_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-					transmittance_lut_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-					transmittance_lut_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-					transmittance_lut_barrier.texture = m_atmosphere_pass->transmittance_lut;
-					desc1.image_memory_barriers.push_back(transmittance_lut_barrier);
-					desc1.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-					desc1.dst_stage= PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-					InsertBarrier(i, m_command_buffer, desc1);
+	void Renderer::BuildRenderGraph() noexcept
+	{
+		using namespace RenderGraphAccess;
+
+		m_render_graph.Clear();
+
+		bool merged_deferred_pass = UseMergedDeferredPass();
+		auto framebuffer = [](std::shared_ptr<Pipeline> pipeline) { return std::static_pointer_cast<GraphicsPipeline>(pipeline)->GetFramebuffer(); };
+
+		// the g buffer depth is read until the sky is done, the colors only until lighting, so they are separate resources
+		// and the colors can share memory with the sky. the merged pass only keeps its depth
+		RenderGraphResource gbuffer_depth = merged_deferred_pass ? m_render_graph.ImportAttachment("gbuffer depth") : m_render_graph.ImportAttachment("gbuffer depth", framebuffer(m_geometry_pass->GetPipeline()), { 3 });
+		RenderGraphResource light_index_counter = m_render_graph.ImportBuffer("light index counter", m_light_culling_pass->GetLightIndexCounter());
+		RenderGraphResource light_grid = m_render_graph.ImportBuffer("light grid", m_light_culling_pass->GetLightGrid());
+		RenderGraphResource light_indices = m_render_graph.ImportBuffer("light indices", m_light_culling_pass->GetLightIndices());
+		RenderGraphResource lighting = m_tiled_lighting ? m_render_graph.ImportTexture("lighting", m_tiled_light_pass->GetOutput(), TextureUsage::TEXTURE_USAGE_RW) :
+			merged_deferred_pass ? m_render_graph.ImportAttachment("lighting") : m_render_graph.ImportAttachment("lighting", framebuffer(m_light_pass->GetPipeline()));
+		RenderGraphResource transmittance_lut = m_render_graph.ImportTexture("transmittance lut", m_atmosphere_pass->transmittance_lut, TextureUsage::TEXTURE_USAGE_RW);
+		RenderGraphResource scattering_lut = m_render_graph.ImportTexture("scattering lut", m_atmosphere_pass->_scattering_tex, TextureUsage::TEXTURE_USAGE_RW);
+		RenderGraphResource sky_view_lut = m_render_graph.ImportTexture("sky view lut", m_atmosphere_pass->sky_view_lut, TextureUsage::TEXTURE_USAGE_RW);
+		RenderGraphResource camera_volume = m_render_graph.ImportTexture("camera volume", m_atmosphere_pass->camera_volume, TextureUsage::TEXTURE_USAGE_RW);
+		RenderGraphResource sky = m_render_graph.ImportAttachment("sky", framebuffer(m_atmosphere_pass->m_sky_pass));
+		RenderGraphResource back_buffer = m_render_graph.ImportAttachment("back buffer");
+		m_render_graph.MarkOutput(back_buffer);
+
+		// bin lights into clusters, culled by the graph when tiled lighting does not read the lists
+		u32 light_culling = m_render_graph.AddPass("light culling", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+			m_light_culling_pass->Dispatch(i, command_buffer);
+		});
+		m_render_graph.ReadWrite(light_culling, light_index_counter, k_clear_compute_read_write);
+		m_render_graph.Write(light_culling, light_grid, k_compute_write);
+		m_render_graph.Write(light_culling, light_indices, k_compute_write);
+
+		if (merged_deferred_pass) {
+			u32 deferred = m_render_graph.AddPass("deferred", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_deferred_pass->Render(i, command_buffer, m_fullscreen_triangle);
+			});
+			m_render_graph.Read(deferred, light_grid, k_fragment_read);
+			m_render_graph.Read(deferred, light_indices, k_fragment_read);
+			m_render_graph.Write(deferred, gbuffer_depth, k_depth_attachment_write);
+			m_render_graph.Write(deferred, lighting, k_color_attachment_write);
+		}
+		else {
+			RenderGraphResource gbuffer = m_render_graph.ImportAttachment("gbuffer", framebuffer(m_geometry_pass->GetPipeline()), { 0, 1, 2 });
+
+			bool depth_prepass = UseDepthPrepass();
+			m_depth_prepass_active = depth_prepass;
+			if (depth_prepass) {
+				// lays down the closest depth, clears the color targets the geometry pass loads
+				u32 prepass = m_render_graph.AddPass("depth prepass", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+					m_pipeline_statistics->Begin(i, command_buffer, STATISTICS_SCOPE_DEPTH_PREPASS);
+					m_scene->DrawDepth(i, command_buffer, m_geometry_pass->GetDepthPrepassPipeline(), m_geometry_pass->GetDepthEqualPipeline());
+					m_pipeline_statistics->End(i, command_buffer, STATISTICS_SCOPE_DEPTH_PREPASS);
+				});
+				m_render_graph.Write(prepass, gbuffer, k_color_attachment_write);
+				m_render_graph.Write(prepass, gbuffer_depth, k_depth_attachment_write);
+			}
+
+			u32 geometry = m_render_graph.AddPass("geometry", [this, depth_prepass](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_pipeline_statistics->Begin(i, command_buffer, STATISTICS_SCOPE_GEOMETRY);
+				if (UseGpuDrivenGeometry()) {
+					m_gpu_driven_geometry_pass->Render(i, command_buffer);
+				}
+				else if (depth_prepass) {
+					m_scene->Draw(i, command_buffer, m_geometry_pass->GetDepthEqualPipeline(), true);
 				}
+				else {
+					m_scene->Draw(i, command_buffer, m_geometry_pass->GetPipeline());
+				}
+				m_pipeline_statistics->End(i, command_buffer, STATISTICS_SCOPE_GEOMETRY);
+			});
+			if (depth_prepass) {
+				m_render_graph.ReadWrite(geometry, gbuffer, k_color_attachment_write);
+				m_render_graph.ReadWrite(geometry, gbuffer_depth, k_depth_attachment_write);
+			}
+			else {
+				m_render_graph.Write(geometry, gbuffer, k_color_attachment_write);
+				m_render_graph.Write(geometry, gbuffer_depth, k_depth_attachment_write);
+			}
 
-				m_command_buffer->Dispatch(i, m_atmosphere_pass->m_direct_irradiance_lut_pass, { m_atmosphere_pass->m_direct_irradiance_lut_descriptor_set });
-
-				m_command_buffer->Dispatch(i, m_atmosphere_pass->m_single_scattering_lut_pass, { m_atmosphere_pass->m_single_scattering_lut_descriptor_set });
-				
-				// barrier
-				{
-					BarrierDesc desc2;
-
-					ImageMemoryBarrierDesc delta_r_barrier;
-					delta_r_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-					delta_r_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-					delta_r_barrier.texture = m_atmosphere_pass->single_rayleigh_scattering_lut;
-					delta_r_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-					delta_r_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-					ImageMemoryBarrierDesc delta_mie_barrier;
-					delta_mie_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-					delta_mie_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-					delta_mie_barrier.texture = m_atmosphere_pass->single_mie_scattering_lut;
-					delta_mie_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-					delta_mie_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-					ImageMemoryBarrierDesc irradiance_barrier;
-					irradiance_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-					irradiance_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-					irradiance_barrier.texture = m_atmosphere_pass->direct_irradiance_lut;
-					irradiance_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-					irradiance_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-					ImageMemoryBarrierDesc multi_scattering_barrier;
-					multi_scattering_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-					multi_scattering_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-					multi_scattering_barrier.texture = m_atmosphere_pass->multi_scattering_lut;
-					multi_scattering_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-					multi_scattering_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-					desc2.image_memory_barriers.push_back(delta_r_barrier);
-					desc2.image_memory_barriers.push_back(delta_mie_barrier);
-					desc2.image_memory_barriers.push_back(irradiance_barrier);
-					desc2.image_memory_barriers.push_back(multi_scattering_barrier);
-
-					desc2.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-					desc2.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-
-					InsertBarrier(i, m_command_buffer, desc2);
+			if (m_tiled_lighting) {
+				// tiles cull their own lights
+				u32 tiled_lighting = m_render_graph.AddPass("tiled lighting", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+					m_tiled_light_pass->Dispatch(i, command_buffer);
+				});
+				m_render_graph.Read(tiled_lighting, gbuffer, k_compute_read);
+				m_render_graph.Read(tiled_lighting, gbuffer_depth, k_compute_read);
+				m_render_graph.Write(tiled_lighting, lighting, k_compute_write);
+			}
+			else {
+				u32 light = m_render_graph.AddPass("lighting", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+					m_fullscreen_triangle->Draw(i, command_buffer, m_light_pass->GetPipeline(), { m_light_pass->m_descriptorset });
+				});
+				m_render_graph.Read(light, gbuffer, k_fragment_read);
+				m_render_graph.Read(light, gbuffer_depth, k_fragment_read);
+				m_render_graph.Read(light, light_grid, k_fragment_read);
+				m_render_graph.Read(light, light_indices, k_fragment_read);
+				m_render_graph.Write(light, lighting, k_color_attachment_write);
+			}
+		}
 
+		if (!m_atmosphere_pass->precomputed) {
+			// only recorded into the first command buffer, later frames sample the finished luts
+			u32 precompute = m_render_graph.AddPass("atmosphere precompute", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				if (!m_atmosphere_pass->precomputed) {
+					m_gpu_timer->Begin(i, command_buffer, TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE);
+					m_atmosphere_pass->PrecomputeLuts(i, command_buffer);
+					m_gpu_timer->End(i, command_buffer, TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE);
 				}
+			}, RenderGraphQueue::ASYNC_COMPUTE);
+			m_render_graph.ReadWrite(precompute, transmittance_lut, k_compute_read_write);
+			m_render_graph.ReadWrite(precompute, scattering_lut, k_compute_read_write);
+		}
 
-				for (u32 j = 0; j < m_atmosphere_pass->m_multi_scattering_order; j++) {
-					m_atmosphere_pass->scattering_order_push_constants->ranges[0].value = &m_atmosphere_pass->layers[j + 1];
-					m_command_buffer->Dispatch(i, m_atmosphere_pass->m_scattering_density_lut, { m_atmosphere_pass->m_scattering_density_lut_descriptor_set });
-					// barrier
-					{
-						BarrierDesc desc;
-						desc.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-						desc.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-						InsertBarrier(i, m_command_buffer, desc);
-					}
-					m_atmosphere_pass->scattering_order_push_constants->ranges[0].value = &m_atmosphere_pass->layers[j];
-					m_command_buffer->Dispatch(i, m_atmosphere_pass->m_indirect_irradiance_lut, { m_atmosphere_pass->m_indirect_irradiance_lut_descriptor_set });
-					// barrier
-					{
-						BarrierDesc desc2;
-
-						ImageMemoryBarrierDesc density_barrier;
-						density_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-						density_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-						density_barrier.texture = m_atmosphere_pass->scattering_density_lut;
-						density_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-						density_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-						ImageMemoryBarrierDesc multi_scattering_barrier;
-						multi_scattering_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-						multi_scattering_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-						multi_scattering_barrier.texture = m_atmosphere_pass->single_rayleigh_scattering_lut;
-						multi_scattering_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-						multi_scattering_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-						desc2.image_memory_barriers.push_back(density_barrier);
-						desc2.image_memory_barriers.push_back(multi_scattering_barrier);
-
-						desc2.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-						desc2.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT | PipelineStageFlags::PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-
-						InsertBarrier(i, m_command_buffer, desc2);
-
-					}
-					m_atmosphere_pass->scattering_order_push_constants->ranges[0].value = &m_atmosphere_pass->layers[j + 1];
-					m_command_buffer->Dispatch(i, m_atmosphere_pass->m_multi_scattering_lut, { m_atmosphere_pass->m_multi_scattering_lut_descriptor_set });
-					// barrier
-					{
-						BarrierDesc desc2;
-
-						ImageMemoryBarrierDesc _scattering_barrier;
-						_scattering_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-						_scattering_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-						_scattering_barrier.texture = m_atmosphere_pass->_scattering_tex;
-						_scattering_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-						_scattering_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-						ImageMemoryBarrierDesc multi_scattering_barrier;
-						multi_scattering_barrier.src_access_mask = MemoryAccessFlags::ACCESS_SHADER_WRITE_BIT;
-						multi_scattering_barrier.dst_access_mask = MemoryAccessFlags::ACCESS_SHADER_READ_BIT;
-						multi_scattering_barrier.texture = m_atmosphere_pass->single_rayleigh_scattering_lut;
-						multi_scattering_barrier.src_usage = TextureUsage::TEXTURE_USAGE_RW;
-						multi_scattering_barrier.dst_usage = TextureUsage::TEXTURE_USAGE_RW;
-
-						desc2.image_memory_barriers.push_back(_scattering_barrier);
-						desc2.image_memory_barriers.push_back(multi_scattering_barrier);
-
-						desc2.src_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-						desc2.dst_stage = PipelineStageFlags::PIPELINE_STAGE_COMPUTE_SHADER_BIT | PipelineStageFlags::PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-
-						InsertBarrier(i, m_command_buffer, desc2);
-					}
-				}
-				m_atmosphere_pass->precomputed = true;
+		if (m_atmosphere_pass->IsUpdatingLuts()) {
+			// a few slices of the chain per frame into the second set of luts, outputs as the sky samples them only
+			// once the set is complete
+			u32 update = m_render_graph.AddPass("atmosphere lut update", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_gpu_timer->Begin(i, command_buffer, TIMER_SCOPE_ATMOSPHERE_UPDATE);
+				m_atmosphere_pass->UpdateLuts(i, command_buffer);
+				m_gpu_timer->End(i, command_buffer, TIMER_SCOPE_ATMOSPHERE_UPDATE);
+			}, RenderGraphQueue::ASYNC_COMPUTE);
+			const char* names[] = { "updated transmittance lut", "updated irradiance lut", "updated scattering lut" };
+			auto updated_luts = m_atmosphere_pass->GetUpdatedLuts();
+			for (u32 i = 0; i < updated_luts.size(); i++) {
+				RenderGraphResource lut = m_render_graph.ImportTexture(names[i], updated_luts[i], TextureUsage::TEXTURE_USAGE_RW);
+				m_render_graph.ReadWrite(update, lut, k_compute_read_write);
+				m_render_graph.MarkOutput(lut);
 			}
+		}
 
-			//TODO: barrier
-
-			m_fullscreen_triangle->Draw(i, m_command_buffer, m_atmosphere_pass->m_sky_pass, {m_atmosphere_pass->m_sky_descriptor_set});
+		// sky view and aerial perspective around the camera, rebuilt every frame as the camera moves.
+		// the atmosphere passes only depend on each other, on the compute queue they overlap the geometry and lighting
+		u32 sky_luts = m_render_graph.AddPass("sky luts", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+			m_atmosphere_pass->ComputeSkyLuts(i, command_buffer);
+		}, RenderGraphQueue::ASYNC_COMPUTE);
+		m_render_graph.Read(sky_luts, transmittance_lut, k_compute_read);
+		m_render_graph.Read(sky_luts, scattering_lut, k_compute_read);
+		m_render_graph.Write(sky_luts, sky_view_lut, k_compute_write);
+		m_render_graph.Write(sky_luts, camera_volume, k_compute_write);
+
+		if (!m_atmosphere_pass->NeedsUpsample()) {
+			u32 scattering = m_render_graph.AddPass("scattering", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_gpu_timer->Begin(i, command_buffer, TIMER_SCOPE_SKY);
+				m_fullscreen_triangle->Draw(i, command_buffer, m_atmosphere_pass->m_sky_pass, { m_atmosphere_pass->m_sky_descriptor_set });
+				m_gpu_timer->End(i, command_buffer, TIMER_SCOPE_SKY);
+			});
+			m_render_graph.Read(scattering, lighting, k_fragment_read);
+			m_render_graph.Read(scattering, gbuffer_depth, k_fragment_read);
+			m_render_graph.Read(scattering, transmittance_lut, k_fragment_read);
+			m_render_graph.Read(scattering, scattering_lut, k_fragment_read);
+			m_render_graph.Read(scattering, sky_view_lut, k_fragment_read);
+			m_render_graph.Read(scattering, camera_volume, k_fragment_read);
+			m_render_graph.Write(scattering, sky, k_color_attachment_write);
+		}
+		else {
+			// scattering at reduced resolution or reprojected, the upsample adds it to the lighting where the depths agree
+			RenderGraphResource low_resolution_sky = m_render_graph.ImportAttachment("low resolution sky", framebuffer(m_atmosphere_pass->GetScatteringPass()));
+
+			u32 scattering = m_render_graph.AddPass("scattering", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_gpu_timer->Begin(i, command_buffer, TIMER_SCOPE_SKY);
+				m_fullscreen_triangle->Draw(i, command_buffer, m_atmosphere_pass->GetScatteringPass(), { m_atmosphere_pass->m_sky_descriptor_set });
+				m_gpu_timer->End(i, command_buffer, TIMER_SCOPE_SKY);
+			});
+			m_render_graph.Read(scattering, gbuffer_depth, k_fragment_read);
+			m_render_graph.Read(scattering, transmittance_lut, k_fragment_read);
+			m_render_graph.Read(scattering, scattering_lut, k_fragment_read);
+			m_render_graph.Read(scattering, sky_view_lut, k_fragment_read);
+			m_render_graph.Read(scattering, camera_volume, k_fragment_read);
+			m_render_graph.Write(scattering, low_resolution_sky, k_color_attachment_write);
+			if (m_atmosphere_pass->IsTemporal()) {
+				// written by the last frame
+				RenderGraphResource sky_history = m_render_graph.ImportAttachment("sky history", framebuffer(m_atmosphere_pass->GetHistoryPass()));
+				m_render_graph.Read(scattering, sky_history, k_fragment_read);
+			}
 
-			// post process pass
-			m_fullscreen_triangle->Draw(i, m_command_buffer, m_post_process_pass->GetPipeline(), {m_post_process_pass->GetDescriptorSet()});
-			// final present pass
-			m_fullscreen_triangle->Draw(i, m_command_buffer, m_pipeline_manager->Get("present"), {m_present_descriptorSet}, true);
+			u32 upsample = m_render_graph.AddPass("sky upsample", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_gpu_timer->Begin(i, command_buffer, TIMER_SCOPE_SKY_UPSAMPLE);
+				m_fullscreen_triangle->Draw(i, command_buffer, m_atmosphere_pass->m_sky_upsample_pass, { m_atmosphere_pass->m_sky_descriptor_set });
+				m_gpu_timer->End(i, command_buffer, TIMER_SCOPE_SKY_UPSAMPLE);
+			});
+			m_render_graph.Read(upsample, lighting, k_fragment_read);
+			m_render_graph.Read(upsample, gbuffer_depth, k_fragment_read);
+			m_render_graph.Read(upsample, low_resolution_sky, k_fragment_read);
+			m_render_graph.Write(upsample, sky, k_color_attachment_write);
+		}
 
-			m_command_buffer->endCommandRecording(i);
+		if (m_fused_post_process) {
+			u32 post = m_render_graph.AddPass("post process", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_fullscreen_triangle->Draw(i, command_buffer, m_fused_post_process_pass->GetPipeline(), { m_fused_post_process_pass->GetDescriptorSet() }, true);
+			});
+			m_render_graph.Read(post, sky, k_fragment_read);
+			m_render_graph.Write(post, back_buffer, k_color_attachment_write);
+		}
+		else {
+			RenderGraphResource post_process = m_render_graph.ImportAttachment("post process", framebuffer(m_post_process_pass->GetPipeline()));
+
+			u32 post = m_render_graph.AddPass("post process", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_fullscreen_triangle->Draw(i, command_buffer, m_post_process_pass->GetPipeline(), { m_post_process_pass->GetDescriptorSet() });
+			});
+			m_render_graph.Read(post, sky, k_fragment_read);
+			m_render_graph.Write(post, post_process, k_color_attachment_write);
+
+			u32 present = m_render_graph.AddPass("present", [this](u32 i, std::shared_ptr<CommandBuffer> command_buffer) {
+				m_fullscreen_triangle->Draw(i, command_buffer, m_pipeline_manager->Get("present"), { m_present_descriptorSet }, true);
+			});
+			m_render_graph.Read(present, post_process, k_fragment_read);
+			m_render_graph.Write(present, back_buffer, k_color_attachment_write);
 		}
+
+		m_render_graph.Compile();
 	}
 
 	void Renderer::PrepareAssests() noexcept
@@ -276,16 +637,34 @@ namespace Horizon
 	void Renderer::CreatePipelines() noexcept
 	{
 
-		m_geometry_pass = std::make_shared<Geometry>(m_scene, m_pipeline_manager, m_device, m_render_context);
+		// the merged pass holds its own g buffer, the separate passes and their targets are only created once needed
+		if (m_merged_deferred_pass) {
+			m_deferred_pass = std::make_shared<DeferredPass>(m_scene, m_pipeline_manager, m_device, m_render_context);
+		}
+		else {
+			CreateSeparateDeferredPasses();
+		}
 
-		m_light_pass = std::make_shared<LightPass>(m_scene, m_pipeline_manager, m_device, m_render_context);
+		m_light_culling_pass = std::make_shared<LightCulling>(m_scene, m_pipeline_manager, m_device, m_render_context);
 
-		m_atmosphere_pass = std::make_shared<Atmosphere>(m_pipeline_manager, m_device, m_command_buffer, m_render_context);
+		m_tiled_light_pass = std::make_shared<TiledLightPass>(m_scene, m_pipeline_manager, m_device, m_command_buffer, m_render_context);
 
-		m_post_process_pass = std::make_shared<PostProcess>(m_pipeline_manager, m_device, m_render_context);
+		m_atmosphere_pass = std::make_shared<Atmosphere>(m_pipeline_manager, m_device, m_command_buffer, m_render_context, m_atmosphere_lut_quality);
 
-		CreatePresentPipeline();
+		// tone mapping writes the swap chain, the separate post process target and present pass are created on demand
+		m_fused_post_process_pass = std::make_shared<PostProcess>(m_pipeline_manager, m_device, m_render_context, m_swap_chain);
+	}
+	void Renderer::CreateSeparateDeferredPasses() noexcept
+	{
+		// created after the first compile their targets keep dedicated memory
+		if (!m_geometry_pass) {
+			m_geometry_pass = std::make_shared<Geometry>(m_scene, m_pipeline_manager, m_device, m_render_context);
+		}
+		if (!m_light_pass) {
+			m_light_pass = std::make_shared<LightPass>(m_scene, m_pipeline_manager, m_device, m_render_context);
+		}
 	}
+
 	void Renderer::CreatePresentPipeline() noexcept
 	{
 		// present pass
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <vulkan/vulkan.hpp>
 
 #include <runtime/function/rhi/RenderContext.h>
@@ -12,19 +14,37 @@
 #include <runtime/function/rhi/vulkan/Descriptors.h>
 #include <runtime/function/rhi/vulkan/Pipeline.h>
 #include <runtime/function/rhi/vulkan/Framebuffer.h>
+#include <runtime/function/rhi/vulkan/GpuTimer.h>
+#include <runtime/function/rhi/vulkan/PipelineStatistics.h>
 #include <runtime/function/rhi/vulkan/UniformBuffer.h>
 #include <runtime/scene/render/Atmosphere.h>
+#include <runtime/scene/render/DeferredPass.h>
+#include <runtime/scene/render/DynamicResolution.h>
 #include <runtime/scene/render/PostProcess.h>
+#include <runtime/scene/render/RenderGraph.h>
 #include <runtime/scene/render/Geometry.h>
+#include <runtime/scene/render/GpuDriven.h>
+#include <runtime/scene/render/LightCulling.h>
 #include <runtime/scene/render/LightPass.h>
+#include <runtime/scene/render/TiledLightPass.h>
 #include <runtime/scene/scene/Scene.h>
 
 namespace Horizon
 {
+	enum class DepthPrepassMode
+	{
+		OFF,
+		ON,
+		// on while the g buffer pass shades each pixel more than k_depth_prepass_overdraw times without it
+		AUTO
+	};
+
 	class Renderer
 	{
 	public:
-		Renderer(u32 width, u32 height, std::shared_ptr<Window> window) noexcept;
+		// the atmosphere lut quality is fixed for the lifetime of the renderer, lower presets fit smaller devices.
+		// starting with the merged deferred pass skips the separate g buffer and lighting targets until they are needed
+		Renderer(u32 width, u32 height, std::shared_ptr<Window> window, AtmosphereLutQuality atmosphere_lut_quality = AtmosphereLutQuality::HIGH, bool merged_deferred_pass = false) noexcept;
 
 		~Renderer() noexcept;
 
@@ -38,15 +58,100 @@ namespace Horizon
 
 		std::shared_ptr<Camera> GetMainCamera() const noexcept;
 
+		// switch between the clustered fragment light pass and the tiled compute light pass, takes effect on the next Update
+		void SetTiledLighting(bool enable) noexcept;
+
+		// cull and draw the geometry on the gpu with indirect draws, off by default. while it is on the cpu culling,
+		// draw sorting and instancing, the merged deferred pass and the depth pre-pass are unused
+		void SetGpuDrivenGeometry(bool enable) noexcept;
+
+		// geometry and clustered lighting as subpasses of one render pass with a transient g buffer.
+		// only used with the cpu geometry path and the fragment light pass, otherwise the separate passes run
+		void SetMergedDeferredPass(bool enable) noexcept;
+
+		// scale the render area of the scene passes to hold the gpu frame time at target_frame_time milliseconds,
+		// the post process pass upscales to the swap chain size
+		void SetDynamicResolution(bool enable, f32 target_frame_time = 16.6f) noexcept;
+
+		// tone map straight into the swap chain, on by default. disabling it creates the intermediate post process
+		// target and the present pass that copies it out. the target is created after the aliased attachments are
+		// placed, so it gets dedicated memory
+		void SetFusedPostProcess(bool enable) noexcept;
+
+		// depth only pass before the g buffer pass, which then shades only the visible surface.
+		// only used with the cpu geometry path and the separate geometry pass
+		void SetDepthPrepass(DepthPrepassMode mode) noexcept;
+
+		// fragment shader invocations of the g buffer pass in the last frame measured with and without the pre-pass
+		u64 GetGeometryFragmentInvocations(bool depth_prepass) const noexcept;
+
+		// resolution of the atmosphere scattering, logs the gpu time measured at each quality used so far
+		void SetSkyQuality(SkyQuality quality) noexcept;
+
+		// evaluate a quarter of the sky pixels each frame and reproject the rest from the last frame
+		void SetTemporalSky(bool enable) noexcept;
+
+		// smoothed gpu milliseconds of the sky passes at a quality, zero until it has been rendered
+		f32 GetSkyTime(SkyQuality quality) const noexcept;
+
+		// runs the cpu reference of the atmosphere precompute, compares it with the gpu luts and logs both timings
+		void ValidateAtmosphereLuts(u32 thread_count = 0) noexcept;
+
+		// rebuilds the atmosphere luts for a new haze over several frames, the sky keeps the previous luts meanwhile
+		void SetAtmosphereHaze(f32 haze) noexcept;
+
+		// gpu milliseconds per frame an atmosphere lut update may take, the slices per frame follow the measured time
+		void SetAtmosphereUpdateBudget(f32 milliseconds) noexcept;
+
+		// run the atmosphere lut work on the compute queue next to the geometry and lighting passes, on by default
+		// when the device has a separate compute queue family. takes effect on the next frame
+		void SetAsyncCompute(bool enable) noexcept;
+
 	private:
+		// gpu timer scopes, with async compute the scopes from TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE on are written on the compute queue
+		enum TimerScope
+		{
+			TIMER_SCOPE_FRAME,
+			// scattering, and the upsample of the reduced resolution sky when there is one. scopes stay inside one graph pass
+			TIMER_SCOPE_SKY,
+			TIMER_SCOPE_SKY_UPSAMPLE,
+			TIMER_SCOPE_ATMOSPHERE_PRECOMPUTE,
+			TIMER_SCOPE_ATMOSPHERE_UPDATE,
+			TIMER_SCOPE_COUNT
+		};
+
+		// pipeline statistics scopes
+		enum StatisticsScope
+		{
+			STATISTICS_SCOPE_GEOMETRY,
+			STATISTICS_SCOPE_DEPTH_PREPASS,
+			STATISTICS_SCOPE_COUNT
+		};
+
+		// fragments per render pixel of the g buffer pass without a pre-pass above which AUTO enables it
+		static constexpr f32 k_depth_prepass_overdraw = 1.5f;
+		// AUTO skips the pre-pass once in this many frames to measure the overdraw again
+		static constexpr u32 k_depth_prepass_probe_interval = 240;
+
 		void DrawFrame() noexcept;
 
+		bool UseGpuDrivenGeometry() const noexcept;
+
+		bool UseMergedDeferredPass() const noexcept;
+
+		bool UseDepthPrepass() const noexcept;
+
+		// declare the passes of the current configuration and compile the graph
+		void BuildRenderGraph() noexcept;
+
 		void PrepareAssests() noexcept;
 
 		// create pipeline layouts for each pass
 		void CreatePipelines() noexcept;
 
 		void CreatePresentPipeline() noexcept;
+		// geometry and light pass, used whenever the merged deferred pass is not
+		void CreateSeparateDeferredPasses() noexcept;
 
 	private:
 		RenderContext m_render_context;
@@ -57,6 +162,10 @@ namespace Horizon
 		std::shared_ptr<SwapChain> m_swap_chain = nullptr;
 		std::shared_ptr<PipelineManager> m_pipeline_manager = nullptr;
 		std::shared_ptr<CommandBuffer> m_command_buffer = nullptr;
+		// nullptr without a separate compute queue family
+		std::shared_ptr<CommandBuffer> m_compute_command_buffer = nullptr;
+		// graphics work that runs next to the compute queue, before the passes waiting for it
+		std::shared_ptr<CommandBuffer> m_overlap_command_buffer = nullptr;
 		std::shared_ptr<Scene> m_scene = nullptr;
 		std::shared_ptr<FullscreenTriangle> m_fullscreen_triangle = nullptr;
 		// sync primitives
@@ -70,8 +179,41 @@ namespace Horizon
 		std::shared_ptr<DescriptorSet> m_present_descriptorSet;
 
 		std::shared_ptr<Atmosphere> m_atmosphere_pass;
+		// writes the swap chain images
+		std::shared_ptr<PostProcess> m_fused_post_process_pass;
+		// created on first use, together with the present pipeline
 		std::shared_ptr<PostProcess> m_post_process_pass;
+		bool m_fused_post_process = true;
+		// created on first use when the renderer starts with the merged deferred pass
 		std::shared_ptr<Geometry> m_geometry_pass;
+		// created on first use, needs indirect draws with a first instance
+		std::shared_ptr<GpuDrivenGeometry> m_gpu_driven_geometry_pass;
+		bool m_gpu_driven_geometry = false;
+		std::shared_ptr<LightCulling> m_light_culling_pass;
+		// created on first use when the renderer starts with the merged deferred pass
 		std::shared_ptr<LightPass> m_light_pass;
+		std::shared_ptr<TiledLightPass> m_tiled_light_pass;
+		bool m_tiled_lighting = false;
+		// created on first use, holds its own transient g buffer
+		std::shared_ptr<DeferredPass> m_deferred_pass;
+		bool m_merged_deferred_pass = false;
+		std::shared_ptr<DynamicResolution> m_dynamic_resolution;
+		std::shared_ptr<GpuTimer> m_gpu_timer;
+		std::array<f32, 3> m_sky_times{};
+		// zero when the luts came from the cache
+		f32 m_atmosphere_precompute_time = 0.0f;
+		f32 m_atmosphere_update_budget = 1.0f;
+		AtmosphereLutQuality m_atmosphere_lut_quality;
+		std::shared_ptr<PipelineStatistics> m_pipeline_statistics;
+		DepthPrepassMode m_depth_prepass_mode = DepthPrepassMode::OFF;
+		bool m_auto_depth_prepass = false;
+		// whether the frame being rendered has the pre-pass, set when the graph is built
+		bool m_depth_prepass_active = false;
+		// without and with the pre-pass
+		std::array<u64, 2> m_geometry_fragment_invocations{};
+		u64 m_depth_prepass_fragment_invocations = 0;
+		u32 m_frame_index = 0;
+
+		RenderGraph m_render_graph;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "TiledLightPass.h"
+
+#include <runtime/function/rhi/RenderContext.h>
+#include <runtime/core/path/Path.h>
+
+namespace Horizon
+{
+	TiledLightPass::TiledLightPass(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> _command_buffer, RenderContext &_render_context) noexcept : m_render_context(_render_context)
+	{
+		TextureCreateInfo output_create_info{ TextureType::TEXTURE_TYPE_2D, TextureFormat::TEXTURE_FORMAT_RGBA16_SFLOAT, TextureUsage::TEXTURE_USAGE_RW, _render_context.width, _render_context.height, 1, 1 };
+		m_output = std::make_shared<Texture>(_device, _command_buffer, output_create_info);
+
+		std::shared_ptr<DescriptorSetInfo> descriptor_set_create_info = std::make_shared<DescriptorSetInfo>();
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // light count
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // lights
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // camera
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // depth
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // normal
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // albedo
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // roughness metallic
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_COMPUTE_SHADER); // cluster params, for view and inverse projection
+		descriptor_set_create_info->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_TEXTURE, SHADER_STAGE_COMPUTE_SHADER); // output
+		m_descriptor_set = std::make_shared<DescriptorSet>(_device, descriptor_set_create_info);
+
+		std::shared_ptr<DescriptorSetLayouts> layouts = std::make_shared<DescriptorSetLayouts>();
+		layouts->layouts.push_back(m_descriptor_set->GetLayout());
+
+		ComputePipelineCreateInfo pipeline_create_info;
+		pipeline_create_info.name = "tiled_shading";
+		pipeline_create_info.cs = std::make_shared<Shader>(_device->Get(), Path::GetInstance().GetShaderPath("tiled_shading.comp.spv"));
+		pipeline_create_info.descriptor_layouts = layouts;
+		m_pipeline = _pipeline_manager->CreateComputePipeline(pipeline_create_info);
+
+		m_descriptor_set_update_desc.BindResource(8, m_output);
+	}
+
+	TiledLightPass::~TiledLightPass() noexcept
+	{
+	}
+
+	void TiledLightPass::BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept
+	{
+		m_descriptor_set_update_desc.BindResource(binding, buffer);
+	}
+
+	void TiledLightPass::UpdateDescriptorSets() noexcept
+	{
+		m_descriptor_set->UpdateDescriptorSet(m_descriptor_set_update_desc);
+	}
+
+	void TiledLightPass::Dispatch(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept
+	{
+		// only the render area, the shader skips pixels outside of it
+		u32 group_count_x = (m_render_context.GetRenderWidth() + k_tile_size - 1) / k_tile_size;
+		u32 group_count_y = (m_render_context.GetRenderHeight() + k_tile_size - 1) / k_tile_size;
+		_command_buffer->Dispatch(_i, m_pipeline, { m_descriptor_set }, group_count_x, group_count_y, 1);
+	}
+
+	std::shared_ptr<Texture> TiledLightPass::GetOutput() const noexcept
+	{
+		return m_output;
+	}
+
+}
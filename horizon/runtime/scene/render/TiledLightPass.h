@@ -0,0 +1,39 @@
+#pragma once
+#include <memory>
+#include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/function/rhi/vulkan/Descriptors.h>
+#include <runtime/function/rhi/vulkan/Pipeline.h>
+#include <runtime/function/rhi/vulkan/Texture.h>
+#include <runtime/scene/scene/Scene.h>
+
+namespace Horizon
+{
+
+    // compute alternative to LightPass: one workgroup per 16x16 tile computes the tile's depth range,
+    // culls the lights against the tile frustum in shared memory and shades its pixels into a storage image.
+    // bindings match LightPass for 0 - 7, binding 8 is the hdr output
+    class TiledLightPass
+    {
+    public:
+        TiledLightPass(std::shared_ptr<Scene> _scene, std::shared_ptr<PipelineManager> _pipeline_manager, std::shared_ptr<Device> _device, std::shared_ptr<CommandBuffer> _command_buffer, RenderContext &_render_context) noexcept;
+        ~TiledLightPass() noexcept;
+
+        void UpdateDescriptorSets() noexcept;
+        void BindResource(u32 binding, std::shared_ptr<DescriptorBase> buffer) noexcept;
+        // record the lighting dispatch, barriers on the g buffer and the output are inserted by the render graph
+        void Dispatch(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer) noexcept;
+
+        // hdr lighting result, sampled by the sky pass
+        std::shared_ptr<Texture> GetOutput() const noexcept;
+
+    private:
+        static constexpr u32 k_tile_size = 16;
+
+        RenderContext &m_render_context;
+        std::shared_ptr<Texture> m_output;
+        std::shared_ptr<Pipeline> m_pipeline;
+        std::shared_ptr<DescriptorSet> m_descriptor_set;
+        DescriptorSetUpdateDesc m_descriptor_set_update_desc;
+    };
+
+}
@@ -0,0 +1,155 @@
+#include "DrawList.h"
+
+#include <array>
+#include <cstring>
+
+namespace Horizon {
+
+	u64 DrawKey::Make(u32 pipeline, u32 material, u32 geometry, f32 depth) noexcept
+	{
+		// bits of a non negative float are ordered like the float, keep the most significant ones
+		u32 depth_bits;
+		depth = depth > 0.0f ? depth : 0.0f;
+		memcpy(&depth_bits, &depth, sizeof(depth_bits));
+		depth_bits >>= 32 - k_depth_bits;
+
+		u64 key = static_cast<u64>(pipeline & ((1u << k_pipeline_bits) - 1));
+		key = (key << k_material_bits) | (material & ((1u << k_material_bits) - 1));
+		key = (key << k_geometry_bits) | (geometry & ((1u << k_geometry_bits) - 1));
+		key = (key << k_depth_bits) | depth_bits;
+		return key;
+	}
+
+	void RadixSort(std::vector<DrawSortEntry>& entries, std::vector<DrawSortEntry>& scratch) noexcept
+	{
+		scratch.resize(entries.size());
+		if (entries.size() < 2) {
+			return;
+		}
+
+		std::array<u32, 256> histogram;
+		for (u32 shift = 0; shift < 64; shift += 8) {
+			histogram.fill(0);
+			for (const auto& entry : entries) {
+				histogram[(entry.key >> shift) & 0xff]++;
+			}
+			// every key has the same byte, the pass would not move anything
+			if (histogram[(entries[0].key >> shift) & 0xff] == entries.size()) {
+				continue;
+			}
+			u32 offset = 0;
+			for (auto& count : histogram) {
+				u32 c = count;
+				count = offset;
+				offset += c;
+			}
+			for (const auto& entry : entries) {
+				scratch[histogram[(entry.key >> shift) & 0xff]++] = entry;
+			}
+			entries.swap(scratch);
+		}
+	}
+
+	void DrawList::Clear() noexcept
+	{
+		m_items.clear();
+		m_entries.clear();
+		m_batches.clear();
+		m_instance_transforms.clear();
+	}
+
+	void DrawList::Add(const DrawItem& item) noexcept
+	{
+		m_entries.push_back(DrawSortEntry{ item.key, static_cast<u32>(m_items.size()) });
+		m_items.push_back(item);
+	}
+
+	void DrawList::Sort() noexcept
+	{
+		RadixSort(m_entries, m_scratch);
+
+		// the key orders by material then geometry, so equal draws are adjacent and only differ in depth
+		m_batches.clear();
+		m_instance_transforms.resize(m_entries.size());
+		for (u32 i = 0; i < m_entries.size(); i++) {
+			const DrawItem& item = m_items[m_entries[i].index];
+			m_instance_transforms[i] = item.transform;
+			if (!m_batches.empty()) {
+				const DrawItem& previous = m_items[m_entries[m_batches.back().first_instance].index];
+				if (previous.pipeline == item.pipeline && previous.primitive == item.primitive) {
+					m_batches.back().instance_count++;
+					continue;
+				}
+			}
+			m_batches.push_back(DrawBatch{ i, 1 });
+		}
+	}
+
+	const std::vector<Math::mat4>& DrawList::GetInstanceTransforms() const noexcept
+	{
+		return m_instance_transforms;
+	}
+
+	void DrawList::Record(VkCommandBuffer command_buffer, VkDescriptorSet scene_descriptor_set, VkDescriptorSet instance_descriptor_set, Pipeline* depth_pipeline) noexcept
+	{
+		// the stats describe the draws of the pass that shades the list
+		DrawListStats stats{};
+
+		Pipeline* bound_pipeline = nullptr;
+		Model* bound_model = nullptr;
+		VkDescriptorSet bound_material_set = VK_NULL_HANDLE;
+
+		for (const auto& batch : m_batches) {
+			const DrawItem& item = m_items[m_entries[batch.first_instance].index];
+			Pipeline* pipeline = depth_pipeline ? depth_pipeline : item.pipeline;
+			VkDescriptorSet material_set = item.primitive->material->m_material_descriptor_set->Get();
+
+			if (pipeline != bound_pipeline) {
+				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->Get());
+				stats.pipeline_binds++;
+				// layouts may differ between pipelines, rebind every set
+				std::array<VkDescriptorSet, 3> descriptor_sets{ scene_descriptor_set, material_set, instance_descriptor_set };
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetLayout(), 0, static_cast<u32>(descriptor_sets.size()), descriptor_sets.data(), 0, nullptr);
+				stats.descriptor_set_binds++;
+				bound_pipeline = pipeline;
+				bound_material_set = material_set;
+			}
+			else if (material_set != bound_material_set && !depth_pipeline) {
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetLayout(), 1, 1, &material_set, 0, nullptr);
+				stats.descriptor_set_binds++;
+				bound_material_set = material_set;
+			}
+
+			if (item.model != bound_model) {
+				if (depth_pipeline) {
+					item.model->BindPositionBuffers(command_buffer);
+				}
+				else {
+					item.model->BindBuffers(command_buffer);
+				}
+				stats.vertex_buffer_binds++;
+				bound_model = item.model;
+			}
+
+			vkCmdDrawIndexed(command_buffer, item.primitive->indexCount, batch.instance_count, item.primitive->firstIndex, 0, batch.first_instance);
+			stats.draws++;
+			stats.instances += batch.instance_count;
+		}
+
+		// Model::DrawPrimitive binds pipeline, descriptor sets and push constants for every object
+		stats.binds_saved = 3 * stats.instances - stats.pipeline_binds - stats.descriptor_set_binds;
+		if (!depth_pipeline) {
+			m_stats = stats;
+		}
+	}
+
+	u32 DrawList::Size() const noexcept
+	{
+		return static_cast<u32>(m_items.size());
+	}
+
+	const DrawListStats& DrawList::GetStats() const noexcept
+	{
+		return m_stats;
+	}
+}
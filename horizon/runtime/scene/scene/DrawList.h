@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include <runtime/core/math/Math.h>
+#include <runtime/function/rhi/vulkan/Pipeline.h>
+#include <runtime/scene/model/Model.h>
+
+namespace Horizon {
+
+	// 64 bit sort key, most expensive state change in the highest bits so equal state ends up adjacent.
+	// | pipeline 8 | material 16 | geometry 16 | depth 24 |
+	namespace DrawKey {
+		constexpr u32 k_pipeline_bits = 8;
+		constexpr u32 k_material_bits = 16;
+		constexpr u32 k_geometry_bits = 16;
+		constexpr u32 k_depth_bits = 24;
+
+		// depth is a non negative view distance, smaller distances sort first (front to back)
+		u64 Make(u32 pipeline, u32 material, u32 geometry, f32 depth) noexcept;
+	}
+
+	struct DrawItem {
+		u64 key;
+		Pipeline* pipeline;
+		Model* model;
+		MeshPrimitive* primitive;
+		Math::mat4 transform;
+	};
+
+	struct DrawListStats {
+		u32 draws = 0;
+		u32 instances = 0;
+		u32 pipeline_binds = 0;
+		u32 descriptor_set_binds = 0;
+		u32 vertex_buffer_binds = 0;
+		// pipeline, descriptor set and push constant calls skipped compared to binding everything per object
+		u32 binds_saved = 0;
+	};
+
+	struct DrawSortEntry {
+		u64 key;
+		u32 index;
+	};
+
+	// lsd radix sort, 8 bits per pass, passes where all keys share the same byte are skipped
+	void RadixSort(std::vector<DrawSortEntry>& entries, std::vector<DrawSortEntry>& scratch) noexcept;
+
+	class DrawList {
+	public:
+		void Clear() noexcept;
+		void Add(const DrawItem& item) noexcept;
+		// sort by key and merge runs of the same pipeline and primitive into instanced batches
+		void Sort() noexcept;
+		// per instance transforms in sorted order, read in the vertex shader with gl_InstanceIndex
+		const std::vector<Math::mat4>& GetInstanceTransforms() const noexcept;
+		// scene, material and instance descriptor sets are bound at set 0, 1 and 2.
+		// a depth pipeline replaces the pipelines of all batches, they are drawn from the position stream without material binds
+		void Record(VkCommandBuffer command_buffer, VkDescriptorSet scene_descriptor_set, VkDescriptorSet instance_descriptor_set, Pipeline* depth_pipeline = nullptr) noexcept;
+		u32 Size() const noexcept;
+		const DrawListStats& GetStats() const noexcept;
+	private:
+		struct DrawBatch {
+			u32 first_instance;
+			u32 instance_count;
+		};
+
+		std::vector<DrawItem> m_items;
+		std::vector<DrawSortEntry> m_entries;
+		std::vector<DrawSortEntry> m_scratch;
+		std::vector<DrawBatch> m_batches;
+		std::vector<Math::mat4> m_instance_transforms;
+		DrawListStats m_stats;
+	};
+}
@@ -1,5 +1,7 @@
 #include "Scene.h"
 
+#include <algorithm>
+
 #include <runtime/core/log/Log.h>
 #include <runtime/function/rhi/vulkan/UniformBuffer.h>
 
@@ -21,6 +23,12 @@ namespace Horizon {
 
 		m_scene_descriptor_set = std::make_shared<DescriptorSet>(m_device, sceneDescriptorSetInfo);
 
+		// instance transforms
+		std::shared_ptr<DescriptorSetInfo> instanceDescriptorSetInfo = std::make_shared<DescriptorSetInfo>();
+		instanceDescriptorSetInfo->AddBinding(DescriptorType::DESCRIPTOR_TYPE_RW_BUFFER, SHADER_STAGE_VERTEX_SHADER);
+		m_instance_descriptor_set = std::make_shared<DescriptorSet>(m_device, instanceDescriptorSetInfo);
+		m_instance_transform_buffer = std::make_shared<StorageBuffer>(m_device, 0);
+
 		m_camera = std::make_shared<Camera>(Math::vec3(0.0f, 6370.0f, 10.0), Math::vec3(0.0f, 0.0f, 0.0f), Math::vec3(0.0f, 1.0f, 0.0f));
 		m_camera->SetPerspectiveProjectionMatrix(Math::radians(90.0f), static_cast<f32>(m_render_context.width) / static_cast<f32>(m_render_context.height), 5.0f, 20000.0f);
 		m_camera->SetCameraSpeed(1.0f);
@@ -28,7 +36,7 @@ namespace Horizon {
 		// create uniform buffer
 		m_scene_ub = std::make_shared<UniformBuffer>(device);
 		m_light_count_ub = std::make_shared<UniformBuffer>(device);
-		m_light_ub = std::make_shared<UniformBuffer>(device);
+		m_light_buffer = std::make_shared<StorageBuffer>(device, k_initial_light_capacity * sizeof(LightParams));
 		m_camera_ub = std::make_shared<UniformBuffer>(device);
 	}
 
@@ -39,7 +47,12 @@ namespace Horizon {
 
 	void Scene::LoadModel(const std::string& path, const std::string& name) noexcept
 	{
-		m_models.insert({ name, std::make_shared<Model>(path, m_device, m_command_buffer, m_scene_descriptor_set) });
+		std::shared_ptr<Model> model = std::make_shared<Model>(path, m_device, m_command_buffer, m_scene_descriptor_set);
+		m_models.insert({ name, model });
+		AddRenderObjects(model, Math::mat4(1.0f));
+		m_world_bounds.Resize(static_cast<u32>(m_render_objects.size()));
+		m_visibility.resize(m_render_objects.size(), 1);
+		m_objects_version++;
 	}
 
 	std::shared_ptr<Model> Scene::GetModel(const std::string& name) const noexcept
@@ -47,54 +60,178 @@ namespace Horizon {
 		return m_models.at(name);
 	}
 
-	void Scene::AddDirectLight(Math::vec3 color, f32 intensity, Math::vec3 direction) noexcept
+	u32 Scene::AddModelInstances(const std::string& name, const std::vector<Math::mat4>& transforms) noexcept
 	{
-		if (m_light_count_ubdata.lightCount >= MAX_LIGHT_COUNT) {
-			LOG_WARN("light count cannot more than {}", MAX_LIGHT_COUNT);
+		auto model = m_models.find(name);
+		if (model == m_models.end()) {
+			LOG_ERROR("model {} is not loaded", name);
+			return static_cast<u32>(m_instance_transforms.size());
+		}
+		u32 first_instance = static_cast<u32>(m_instance_transforms.size());
+		for (auto& transform : transforms) {
+			AddRenderObjects(model->second, transform);
+		}
+		m_world_bounds.Resize(static_cast<u32>(m_render_objects.size()));
+		m_visibility.resize(m_render_objects.size(), 1);
+		m_objects_version++;
+		return first_instance;
+	}
+
+	void Scene::SetInstanceTransform(u32 instance, const Math::mat4& transform) noexcept
+	{
+		if (instance >= m_instance_transforms.size()) {
+			LOG_ERROR("invalid instance {}", instance);
 			return;
 		}
+		m_instance_transforms[instance] = transform;
+		u32 end = instance + 1 < m_instance_first_object.size() ? m_instance_first_object[instance + 1] : static_cast<u32>(m_render_objects.size());
+		for (u32 object = m_instance_first_object[instance]; object < end; object++) {
+			m_world.GetComponent<TransformComponent>(m_render_objects[object].entity).dirty = 1;
+		}
+	}
 
+	u32 Scene::AddRenderObjects(std::shared_ptr<Model> model, const Math::mat4& transform) noexcept
+	{
+		u32 instance = static_cast<u32>(m_instance_transforms.size());
+		m_instance_transforms.push_back(transform);
+		m_instance_first_object.push_back(static_cast<u32>(m_render_objects.size()));
+
+		for (auto& node : model->GetLinearNodes()) {
+			if (!node->mesh) {
+				continue;
+			}
+			u32 mesh_id = m_mesh_ids.emplace(node->mesh.get(), static_cast<u32>(m_mesh_ids.size())).first->second;
+			for (auto& primitive : node->mesh->primitives) {
+				u32 material_id = m_material_ids.emplace(primitive->material.get(), static_cast<u32>(m_material_ids.size())).first->second;
+				u32 primitive_id = m_primitive_ids.emplace(primitive.get(), static_cast<u32>(m_primitive_ids.size())).first->second;
+				u32 object = static_cast<u32>(m_render_objects.size());
+
+				Entity entity = m_world.Create();
+				m_world.AddComponent(entity, TransformComponent{ Math::mat4(1.0f), node->mesh->m_mesh_push_constant.modelMatrix, instance, 1 });
+				m_world.AddComponent(entity, RenderableComponent{ model.get(), primitive.get(), material_id, primitive_id, object });
+				m_world.AddComponent(entity, BoundsComponent{ primitive->bounds, primitive->bounds });
+				m_render_objects.push_back(RenderObject{ entity, model, node->mesh, primitive, instance, material_id, mesh_id, primitive_id });
+			}
+		}
+		return instance;
+	}
+
+	Entity Scene::AddDirectLight(Math::vec3 color, f32 intensity, Math::vec3 direction) noexcept
+	{
 		f32 luminous_intensity = intensity;
 
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].color_intensity = { color, luminous_intensity };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].direction = { direction.x, direction.y, direction.z, 0.0 };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].position_type = { 0.0, 0.0, 0.0, static_cast<f32>(LightType::DIRECT_LIGHT) };
-		m_light_count_ubdata.lightCount++;
+		LightParams params;
+		params.color_intensity = { color, luminous_intensity };
+		params.direction = { direction.x, direction.y, direction.z, 0.0 };
+		params.position_type = { 0.0, 0.0, 0.0, static_cast<f32>(LightType::DIRECT_LIGHT) };
+		return AddLight(params);
+	}
 
+	Entity Scene::AddPointLight(Math::vec3 color, f32 intensity, Math::vec3 position, f32 radius) noexcept
+	{
+		f32 luminous_intensity = intensity / Math::one_over_pi<f32>() / 4.0f;
+
+		LightParams params;
+		params.color_intensity = { color, luminous_intensity };
+		params.position_type = { position, static_cast<f32>(LightType::POINT_LIGHT) };
+		params.radius_inner_outer = { radius, 0.0, 0.0, 0.0 };
+		return AddLight(params);
+	}
+
+	Entity Scene::AddSpotLight(Math::vec3 color, f32 intensity, Math::vec3 direction, Math::vec3 position, f32 radius, f32 innerConeAngle, f32 outerConeAngle) noexcept
+	{
+		f32 cos_outer = Math::cos(std::clamp(std::abs(outerConeAngle), 0.5f * Math::radians(0.5f), Math::two_pi<f32>()));
+		f32 cos_outer2 = Math::sqrt(cos_outer * cos_outer);
+		f32 luminous_intensity = intensity / Math::one_over_two_pi<f32>() / (1.0f - cos_outer2);
+
+		LightParams params;
+		params.color_intensity = { color, luminous_intensity };
+		params.direction = { direction, 0.0 };
+		params.position_type = { position, static_cast<f32>(LightType::SPOT_LIGHT) };
+		params.radius_inner_outer = { radius, innerConeAngle, outerConeAngle, 0.0 };
+		return AddLight(params);
+	}
+
+	Entity Scene::AddLight(const LightParams& params) noexcept
+	{
+		Entity entity = m_world.Create();
+		m_world.AddComponent(entity, LightComponent{ params });
+		MarkLightDirty(m_world.Pool<LightComponent>().GetSlot(entity));
+		m_light_count_dirty = true;
+		return entity;
+	}
+
+	const LightParams& Scene::GetLight(Entity light) const noexcept
+	{
+		return m_world.GetComponent<LightComponent>(light).params;
 	}
 
-	void Scene::AddPointLight(Math::vec3 color, f32 intensity, Math::vec3 position, f32 radius) noexcept
+	void Scene::UpdateLight(Entity light, const LightParams& params) noexcept
 	{
-		if (m_light_count_ubdata.lightCount >= MAX_LIGHT_COUNT) {
-			LOG_WARN("light count cannot more than {}", MAX_LIGHT_COUNT);
+		if (!m_world.IsAlive(light) || !m_world.HasComponent<LightComponent>(light)) {
+			LOG_ERROR("invalid light handle {}", light.index);
 			return;
 		}
+		m_world.GetComponent<LightComponent>(light).params = params;
+		MarkLightDirty(m_world.Pool<LightComponent>().GetSlot(light));
+	}
 
-		f32 luminous_intensity = intensity / Math::one_over_pi<f32>() / 4.0f;
-
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].color_intensity = { color, luminous_intensity };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].position_type = { position, static_cast<f32>(LightType::POINT_LIGHT) };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].radius_inner_outer = { radius, 0.0, 0.0, 0.0 };
-		m_light_count_ubdata.lightCount++;
+	void Scene::RemoveLight(Entity light) noexcept
+	{
+		if (!m_world.IsAlive(light) || !m_world.HasComponent<LightComponent>(light)) {
+			LOG_ERROR("invalid light handle {}", light.index);
+			return;
+		}
+		// the last light is moved into the freed slot
+		ComponentPool<LightComponent>& lights = m_world.Pool<LightComponent>();
+		u32 slot = lights.GetSlot(light);
+		m_world.Destroy(light);
+		if (slot < lights.Size()) {
+			MarkLightDirty(slot);
+		}
+		m_light_count_dirty = true;
+	}
 
+	u32 Scene::GetLightCount() const noexcept
+	{
+		return m_world.Pool<LightComponent>().Size();
 	}
 
-	void Scene::AddSpotLight(Math::vec3 color, f32 intensity, Math::vec3 direction, Math::vec3 position, f32 radius, f32 innerConeAngle, f32 outerConeAngle) noexcept
+	void Scene::MarkLightDirty(u32 slot) noexcept
 	{
-		if (m_light_count_ubdata.lightCount >= MAX_LIGHT_COUNT) {
-			LOG_WARN("light count cannot more than {}", MAX_LIGHT_COUNT);
+		if (m_light_dirty_begin == m_light_dirty_end) {
+			m_light_dirty_begin = slot;
+			m_light_dirty_end = slot + 1;
 			return;
 		}
-		;
-		f32 cos_outer = Math::cos(std::clamp(std::abs(outerConeAngle), 0.5f * Math::radians(0.5f), Math::two_pi<f32>()));
-		f32 cos_outer2 = Math::sqrt(cos_outer * cos_outer);
-		f32 luminous_intensity = intensity / Math::one_over_two_pi<f32>() / (1.0f - cos_outer2);
+		m_light_dirty_begin = (std::min)(m_light_dirty_begin, slot);
+		m_light_dirty_end = (std::max)(m_light_dirty_end, slot + 1);
+	}
+
+	void Scene::UploadLights() noexcept
+	{
+		const ComponentPool<LightComponent>& lights = m_world.Pool<LightComponent>();
+		u32 light_count = lights.Size();
+
+		// grow by doubling, a new buffer has lost its content so every light is uploaded
+		u64 required_size = static_cast<u64>(light_count) * sizeof(LightParams);
+		if (required_size > m_light_buffer->size()) {
+			m_light_buffer->reserve((std::max)(required_size, m_light_buffer->size() * 2));
+			m_light_dirty_begin = 0;
+			m_light_dirty_end = light_count;
+		}
+
+		m_light_dirty_end = (std::min)(m_light_dirty_end, light_count);
+		if (m_light_dirty_begin < m_light_dirty_end) {
+			m_light_buffer->update(lights.Data() + m_light_dirty_begin, static_cast<u64>(m_light_dirty_end - m_light_dirty_begin) * sizeof(LightParams), static_cast<u64>(m_light_dirty_begin) * sizeof(LightParams));
+		}
+		m_light_dirty_begin = m_light_dirty_end = 0;
 
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].color_intensity = { color, luminous_intensity };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].direction = { direction, 0.0 };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].position_type = { position, static_cast<f32>(LightType::SPOT_LIGHT) };
-		m_lights_ubdata.lights[m_light_count_ubdata.lightCount].radius_inner_outer = { radius, innerConeAngle, outerConeAngle, 0.0 };
-		m_light_count_ubdata.lightCount++;
+		if (m_light_count_dirty) {
+			m_light_count_ubdata.lightCount = light_count;
+			m_light_count_ub->update(&m_light_count_ubdata, sizeof(LightCountUb));
+			m_light_count_dirty = false;
+		}
 	}
 
 	void Scene::Prepare() noexcept
@@ -109,16 +246,16 @@ namespace Horizon {
 
 		m_camera_ubdata.camera_pos = m_camera->GetPosition();
 		m_camera_ubdata.camera_forward_dir = m_camera->GetForwardDir();
+		m_camera_ubdata.inv_view_projection = m_camera->GetInvViewProjectionMatrix();
 		m_camera_ub->update(&m_camera_ubdata, sizeof(CamaeraUb));
 
-		m_light_count_ub->update(&m_light_count_ubdata, sizeof(LightCountUb));
-		m_light_ub->update(&m_lights_ubdata, m_light_count_ubdata.lightCount > 0 ? sizeof(LightParams) * m_light_count_ubdata.lightCount : sizeof(LightParams));
+		UploadLights();
 
 
 		DescriptorSetUpdateDesc desc;
 		desc.BindResource(0, m_scene_ub);
 		//desc.BindResource(1, m_light_count_ub);
-		//desc.BindResource(2, m_light_ub);
+		//desc.BindResource(2, m_light_buffer);
 		//desc.BindResource(3, m_camera_ub);
 
 		m_scene_descriptor_set->UpdateDescriptorSet(desc);
@@ -127,20 +264,111 @@ namespace Horizon {
 
 		// update material&mesh descriptorset
 		for (auto& model : m_models) {
-			model.second->UpdateModelMatrix();
+			if (model.second->IsTransformDirty()) {
+				model.second->UpdateModelMatrix();
+				UpdateLocalTransforms(model.second.get());
+				model.second->ClearTransformDirty();
+			}
 			model.second->UpdateDescriptors();
 		}
+
+		UpdateWorldBounds();
+		if (m_cpu_culling) {
+			Cull();
+		}
+		m_draw_list_dirty = true;
 	}
 
-	void Scene::Draw(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline) noexcept {
+	void Scene::Draw(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline, bool _load_attachments) noexcept {
+		_command_buffer->beginRenderPass(_i, _pipeline, false, _load_attachments);
+		RecordDraws(_i, _command_buffer, _pipeline);
+		_command_buffer->endRenderPass(_i);
+	}
 
-		_command_buffer->beginRenderPass(_i, _pipeline);
-		for (auto& model : m_models) {
-			model.second->Draw(_pipeline, _command_buffer->Get(_i));
-		}
+	void Scene::DrawDepth(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _depth_pipeline, std::shared_ptr<Pipeline> _pipeline) noexcept {
+		_command_buffer->beginRenderPass(_i, _depth_pipeline);
+		UpdateDrawList(_pipeline);
+		m_draw_list.Record(_command_buffer->Get(_i), m_scene_descriptor_set->Get(), m_instance_descriptor_set->Get(), _depth_pipeline.get());
 		_command_buffer->endRenderPass(_i);
 	}
 
+	void Scene::RecordDraws(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline) noexcept {
+		UpdateDrawList(_pipeline);
+		m_draw_list.Record(_command_buffer->Get(_i), m_scene_descriptor_set->Get(), m_instance_descriptor_set->Get());
+	}
+
+	void Scene::UpdateDrawList(std::shared_ptr<Pipeline> _pipeline) noexcept {
+
+		// built once per frame, every command buffer records the same list
+		if (m_draw_list_dirty) {
+			// the geometry pass has a single pipeline, so keys are ordered by material, primitive, then front to back
+			m_draw_list.Clear();
+			BuildDrawList(m_world, m_visibility, _pipeline.get(), m_camera->GetPosition(), m_draw_list);
+			m_draw_list.Sort();
+
+			const std::vector<Math::mat4>& transforms = m_draw_list.GetInstanceTransforms();
+			if (!transforms.empty()) {
+				m_instance_transform_buffer->reserve(transforms.size() * sizeof(Math::mat4));
+				m_instance_transform_buffer->update(transforms.data(), transforms.size() * sizeof(Math::mat4));
+			}
+			DescriptorSetUpdateDesc desc;
+			desc.BindResource(0, m_instance_transform_buffer);
+			m_instance_descriptor_set->UpdateDescriptorSet(desc);
+			m_draw_list_dirty = false;
+		}
+	}
+
+	void Scene::UpdateWorldBounds() noexcept
+	{
+		// only objects of moved models or instances need new world bounds, the bvh refits them in place
+		m_moved_slots.clear();
+		UpdateTransforms(m_world, m_instance_transforms, m_moved_slots);
+		const RenderableComponent* renderables = m_world.Pool<RenderableComponent>().Data();
+		const BoundsComponent* bounds = m_world.Pool<BoundsComponent>().Data();
+		for (u32 slot : m_moved_slots) {
+			u32 object = renderables[slot].object;
+			m_world_bounds.Set(object, bounds[slot].world);
+			m_bvh.Update(object, bounds[slot].world);
+		}
+		if (!m_moved_slots.empty()) {
+			m_bounds_version++;
+		}
+		// refits that leave every node box as it was cannot degrade the tree
+		if (m_bvh.Refit()) {
+			m_bvh.RebuildIfDegraded();
+		}
+	}
+
+	void Scene::UpdateLocalTransforms(const Model* model) noexcept
+	{
+		for (const RenderObject& object : m_render_objects) {
+			if (object.model.get() == model) {
+				TransformComponent& transform = m_world.GetComponent<TransformComponent>(object.entity);
+				transform.local = object.mesh->m_mesh_push_constant.modelMatrix;
+				transform.dirty = 1;
+			}
+		}
+	}
+
+	void Scene::Cull() noexcept
+	{
+		Frustum frustum(m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+		m_culling_stats.total_primitives = m_world_bounds.Size();
+
+		if (m_world_bounds.Size() < k_bvh_culling_threshold) {
+			m_culling_stats.visible_primitives = CullBounds(frustum, m_world_bounds, m_visibility);
+			return;
+		}
+
+		m_bvh_visible_objects.clear();
+		m_bvh.CullFrustum(frustum, m_bvh_visible_objects);
+		m_visibility.assign(m_render_objects.size(), 0);
+		for (u32 object : m_bvh_visible_objects) {
+			m_visibility[object] = 1;
+		}
+		m_culling_stats.visible_primitives = static_cast<u32>(m_bvh_visible_objects.size());
+	}
+
 
 	std::shared_ptr<DescriptorSetLayouts> Scene::GetDescriptorLayouts() const noexcept
 	{
@@ -174,7 +402,7 @@ namespace Horizon {
 		if (!materialSetLayout) {
 			LOG_ERROR("material descriptorset layout not found");
 		}
-		layouts->layouts = { { m_scene_descriptor_set->GetLayout(), materialSetLayout} };
+		layouts->layouts = { { m_scene_descriptor_set->GetLayout(), materialSetLayout, m_instance_descriptor_set->GetLayout()} };
 		return layouts;
 	}
 
@@ -196,6 +424,74 @@ namespace Horizon {
 		return m_camera_ub;
 	}
 
+	const CullingStats& Scene::GetCullingStats() const noexcept
+	{
+		return m_culling_stats;
+	}
+
+	const DrawListStats& Scene::GetDrawListStats() const noexcept
+	{
+		return m_draw_list.GetStats();
+	}
+
+	bool Scene::RayCast(const Ray& ray, RayHit& hit, const RayCastCallback& callback) const noexcept
+	{
+		return m_bvh.RayCast(ray, hit, callback);
+	}
+
+	void Scene::QueryBox(const BoundingBox& box, std::vector<u32>& objects) const noexcept
+	{
+		m_bvh.QueryBox(box, objects);
+	}
+
+	const RenderObject& Scene::GetRenderObject(u32 index) const noexcept
+	{
+		return m_render_objects[index];
+	}
+
+	Math::mat4 Scene::GetObjectTransform(u32 index) const noexcept
+	{
+		return m_world.GetComponent<TransformComponent>(m_render_objects[index].entity).world;
+	}
+
+	World& Scene::GetWorld() noexcept
+	{
+		return m_world;
+	}
+
+	const std::vector<RenderObject>& Scene::GetRenderObjects() const noexcept
+	{
+		return m_render_objects;
+	}
+
+	const BoundsSoA& Scene::GetWorldBounds() const noexcept
+	{
+		return m_world_bounds;
+	}
+
+	u64 Scene::GetObjectsVersion() const noexcept
+	{
+		return m_objects_version;
+	}
+
+	u64 Scene::GetBoundsVersion() const noexcept
+	{
+		return m_bounds_version;
+	}
+
+	std::shared_ptr<DescriptorSet> Scene::GetSceneDescriptorSet() const noexcept
+	{
+		return m_scene_descriptor_set;
+	}
+
+	void Scene::SetCpuCulling(bool enable) noexcept
+	{
+		m_cpu_culling = enable;
+		if (!enable) {
+			m_visibility.assign(m_render_objects.size(), 1);
+		}
+	}
+
 	FullscreenTriangle::FullscreenTriangle(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer) noexcept :m_device(device), m_command_buffer(command_buffer)
 	{
 
@@ -209,6 +505,12 @@ namespace Horizon {
 	void FullscreenTriangle::Draw(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets, bool _is_present) noexcept
 	{
 		_command_buffer->beginRenderPass(_i, _pipeline, _is_present);
+		Record(_i, _command_buffer, _pipeline, _descriptor_sets);
+		_command_buffer->endRenderPass(_i);
+	}
+
+	void FullscreenTriangle::Record(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets) noexcept
+	{
 		VkCommandBuffer command_buffer = _command_buffer->Get(_i);
 		const VkDeviceSize offsets[1] = { 0 };
 		VkBuffer vertexBuffer = m_vertex_buffer->Get();
@@ -223,9 +525,14 @@ namespace Horizon {
 			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->GetLayout(), 0, descriptor_sets.size(), descriptor_sets.data(), 0, 0);
 		}
 
+		if (_pipeline->hasPushConstants()) {
+			for (auto& pc : _pipeline->m_push_constants->ranges) {
+				vkCmdPushConstants(command_buffer, _pipeline->GetLayout(), ToVkShaderStageFlags(pc.stages), pc.offset, pc.size, pc.value);
+			}
+		}
+
 		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->Get());
 		vkCmdDraw(command_buffer, 3, 1, 0, 0);
-		_command_buffer->endRenderPass(_i);
 	}
 
 
@@ -8,12 +8,36 @@
 #include <runtime/function/rhi/vulkan/Device.h>
 #include <runtime/function/rhi/vulkan/Descriptors.h>
 #include <runtime/function/rhi/vulkan/CommandBuffer.h>
+#include <runtime/function/rhi/vulkan/StorageBuffer.h>
 #include <runtime/scene/model/Model.h>
 #include <runtime/scene/light/Light.h>
+#include <runtime/scene/culling/Frustum.h>
+#include <runtime/scene/culling/Bvh.h>
+#include <runtime/scene/scene/DrawList.h>
+#include <runtime/scene/ecs/World.h>
+#include <runtime/scene/ecs/Systems.h>
 
 namespace Horizon {
 
-#define MAX_LIGHT_COUNT 1024
+	// a primitive placed in the world by a node, the unit of culling and drawing.
+	// per frame data lives in the components of its entity
+	struct RenderObject {
+		Entity entity;
+		std::shared_ptr<Model> model;
+		std::shared_ptr<Mesh> mesh;
+		std::shared_ptr<MeshPrimitive> primitive;
+		// placement of the model in the world, applied on top of the node transform
+		u32 instance;
+		// dense ids for draw sort keys and batching
+		u32 material_id;
+		u32 mesh_id;
+		u32 primitive_id;
+	};
+
+	struct CullingStats {
+		u32 total_primitives = 0;
+		u32 visible_primitives = 0;
+	};
 
 	class Scene {
 	public:
@@ -22,22 +46,68 @@ namespace Horizon {
 
 		void LoadModel(const std::string& path, const std::string& name) noexcept;
 		std::shared_ptr<Model> GetModel(const std::string& name) const noexcept;
+		// place copies of a loaded model, gpu data is shared and copies are drawn instanced.
+		// returns the instance handle of the first copy, the others follow consecutively
+		u32 AddModelInstances(const std::string& name, const std::vector<Math::mat4>& transforms) noexcept;
+		void SetInstanceTransform(u32 instance, const Math::mat4& transform) noexcept;
 
 		// https://google.github.io/filament/Filament.html
-		void AddDirectLight(Math::vec3 color, f32 intensity, Math::vec3 direction) noexcept;
-		void AddPointLight(Math::vec3 color, f32 intensity, Math::vec3 position, f32 radius) noexcept;
-		void AddSpotLight(Math::vec3 color, f32 intensity, Math::vec3 direction, Math::vec3 position, f32 radius, f32 innerConeAngle, f32 outerConeAngle) noexcept;
+		Entity AddDirectLight(Math::vec3 color, f32 intensity, Math::vec3 direction) noexcept;
+		Entity AddPointLight(Math::vec3 color, f32 intensity, Math::vec3 position, f32 radius) noexcept;
+		Entity AddSpotLight(Math::vec3 color, f32 intensity, Math::vec3 direction, Math::vec3 position, f32 radius, f32 innerConeAngle, f32 outerConeAngle) noexcept;
+		// lights are addressed by the handle returned when they were added, only changed lights are uploaded
+		const LightParams& GetLight(Entity light) const noexcept;
+		void UpdateLight(Entity light, const LightParams& params) noexcept;
+		void RemoveLight(Entity light) noexcept;
+		u32 GetLightCount() const noexcept;
 
 		void Prepare() noexcept;
-		void Draw(u32 i, std::shared_ptr<CommandBuffer> command_buffer, std::shared_ptr<Pipeline> pipeline) noexcept;
+		// load_attachments keeps what an earlier pass wrote, e.g. the depth of a depth pre-pass
+		void Draw(u32 i, std::shared_ptr<CommandBuffer> command_buffer, std::shared_ptr<Pipeline> pipeline, bool load_attachments = false) noexcept;
+		// depth only draws of the visible objects with a position only pipeline, pipeline is the one the
+		// geometry pass draws the same list with afterwards
+		void DrawDepth(u32 i, std::shared_ptr<CommandBuffer> command_buffer, std::shared_ptr<Pipeline> depth_pipeline, std::shared_ptr<Pipeline> pipeline) noexcept;
+		// record the draws into a render pass begun by the caller, e.g. the first subpass of a merged deferred pass
+		void RecordDraws(u32 i, std::shared_ptr<CommandBuffer> command_buffer, std::shared_ptr<Pipeline> pipeline) noexcept;
 		std::shared_ptr<DescriptorSetLayouts> GetDescriptorLayouts() const noexcept;
 		std::shared_ptr<DescriptorSetLayouts> GetGeometryPassDescriptorLayouts() const noexcept;
 		std::shared_ptr<DescriptorSetLayouts> GetSceneDescriptorLayouts() const noexcept;
 		std::shared_ptr<Camera> GetMainCamera() const noexcept;
 		std::shared_ptr<UniformBuffer> getCameraUbo() const noexcept;
+		const CullingStats& GetCullingStats() const noexcept;
+		const DrawListStats& GetDrawListStats() const noexcept;
+
+		// spatial queries over render object world bounds, results are render object indices
+		bool RayCast(const Ray& ray, RayHit& hit, const RayCastCallback& callback = nullptr) const noexcept;
+		void QueryBox(const BoundingBox& box, std::vector<u32>& objects) const noexcept;
+		const RenderObject& GetRenderObject(u32 index) const noexcept;
+		World& GetWorld() noexcept;
+		// world matrix of a render object
+		Math::mat4 GetObjectTransform(u32 index) const noexcept;
+
+		// data for gpu driven rendering, versions change when objects are added or world bounds move
+		const std::vector<RenderObject>& GetRenderObjects() const noexcept;
+		const BoundsSoA& GetWorldBounds() const noexcept;
+		u64 GetObjectsVersion() const noexcept;
+		u64 GetBoundsVersion() const noexcept;
+		std::shared_ptr<DescriptorSet> GetSceneDescriptorSet() const noexcept;
+		// skip cpu frustum culling when visibility is decided on the gpu
+		void SetCpuCulling(bool enable) noexcept;
+	private:
+		u32 AddRenderObjects(std::shared_ptr<Model> model, const Math::mat4& transform) noexcept;
+		// sort the visible objects into the draw list once per frame
+		void UpdateDrawList(std::shared_ptr<Pipeline> pipeline) noexcept;
+		Entity AddLight(const LightParams& params) noexcept;
+		void MarkLightDirty(u32 slot) noexcept;
+		void UploadLights() noexcept;
+		void UpdateWorldBounds() noexcept;
+		// copy the node matrices of a moved model into the transform components of its objects
+		void UpdateLocalTransforms(const Model* model) noexcept;
+		void Cull() noexcept;
 	public:
 		std::shared_ptr<UniformBuffer> m_light_count_ub;
-		std::shared_ptr<UniformBuffer> m_light_ub;
+		// light params in light component order, grows with the light count
+		std::shared_ptr<StorageBuffer> m_light_buffer;
 		std::shared_ptr<UniformBuffer> m_camera_ub;
 	private:
 		RenderContext& m_render_context;
@@ -60,10 +130,11 @@ namespace Horizon {
 			u32 lightCount = 0;
 		}m_light_count_ubdata;
 
-		// 2
-		struct LightsUb {
-			LightParams lights[MAX_LIGHT_COUNT];
-		}m_lights_ubdata;
+		static constexpr u32 k_initial_light_capacity = 64;
+		// dirty light slots [begin, end), uploaded in Prepare
+		u32 m_light_dirty_begin = 0;
+		u32 m_light_dirty_end = 0;
+		bool m_light_count_dirty = true;
 
 		// 3
 		struct CamaeraUb {
@@ -71,6 +142,8 @@ namespace Horizon {
 			f32 pad0;
 			Math::vec3 camera_forward_dir;
 			f32 pad1;
+			// lighting reconstructs world position from depth
+			Math::mat4 inv_view_projection;
 		}m_camera_ubdata;
 
 
@@ -78,12 +151,47 @@ namespace Horizon {
 		// models
 		//std::vector<std::shared_ptr<Model>> m_models;
 		std::unordered_map<std::string, std::shared_ptr<Model>> m_models;
+
+		// entities of render objects and lights
+		World m_world;
+		// dense slots of the render entities moved this frame
+		std::vector<u32> m_moved_slots;
+
+		// culling
+		std::vector<RenderObject> m_render_objects;
+		BoundsSoA m_world_bounds;
+		std::vector<u8> m_visibility;
+		CullingStats m_culling_stats;
+		Bvh m_bvh;
+		std::vector<u32> m_bvh_visible_objects;
+		// below this object count a linear batch test beats walking the bvh
+		static constexpr u32 k_bvh_culling_threshold = 256;
+		bool m_cpu_culling = true;
+		u64 m_objects_version = 0;
+		u64 m_bounds_version = 0;
+
+		// model placements, every loaded model has one and AddModelInstances adds more
+		std::vector<Math::mat4> m_instance_transforms;
+		// render objects of an instance are contiguous, from its first object to the next instance's
+		std::vector<u32> m_instance_first_object;
+
+		// draws are sorted by state so redundant binds can be skipped while recording,
+		// equal draws become one instanced draw reading its transforms from a storage buffer
+		DrawList m_draw_list;
+		bool m_draw_list_dirty = true;
+		std::shared_ptr<StorageBuffer> m_instance_transform_buffer = nullptr;
+		std::shared_ptr<DescriptorSet> m_instance_descriptor_set = nullptr;
+		std::unordered_map<Material*, u32> m_material_ids;
+		std::unordered_map<Mesh*, u32> m_mesh_ids;
+		std::unordered_map<MeshPrimitive*, u32> m_primitive_ids;
 	};
 
 	class FullscreenTriangle {
 	public:
 		FullscreenTriangle(std::shared_ptr<Device> device, std::shared_ptr<CommandBuffer> command_buffer) noexcept;
 		void Draw(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets, bool _is_present = false) noexcept;
+		// draw inside a render pass begun by the caller
+		void Record(u32 _i, std::shared_ptr<CommandBuffer> _command_buffer, std::shared_ptr<Pipeline> _pipeline, const std::vector<std::shared_ptr<DescriptorSet>> _descriptor_sets) noexcept;
 	private:
 		std::shared_ptr<Device> m_device = nullptr;
 		std::shared_ptr<CommandBuffer> m_command_buffer = nullptr;